@@ -1,9 +1,15 @@
 ﻿#include "ArticlesNormalizer.h"
 
 #include <algorithm>
-#include <execution>
+#include <chrono>
 #include <fstream>
+#include <future>
 #include <iostream>
+#include <iterator>
+
+#include "Utils/BoundedQueue.h"
+#include "Utils/Profiler.h"
+#include "Utils/ThreadPool.h"
 
 
 
@@ -15,6 +21,15 @@ std::ifstream OpenFileWithUsingExceptions(std::string const& filePath)
 	return fin;
 }
 
+ArticlesNormalizer::ArticlesNormalizer(std::shared_ptr<ILemmatizer const> lemmatizer) : _normalizer(std::move(lemmatizer))
+{
+}
+
+ILemmatizer const& ArticlesNormalizer::lemmatizer() const
+{
+	return _normalizer.lemmatizer();
+}
+
 NormalizedArticle ArticlesNormalizer::createNormalizedArticle(std::string const& title, std::string const& content) const
 {
 	return { _normalizer.normalize(title), title, _normalizer.normalize(content) };
@@ -27,54 +42,217 @@ std::vector<NormalizedArticle> ArticlesNormalizer::readAndNormalizeArticles(std:
 	return normalizeArticles(titles, contents);
 }
 
+const size_t ArticlesNormalizer::DEFAULT_BATCH_SIZE = 8 * 1024 * 1024;
+const size_t ArticlesNormalizer::QUEUE_CAPACITY = 2;
 
-
-std::string ArticlesNormalizer::concatTitlesAndContentsWithTags(std::vector<std::string> const& titles, std::vector<std::string> const& contents, size_t approxSize) const
+PipelineMetrics ArticlesNormalizer::readAndNormalizeArticles(std::string_view articlesText, IArticlesReader const& articlesReader,
+	std::function<void(NormalizedArticle&&)> const& onArticle, size_t batchSize) const
 {
-	std::string res;
-	res.reserve(approxSize);
-	for (size_t i = 0; i < titles.size(); i++)
-	{
-		res += titles[i];
-		res += ' ' + termEndTag + ' ';
-		res += contents[i];
-		res += ' ' + contentEndTag + ' ';
-	}
-	return res;
+	return normalizeArticles([articlesText, &articlesReader](IArticlesReader::ArticleHandler const& onSourceArticle)
+		{
+			articlesReader.read(articlesText, onSourceArticle);
+		}, onArticle, batchSize);
 }
 
-using StrVecIt = std::vector<std::string>::const_iterator;
-std::vector<std::string> readUntilWord(std::vector<std::string> const& words, StrVecIt& curIt, std::string const& stopWord)
+/**
+ * \brief batch of articles passed between stages, each stage fills the next field and releases the previous one
+ */
+struct ArticlesBatch
 {
-	std::vector<std::string> title;
-	auto stopWordIt = std::find(curIt, words.end(), stopWord);
-	auto subWords = std::vector<std::string>{ curIt, stopWordIt };
-	curIt = stopWordIt + 1;
-	return subWords;
+	std::vector<std::string> titles;
+	std::vector<std::string> contents;
+	std::string clearedText;
+	SegmentedTokens segmented;
+};
+
+/**
+ * \brief thrown by the stage which can't pass its batch because another stage has failed
+ */
+class PipelineCancelled
+{
+};
+
+double getSecondsSince(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
 }
 
-std::vector<NormalizedArticle> ArticlesNormalizer::normalizeArticles(std::vector<std::string> titles, std::vector<std::string> const& contents) const
+PipelineMetrics ArticlesNormalizer::normalizeArticles(std::function<void(IArticlesReader::ArticleHandler const&)> const& readArticles,
+	std::function<void(NormalizedArticle&&)> const& onArticle, size_t batchSize) const
 {
-	std::transform(std::execution::par, titles.begin(), titles.end(), titles.begin(), [this](std::string const& title) {return this->_normalizer.clearText(title); });
-	auto text = concatTitlesAndContentsWithTags(titles, contents, titles.size());
-	auto words = _normalizer.normalize(text);
+	auto start = std::chrono::steady_clock::now();
+	BoundedQueue<ArticlesBatch> readBatches(QUEUE_CAPACITY), clearedBatches(QUEUE_CAPACITY), lemmatizedBatches(QUEUE_CAPACITY);
+	std::vector<BoundedQueue<ArticlesBatch>*> queues = { &readBatches, &clearedBatches, &lemmatizedBatches };
+	PipelineMetrics metrics;
+	metrics.stages.resize(queues.size() + 1);
+	std::vector<double> stagesSeconds(metrics.stages.size());
 
-	size_t curTitle = 0;
-	StrVecIt curIt = words.begin();
-	std::vector<NormalizedArticle> result;
-	while (curIt != words.end())
+	auto runStage = [&queues, &metrics, &stagesSeconds](size_t index, std::function<void(StageMetrics&)> const& body)
+	{
+		auto stageStart = std::chrono::steady_clock::now();
+		try
+		{
+			body(metrics.stages[index]);
+		}
+		catch (PipelineCancelled const&)
+		{
+		}
+		catch (...)
+		{
+			for (auto queue : queues)
+				queue->cancel();
+			stagesSeconds[index] = getSecondsSince(stageStart);
+			throw;
+		}
+		stagesSeconds[index] = getSecondsSince(stageStart);
+	};
+	auto pushBatch = [](BoundedQueue<ArticlesBatch>& queue, ArticlesBatch& batch, StageMetrics& stage)
+	{
+		stage.batchesCount++;
+		stage.articlesCount += batch.titles.size();
+		if (!queue.push(std::move(batch)))
+			throw PipelineCancelled();
+		batch = ArticlesBatch();
+	};
+
+	std::vector<std::future<void>> stages;
+	stages.push_back(std::async(std::launch::async, runStage, 0, [&](StageMetrics& stage)
+		{
+			PROFILE_SCOPE("ArticlesNormalizer::read");
+			ArticlesBatch batch;
+			size_t textSize = 0;
+			readArticles([&](std::string_view title, std::string_view content)
+				{
+					batch.titles.emplace_back(title);
+					batch.contents.emplace_back(content);
+					textSize += title.size() + content.size();
+					if (textSize >= batchSize)
+					{
+						pushBatch(readBatches, batch, stage);
+						textSize = 0;
+					}
+				});
+			if (!batch.titles.empty())
+				pushBatch(readBatches, batch, stage);
+			readBatches.close();
+		}));
+	stages.push_back(std::async(std::launch::async, runStage, 1, [&](StageMetrics& stage)
+		{
+			PROFILE_SCOPE("ArticlesNormalizer::clear");
+			ArticlesBatch batch;
+			while (readBatches.pop(batch))
+			{
+				batch.clearedText = clearArticles(batch.titles, batch.contents);
+				batch.contents = {};
+				pushBatch(clearedBatches, batch, stage);
+			}
+			clearedBatches.close();
+		}));
+	stages.push_back(std::async(std::launch::async, runStage, 2, [&](StageMetrics& stage)
+		{
+			PROFILE_SCOPE("ArticlesNormalizer::lemmatize");
+			ArticlesBatch batch;
+			while (clearedBatches.pop(batch))
+			{
+				batch.segmented = _normalizer.lemmatizer().lemmatizeLines(batch.clearedText, batch.titles.size() * 2);
+				batch.clearedText = {};
+				pushBatch(lemmatizedBatches, batch, stage);
+			}
+			lemmatizedBatches.close();
+		}));
+	std::exception_ptr exception;
+	try
+	{
+		runStage(3, [&](StageMetrics& stage)
+			{
+				PROFILE_SCOPE("ArticlesNormalizer::collect");
+				ArticlesBatch batch;
+				while (lemmatizedBatches.pop(batch))
+				{
+					stage.batchesCount++;
+					stage.articlesCount += batch.titles.size();
+					for (auto& article : createArticles(batch.titles, batch.segmented))
+						onArticle(std::move(article));
+				}
+			});
+	}
+	catch (...)
 	{
-		auto titleWords = readUntilWord(words, curIt, termEndTag);
-		auto contentWords = readUntilWord(words, curIt, contentEndTag);
-		result.emplace_back(titleWords, titles[curTitle], contentWords);
-		curTitle++;
+		exception = std::current_exception();
 	}
+	for (auto& stage : stages)
+	{
+		try
+		{
+			stage.get();
+		}
+		catch (...)
+		{
+			if (exception == nullptr)
+				exception = std::current_exception();
+		}
+	}
+	if (exception != nullptr)
+		std::rethrow_exception(exception);
 
-	return result;
+	std::vector<std::string> names = { "read", "clear", "lemmatize", "collect" };
+	for (size_t i = 0; i < metrics.stages.size(); i++)
+	{
+		auto& stage = metrics.stages[i];
+		stage.name = names[i];
+		if (i > 0)
+		{
+			stage.inputWaitingSeconds = queues[i - 1]->popWaitingSeconds();
+			stage.maxQueueDepth = queues[i - 1]->maxSize();
+			stage.averageQueueDepth = queues[i - 1]->averageSize();
+		}
+		if (i < queues.size())
+			stage.outputWaitingSeconds = queues[i]->pushWaitingSeconds();
+		stage.busySeconds = std::max(0., stagesSeconds[i] - stage.inputWaitingSeconds - stage.outputWaitingSeconds);
+	}
+	metrics.seconds = getSecondsSince(start);
+	return metrics;
 }
 
+/**
+ * \brief titles are cleared in place (they are views of articles), titles and contents are cleared as alternating segments
+ */
+std::string ArticlesNormalizer::clearArticles(std::vector<std::string>& titles, std::vector<std::string> const& contents) const
+{
+	ThreadPool::instance().parallelFor(0, titles.size(), [this, &titles](size_t begin, size_t end)
+		{
+			for (auto i = begin; i < end; i++)
+				titles[i] = _normalizer.clearText(titles[i]);
+		});
+	std::vector<std::string_view> segments;
+	segments.reserve(titles.size() * 2);
+	for (size_t i = 0; i < titles.size(); i++)
+	{
+		segments.emplace_back(titles[i]);
+		segments.emplace_back(contents[i]);
+	}
+	return _normalizer.clearSegments(segments);
+}
 
+/**
+ * \brief tokens of each segment are moved into its article
+ */
+std::vector<NormalizedArticle> ArticlesNormalizer::createArticles(std::vector<std::string>& titles, SegmentedTokens& segmented)
+{
+	auto segmentTokens = [&segmented](size_t segment)
+	{
+		auto begin = segmented.tokens.begin();
+		return std::vector<std::string>(std::make_move_iterator(begin + segmented.offsets[segment]), std::make_move_iterator(begin + segmented.offsets[segment + 1]));
+	};
+	std::vector<NormalizedArticle> result;
+	result.reserve(titles.size());
+	for (size_t i = 0; i < titles.size(); i++)
+		result.emplace_back(segmentTokens(2 * i), std::move(titles[i]), segmentTokens(2 * i + 1));
+	return result;
+}
 
-
-
-
+std::vector<NormalizedArticle> ArticlesNormalizer::normalizeArticles(std::vector<std::string> titles, std::vector<std::string> const& contents) const
+{
+	auto segmented = _normalizer.lemmatizer().lemmatizeLines(clearArticles(titles, contents), titles.size() * 2);
+	return createArticles(titles, segmented);
+}
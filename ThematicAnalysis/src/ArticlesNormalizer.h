@@ -1,22 +1,35 @@
 ﻿#pragma once
-#include "Lemmatizer.h"
 #include "NormalizedArticle.h"
+#include "PipelineMetrics.h"
 #include "TextNormalizer.h"
 #include "ArticlesReader/IArticlesReader.h"
+#include <functional>
 
 class ArticlesNormalizer
 {
 public:
+	ArticlesNormalizer() = default;
+	explicit ArticlesNormalizer(std::shared_ptr<ILemmatizer const> lemmatizer);
+
 	// throw std::ifstream::failure when i/o error
 	std::vector<NormalizedArticle> readAndNormalizeArticles(std::string const& articlesText, IArticlesReader const& articlesReader) const;
+	// articles are normalized by batches of about batchSize chars, so all of them are never in memory at once
+	PipelineMetrics readAndNormalizeArticles(std::string_view articlesText, IArticlesReader const& articlesReader,
+		std::function<void(NormalizedArticle&&)> const& onArticle, size_t batchSize = DEFAULT_BATCH_SIZE) const;
+	// readArticles passes articles of some source to the given handler. Batches go through read, clear
+	// and lemmatize stages in separate threads, articles are passed to onArticle in the calling thread in the source order
+	PipelineMetrics normalizeArticles(std::function<void(IArticlesReader::ArticleHandler const&)> const& readArticles,
+		std::function<void(NormalizedArticle&&)> const& onArticle, size_t batchSize = DEFAULT_BATCH_SIZE) const;
+	ILemmatizer const& lemmatizer() const;
+	static const size_t DEFAULT_BATCH_SIZE;
+	// count of batches between two stages
+	static const size_t QUEUE_CAPACITY;
 private:
-	std::string concatTitlesAndContentsWithTags(std::vector<std::string> const& titles, std::vector<std::string> const& contents, size_t approxSize) const;
 	std::vector<std::string> getTitle(std::vector<std::string> const& words, size_t& curPos);
 	std::vector<NormalizedArticle> normalizeArticles(std::vector<std::string> titles, std::vector<std::string> const& contents) const;
+	std::string clearArticles(std::vector<std::string>& titles, std::vector<std::string> const& contents) const;
+	static std::vector<NormalizedArticle> createArticles(std::vector<std::string>& titles, SegmentedTokens& segmented);
 	NormalizedArticle createNormalizedArticle(std::string const& title, std::string const& content) const;
 
 	TextNormalizer _normalizer;
-
-	std::string termEndTag = "termendtag";
-	std::string contentEndTag = "contentendtag";
 };
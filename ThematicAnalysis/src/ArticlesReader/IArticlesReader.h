@@ -1,9 +1,18 @@
 ﻿#pragma once
+#include <functional>
 #include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
 
 class IArticlesReader
 {
 public:
+	// title and content are valid only inside the handler call
+	using ArticleHandler = std::function<void(std::string_view title, std::string_view content)>;
+
 	virtual std::tuple<std::vector<std::string>, std::vector<std::string>> read(std::string const& text) const = 0;
+	// pass articles to the handler one by one without collecting all of them
+	virtual void read(std::string_view text, ArticleHandler const& onArticle) const = 0;
 	virtual ~IArticlesReader() = default;
 };
@@ -1,46 +1,245 @@
 ﻿#include <boost/regex.hpp>
-#include <iostream>
-#include <regex>
-#include <sstream>
+#include <algorithm>
+#include <cstring>
+#include <iterator>
 
 #include "MathArticlesReader.h"
+#include "Utils/ThreadPool.h"
 
-struct SubString
+bool isMarker(char c)
 {
-	int position, lenght;
+	return c == '<' || c == '>' || c == '/';
+}
+
+/**
+ * \brief iterator over the text which skips markup chars, so text is searched as if they were removed
+ */
+class SkipMarkersIterator
+{
+public:
+	using iterator_category = std::bidirectional_iterator_tag;
+	using value_type = char;
+	using difference_type = std::ptrdiff_t;
+	using pointer = char const*;
+	using reference = char const&;
+
+	SkipMarkersIterator() = default;
+	SkipMarkersIterator(char const* ptr, char const* end) : _ptr(ptr), _end(end)
+	{
+		while (_ptr != _end && isMarker(*_ptr)) ++_ptr;
+	}
+
+	reference operator*() const { return *_ptr; }
+	char const* base() const { return _ptr; }
+
+	SkipMarkersIterator& operator++()
+	{
+		do ++_ptr; while (_ptr != _end && isMarker(*_ptr));
+		return *this;
+	}
+	SkipMarkersIterator operator++(int) { auto it = *this; ++*this; return it; }
+	SkipMarkersIterator& operator--()
+	{
+		do --_ptr; while (isMarker(*_ptr));
+		return *this;
+	}
+	SkipMarkersIterator operator--(int) { auto it = *this; --*this; return it; }
+
+	bool operator==(SkipMarkersIterator const& other) const { return _ptr == other._ptr; }
+	bool operator!=(SkipMarkersIterator const& other) const { return _ptr != other._ptr; }
+
+private:
+	char const* _ptr = nullptr;
+	char const* _end = nullptr;
 };
 
-auto GetTermsPositions(std::string const& text)
+/**
+ * \brief the regex is compiled once and shared between threads
+ */
+boost::regex const& getHeadingRegex()
+{
+	static const boost::regex regex(R"(\r?\n\r?\n([А-Я]{3,}(?:[—\-\s,.]{1,5}(?:[А-Я\d]{2,}))*|[А-Я]{2}(?:[—\-\s,.]{1,5}(?:[А-Я\d]{2,}))+)(?:[^а-я0-9][а-яA-Za-z,.;()\-\s\d]*)?—[\s]*[а-я\d])");
+	return regex;
+}
+
+bool MathArticlesReader::Heading::operator==(Heading const& other) const
+{
+	return begin == other.begin && end == other.end;
+}
+
+// texts are in cp1251, where capital letters are 'А' (0xC0) to 'Я' (0xDF)
+bool isCapitalLetter(char c)
+{
+	return static_cast<unsigned char>(c) >= static_cast<unsigned char>('\xC0') && static_cast<unsigned char>(c) <= static_cast<unsigned char>('\xDF');
+}
+
+/**
+ * \brief cheap check of the heading prefix "\n\r?\n[А-Я]" to run the regex only on candidates
+ */
+bool isBlankLineBeforeCapital(char const* lineEnd, char const* textEnd)
+{
+	SkipMarkersIterator it(lineEnd + 1, textEnd), end(textEnd, textEnd);
+	if (it != end && *it == '\r') ++it;
+	if (it == end || *it != '\n') return false;
+	++it;
+	if (it != end && *it == '\r') ++it;
+	return it != end && isCapitalLetter(*it);
+}
+
+bool matchHeading(std::string_view text, char const* start, boost::match_results<SkipMarkersIterator>& match)
+{
+	auto const textEnd = text.data() + text.size();
+	auto flags = boost::match_continuous | (start == text.data() ? boost::match_default : boost::match_prev_avail);
+	return boost::regex_search(SkipMarkersIterator(start, textEnd), SkipMarkersIterator(textEnd, textEnd), match, getHeadingRegex(), flags);
+}
+
+/**
+ * \brief search the first heading which is after the position.
+ * Headings start with a line break, so the regex is tried only at line breaks followed by a blank line
+ */
+bool findNextHeading(std::string_view text, char const* from, char const*& begin, char const*& end, char const*& titleBegin, char const*& titleEnd)
 {
-	boost::regex regex(R"(\r?\n\r?\n([А-Я]{3,}(?:[—\-\s,.]{1,5}(?:[А-Я\d]{2,}))*|[А-Я]{2}(?:[—\-\s,.]{1,5}(?:[А-Я\d]{2,}))+)(?:[^а-я0-9][а-яA-Za-z,.;()\-\s\d]*)?—[\s]*[а-я\d])");
-	std::stringstream res;
-	boost::smatch match;
-	std::vector<std::tuple<std::string::const_iterator, std::string::const_iterator>> terms;
-	for (auto it = boost::sregex_iterator(text.begin(), text.end(), regex); it != boost::sregex_iterator(); ++it)
+	auto const textEnd = text.data() + text.size();
+	boost::match_results<SkipMarkersIterator> match;
+	for (auto lineEnd = from; lineEnd < textEnd; ++lineEnd)
 	{
-		boost::regex_match(text.cbegin() + it->position(), text.cbegin() + it->position() + it->length(), match, regex);
-		terms.emplace_back(match[1].begin(), match[1].end());
+		lineEnd = static_cast<char const*>(std::memchr(lineEnd, '\n', static_cast<size_t>(textEnd - lineEnd)));
+		if (lineEnd == nullptr) return false;
+		if (!isBlankLineBeforeCapital(lineEnd, textEnd)) continue;
+
+		auto prev = lineEnd;
+		while (prev > from && isMarker(*(prev - 1))) --prev;
+		bool found = prev > from && *(prev - 1) == '\r' && matchHeading(text, prev - 1, match);
+		if (found || matchHeading(text, lineEnd, match))
+		{
+			begin = match[0].first.base(), end = match[0].second.base();
+			titleBegin = match[1].first.base(), titleEnd = match[1].second.base();
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * \brief find headings which start in [searchBegin, searchEnd), heading may end after searchEnd
+ */
+std::vector<MathArticlesReader::Heading> MathArticlesReader::findHeadings(std::string_view text, char const* searchBegin, char const* searchEnd)
+{
+	std::vector<Heading> headings;
+	Heading heading;
+	auto from = searchBegin;
+	while (from < searchEnd && findNextHeading(text, from, heading.begin, heading.end, heading.titleBegin, heading.titleEnd) && heading.begin < searchEnd)
+	{
+		headings.push_back(heading);
+		from = heading.end;
+	}
+	return headings;
+}
+
+/**
+ * \brief remove markup chars, text is copied only if it has them
+ */
+std::string_view removeMarkers(char const* begin, char const* end, std::string& buffer)
+{
+	std::string_view text(begin, static_cast<size_t>(end - begin));
+	if (std::find_if(text.begin(), text.end(), isMarker) == text.end())
+		return text;
+	buffer.clear();
+	std::copy_if(text.begin(), text.end(), std::back_inserter(buffer), [](char c) {return !isMarker(c); });
+	return buffer;
+}
+
+void MathArticlesReader::readArticles(std::string_view text, std::vector<Heading> const& headings, ArticleHandler const& onArticle)
+{
+	std::string titleBuffer, contentBuffer;
+	auto const textEnd = text.data() + text.size();
+	for (auto it = headings.cbegin(); it != headings.cend(); ++it)
+	{
+		auto nextTitleBegin = std::next(it) == headings.cend() ? textEnd : std::next(it)->titleBegin;
+		onArticle(removeMarkers(it->titleBegin, it->titleEnd, titleBuffer), removeMarkers(it->titleEnd, nextTitleBegin, contentBuffer));
 	}
-	return terms;
 }
 
-std::tuple<std::vector<std::string>, std::vector<std::string>> MathArticlesReader::read(std::string const& sourceText) const
+std::tuple<std::vector<std::string>, std::vector<std::string>> MathArticlesReader::read(std::string const& text) const
 {
-	auto text = sourceText;
-	text.erase(std::remove(text.begin(), text.end(), '<'), text.end());
-	text.erase(std::remove(text.begin(), text.end(), '>'), text.end());
-	text.erase(std::remove(text.begin(), text.end(), '/'), text.end());
-	auto termsPositions = GetTermsPositions(text);
 	std::vector<std::string> titles, contents;
-	titles.reserve(termsPositions.size()), contents.reserve(termsPositions.size());
-	std::string::const_iterator prevTermEnd;
-	for (auto it = termsPositions.cbegin(); it != termsPositions.cend(); ++it)
+	read(std::string_view(text), [&titles, &contents](std::string_view title, std::string_view content)
+		{
+			titles.emplace_back(title);
+			contents.emplace_back(content);
+		});
+	return { std::move(titles), std::move(contents) };
+}
+
+void MathArticlesReader::read(std::string_view text, ArticleHandler const& onArticle) const
+{
+	readArticles(text, findHeadings(text, text.data(), text.data() + text.size()), onArticle);
+}
+
+/**
+ * \brief position of the next blank line (headings start with it)
+ */
+char const* findBlankLine(char const* from, char const* end)
+{
+	while (from < end)
+	{
+		auto lineEnd = static_cast<char const*>(std::memchr(from, '\n', static_cast<size_t>(end - from)));
+		if (lineEnd == nullptr) return end;
+		auto next = lineEnd + 1;
+		if (next < end && *next == '\r') ++next;
+		if (next < end && *next == '\n') return lineEnd;
+		from = lineEnd + 1;
+	}
+	return end;
+}
+
+/**
+ * \brief Headings are searched in chunks concurrently. If a heading crosses the chunk end, the next chunk
+ * is searched again from the heading end until its result meets the serial one
+ * \param threadsCount - count of parallel tasks, 0 - count of the thread pool workers
+ */
+void MathArticlesReader::readParallel(std::string_view text, ArticleHandler const& onArticle, size_t threadsCount) const
+{
+	auto& pool = ThreadPool::instance();
+	if (threadsCount == 0)
+		threadsCount = pool.workersCount();
+	auto const textBegin = text.data(), textEnd = text.data() + text.size();
+	std::vector<char const*> chunksStarts = { textBegin };
+	for (size_t i = 1; i < threadsCount; i++)
 	{
-		auto& [termStart, termEnd] = *it;
-		auto& nextTermStart = std::next(it) == termsPositions.end() ? text.cend() : std::get<0>(*std::next(it));
-		titles.emplace_back(termStart, termEnd);
-		contents.emplace_back(termEnd, nextTermStart);
+		auto chunkStart = findBlankLine(std::max(chunksStarts.back(), textBegin + text.size() * i / threadsCount), textEnd);
+		if (chunkStart != chunksStarts.back() && chunkStart != textEnd)
+			chunksStarts.push_back(chunkStart);
 	}
+	chunksStarts.push_back(textEnd);
 
-	return { titles, contents };
+	std::vector<std::vector<Heading>> chunksHeadings(chunksStarts.size() - 1);
+	pool.parallelFor(0, chunksHeadings.size(), [text, &chunksStarts, &chunksHeadings](size_t begin, size_t end)
+		{
+			for (auto i = begin; i < end; i++)
+				chunksHeadings[i] = findHeadings(text, chunksStarts[i], chunksStarts[i + 1]);
+		}, 1);
+
+	std::vector<Heading> headings;
+	for (auto const& chunkHeadings : chunksHeadings)
+	{
+		auto chunkIt = chunkHeadings.cbegin();
+		if (!headings.empty() && chunkIt != chunkHeadings.cend() && chunkIt->begin < headings.back().end)
+		{
+			Heading heading;
+			while (chunkIt != chunkHeadings.cend())
+			{
+				if (!findNextHeading(text, headings.back().end, heading.begin, heading.end, heading.titleBegin, heading.titleEnd))
+				{
+					chunkIt = chunkHeadings.cend();
+					break;
+				}
+				while (chunkIt != chunkHeadings.cend() && chunkIt->begin < heading.begin) ++chunkIt;
+				if (chunkIt != chunkHeadings.cend() && *chunkIt == heading) break;
+				headings.push_back(heading);
+			}
+		}
+		headings.insert(headings.end(), chunkIt, chunkHeadings.cend());
+	}
+	readArticles(text, headings, onArticle);
 }
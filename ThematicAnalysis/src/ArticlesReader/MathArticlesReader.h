@@ -1,10 +1,28 @@
 ﻿#pragma once
 #include "IArticlesReader.h"
+#include <functional>
+#include <string_view>
 #include <vector>
 
 class MathArticlesReader : public IArticlesReader
 {
 public:
 	std::tuple<std::vector<std::string>, std::vector<std::string>> read(std::string const& text) const override;
+	void read(std::string_view text, ArticleHandler const& onArticle) const override;
+	// search term headings in text chunks (split at blank lines) concurrently, the result is the same as for read
+	void readParallel(std::string_view text, ArticleHandler const& onArticle, size_t threadsCount = 0) const;
 	std::string exportToXml(std::vector<std::string> const& titles, std::vector<std::string> const& contents) const;
+
+private:
+	struct Heading
+	{
+		char const* begin;
+		char const* end;
+		char const* titleBegin;
+		char const* titleEnd;
+		bool operator==(Heading const& other) const;
+	};
+
+	static std::vector<Heading> findHeadings(std::string_view text, char const* searchBegin, char const* searchEnd);
+	static void readArticles(std::string_view text, std::vector<Heading> const& headings, ArticleHandler const& onArticle);
 };
@@ -1,7 +1,95 @@
 ﻿#include "XmlArticlesReader.h"
 
 #include <algorithm>
-#include <locale>
+#include <atomic>
+#include <cstring>
+#include <deque>
+
+#include "Utils/EncodingUtils.h"
+#include "Utils/MappedFile.h"
+#include "Utils/ThreadPool.h"
+
+bool isXmlSpace(char c)
+{
+	return c == ' ' || c == '\t' || c == '\n';
+}
+
+/**
+ * \brief replace tabs and line breaks by spaces, remove repeated, leading and trailing spaces
+ * \param parts - text parts, joined by space
+ * \param buffer - storage for the result, used only if text must be changed
+ */
+std::string_view clearString(std::vector<std::string_view> const& parts, std::string& buffer)
+{
+	if (parts.size() == 1)
+	{
+		auto text = parts.front();
+		while (!text.empty() && isXmlSpace(text.front())) text.remove_prefix(1);
+		while (!text.empty() && isXmlSpace(text.back())) text.remove_suffix(1);
+		auto isTwoSpaces = [](char a, char b) {return a == b && a == ' '; };
+		if (std::find_if(text.begin(), text.end(), [](char c) {return c == '\t' || c == '\n'; }) == text.end() &&
+			std::adjacent_find(text.begin(), text.end(), isTwoSpaces) == text.end())
+			return text;
+	}
+
+	buffer.clear();
+	auto append = [&buffer](char c)
+	{
+		if (c == '\t' || c == '\n') c = ' ';
+		if (c != ' ' || (!buffer.empty() && buffer.back() != ' '))
+			buffer.push_back(c);
+	};
+	for (size_t i = 0; i < parts.size(); i++)
+	{
+		if (i > 0) append(' ');
+		std::for_each(parts[i].begin(), parts[i].end(), append);
+	}
+	if (!buffer.empty() && buffer.back() == ' ')
+		buffer.pop_back();
+	return buffer;
+}
+
+
+class XmlArticlesReader::Parser
+{
+public:
+	Parser(XmlArticlesReader const& reader, std::string_view text, ArticleHandler const& onArticle) :
+		_reader(reader), _text(text), _onArticle(onArticle)
+	{
+	}
+
+	void parse();
+	// positions of top-level papers, the same as parse would find
+	std::vector<size_t> findPapersStarts();
+
+private:
+	struct Tag
+	{
+		std::string_view name;
+		bool isClosed;
+	};
+
+	// article parts of one paper nesting level, buffers are reused between papers
+	struct Paper
+	{
+		std::string_view title;
+		std::vector<std::string_view> contentParts;
+		std::string titleBuffer, contentBuffer;
+	};
+
+	void parsePaper(size_t depth);
+	std::string_view readToEnd(std::string_view tagName);
+	std::string_view readWord();
+	Tag readTag();
+	void skipSpace();
+	void skipToTag();
+
+	XmlArticlesReader const& _reader;
+	std::string_view _text;
+	size_t _ptr = 0;
+	ArticleHandler const& _onArticle;
+	std::deque<Paper> _papers;
+};
 
 /**
  * \brief Extract from text only titles and content
@@ -10,143 +98,225 @@
  */
 std::tuple<std::vector<std::string>, std::vector<std::string>> XmlArticlesReader::read(std::string const& text) const
 {
-	_text = text;
-	_size = _text.size();
-	_ptr = 0;
-	_titles = std::vector<std::string>();
-	_contents = std::vector<std::string>();
-	parse();
-	return std::make_tuple(_titles, _contents);
+	std::vector<std::string> titles, contents;
+	read(std::string_view(text), [&titles, &contents](std::string_view title, std::string_view content)
+		{
+			titles.emplace_back(title);
+			contents.emplace_back(content);
+		});
+	return { std::move(titles), std::move(contents) };
 }
 
-void clearString(std::string& s)
+/**
+ * \brief Extract titles and contents without copying the source text
+ * \param onArticle - called for each article in the order of closing paper tags
+ */
+void XmlArticlesReader::read(std::string_view text, ArticleHandler const& onArticle) const
 {
-	for (auto& i : s)
-	{
-		if (i == '\t' || i == '\n')
-			i = ' ';
-	}
-
-	auto isTwoSpaces = [](wchar_t a, wchar_t b) {return a == b && a == ' '; };
-	s.erase(std::unique(s.begin(), s.end(), isTwoSpaces), s.end());
+	Parser parser(*this, text, onArticle);
+	parser.parse();
+}
 
-	if (!s.empty() && s.front() == ' ')
-		s.erase(s.begin(), s.begin() + 1);
-	if (!s.empty() && s.back() == ' ')
-		s.erase(s.end() - 1, s.end());
+void XmlArticlesReader::readFile(std::string const& filePath, ArticleHandler const& onArticle) const
+{
+	MappedFile file(filePath);
+	read(file.view(), onArticle);
 }
 
+std::vector<size_t> XmlArticlesReader::findPapersStarts(std::string_view text) const
+{
+	ArticleHandler skipArticle;
+	Parser parser(*this, text, skipArticle);
+	return parser.findPapersStarts();
+}
 
-bool isLetter(char c)
+/**
+ * \brief Parse text in parallel: text is split at top-level papers (which are parsed independently by serial parser).
+ * Articles of a part are passed to the handler on the calling thread as soon as the previous parts are passed,
+ * so only parts parsed ahead are kept
+ * \param threadsCount - count of parallel tasks, 0 - count of the thread pool workers
+ */
+void XmlArticlesReader::readParallel(std::string_view text, ArticleHandler const& onArticle, size_t threadsCount) const
 {
-	static std::locale loc("ru-RU");
-	return std::isalpha(c, loc);
+	auto& pool = ThreadPool::instance();
+	if (threadsCount == 0)
+		threadsCount = pool.workersCount();
+	auto papersStarts = findPapersStarts(text);
+	if (papersStarts.empty()) return;
+
+	const auto partsCount = std::min(papersStarts.size(), threadsCount * 4);
+	const auto partSize = (text.size() - papersStarts.front()) / partsCount + 1;
+	std::vector<std::string_view> parts;
+	size_t partStart = papersStarts.front();
+	for (auto paperStart : papersStarts)
+	{
+		if (paperStart - partStart >= partSize)
+		{
+			parts.push_back(text.substr(partStart, paperStart - partStart));
+			partStart = paperStart;
+		}
+	}
+	parts.push_back(text.substr(partStart));
+
+	using Articles = std::vector<std::pair<std::string, std::string>>;
+	std::vector<Articles> partsArticles(parts.size());
+	std::atomic<bool> isCancelled = false;
+	std::vector<ThreadPool::TaskHandle> tasks;
+	for (size_t i = 0; i < parts.size(); i++)
+		tasks.push_back(pool.run([this, &parts, &partsArticles, &isCancelled, i]()
+			{
+				if (!isCancelled)
+					read(parts[i], [&articles = partsArticles[i]](std::string_view title, std::string_view content) {articles.emplace_back(title, content); });
+			}));
+	try
+	{
+		for (size_t i = 0; i < parts.size(); i++)
+		{
+			pool.wait(tasks[i]);
+			for (auto const& [title, content] : partsArticles[i])
+				onArticle(title, content);
+			partsArticles[i] = {};
+		}
+	}
+	catch (...)
+	{
+		// tasks refer to the parts, they are finished before leaving
+		isCancelled = true;
+		try
+		{
+			pool.wait(tasks);
+		}
+		catch (...)
+		{
+		}
+		throw;
+	}
 }
 
-void XmlArticlesReader::parsePaper() const
+void XmlArticlesReader::Parser::parsePaper(size_t depth)
 {
-	std::string title, content;
-	while (_ptr < _size)
+	if (_papers.size() == depth)
+		_papers.emplace_back();
+	auto& paper = _papers[depth];
+	paper.title = {};
+	paper.contentParts.clear();
+
+	while (_ptr < _text.size())
 	{
 		if (_text[_ptr] == '<')
 		{
 			auto tag = readTag();
-			std::string tag_name = std::get<std::string>(tag);
-			if (tag_name == nameTag)
+			if (tag.name == _reader.nameTag)
 			{
-				title = readToEnd(nameTag);
+				paper.title = readToEnd(_reader.nameTag);
 			}
-			else if (tag_name == contentTag || tag_name == definitionTag)
+			else if (tag.name == _reader.contentTag || tag.name == _reader.definitionTag)
 			{
-				content += " ";
-				content += readToEnd(tag_name);
+				paper.contentParts.push_back(readToEnd(tag.name));
 			}
-			else if (tag_name == paperTag)
+			else if (tag.name == _reader.paperTag)
 			{
-				if (std::get<bool>(tag)) break;
-				parsePaper();
+				if (tag.isClosed) break;
+				parsePaper(depth + 1);
 			}
 		}
-		else ++_ptr;
+		else skipToTag();
 	}
-	if (!title.empty())
+	if (!paper.title.empty())
 	{
-		clearString(title);
-		clearString(content);
-		_titles.push_back(title);
-		_contents.push_back(content);
+		auto title = clearString({ paper.title }, paper.titleBuffer);
+		auto content = clearString(paper.contentParts, paper.contentBuffer);
+		_onArticle(title, content);
 	}
 }
 
-void XmlArticlesReader::parse() const
+void XmlArticlesReader::Parser::parse()
 {
-	int i = 0;
-
-	while (_ptr < _size)
+	while (_ptr < _text.size())
 	{
 		if (_text[_ptr] == '<')
 		{
 			auto tag = readTag();
-			if (std::get<std::string>(tag) == paperTag &&
-				!std::get<bool>(tag))
-			{
-				i++;
-				parsePaper();
-			}
+			if (tag.name == _reader.paperTag && !tag.isClosed)
+				parsePaper(0);
 		}
-		else ++_ptr;
+		else skipToTag();
 	}
-	;
 }
 
-std::string XmlArticlesReader::readWord() const
+/**
+ * \brief count depth of paper tags, jumping between tags by memchr. Texts of names and contents are skipped
+ * as the parser does, so tags in them don't change the depth
+ */
+std::vector<size_t> XmlArticlesReader::Parser::findPapersStarts()
+{
+	std::vector<size_t> starts;
+	size_t depth = 0;
+	for (skipToTag(); _ptr < _text.size(); skipToTag())
+	{
+		auto tagStart = _ptr;
+		auto tag = readTag();
+		if (tag.name == _reader.paperTag)
+		{
+			if (!tag.isClosed && depth++ == 0)
+				starts.push_back(tagStart);
+			else if (tag.isClosed && depth > 0)
+				depth--;
+		}
+		else if (depth > 0 && (tag.name == _reader.nameTag || tag.name == _reader.contentTag || tag.name == _reader.definitionTag))
+			readToEnd(tag.name);
+	}
+	return starts;
+}
+
+std::string_view XmlArticlesReader::Parser::readWord()
 {
 	skipSpace();
 	const auto start = _ptr;
-	while (isLetter(_text[_ptr]))
+	while (_ptr < _text.size() && EncodingUtils::isLetter(_text[_ptr]))
 		++_ptr;
 	return _text.substr(start, _ptr - start);
 }
 
-std::tuple<std::string, bool> XmlArticlesReader::readTag() const
+XmlArticlesReader::Parser::Tag XmlArticlesReader::Parser::readTag()
 {
 	bool isClosed = false;
-	while (_ptr < _size && _text[_ptr++] != '<') {}
-	if (_ptr < _size && _text[_ptr] == '/')
+	while (_ptr < _text.size() && _text[_ptr++] != '<') {}
+	if (_ptr < _text.size() && _text[_ptr] == '/')
 	{
 		++_ptr;
 		isClosed = true;
 	}
-	auto tag = readWord();
-	while (_ptr < _size && _text[_ptr++] != '>') {}
-	return std::make_tuple(tag, isClosed);
+	auto name = readWord();
+	while (_ptr < _text.size() && _text[_ptr++] != '>') {}
+	return { name, isClosed };
 }
 
-void XmlArticlesReader::skipSpace() const
+void XmlArticlesReader::Parser::skipToTag()
 {
-	while (_ptr < _size && (_text[_ptr] == ' ' || _text[_ptr] == '\t' || _text[_ptr] == '\n'))
-		++_ptr;
+	auto tagStart = static_cast<char const*>(std::memchr(_text.data() + _ptr, '<', _text.size() - _ptr));
+	_ptr = tagStart == nullptr ? _text.size() : static_cast<size_t>(tagStart - _text.data());
 }
 
+void XmlArticlesReader::Parser::skipSpace()
+{
+	while (_ptr < _text.size() && isXmlSpace(_text[_ptr]))
+		++_ptr;
+}
 
-
-
-std::string XmlArticlesReader::readToEnd(const std::string& tagName) const
+std::string_view XmlArticlesReader::Parser::readToEnd(std::string_view tagName)
 {
 	const auto start = _ptr;
-	while (_ptr < _size)
+	while (_ptr < _text.size())
 	{
 		if (_text[_ptr] == '<')
 		{
 			auto tmp = _ptr;
 			auto tag = readTag();
-			if (std::get<std::string>(tag) == tagName)
-			{
-				if (std::get<bool>(tag))
-					return _text.substr(start, tmp - start);
-			}
+			if (tag.name == tagName && tag.isClosed)
+				return _text.substr(start, tmp - start);
 		}
-		else ++_ptr;
+		else skipToTag();
 	}
 	return _text.substr(start, _ptr - start);
 }
@@ -1,5 +1,7 @@
 ﻿#pragma once
+#include <functional>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <tuple>
 
@@ -10,23 +12,15 @@ class XmlArticlesReader: public IArticlesReader
 {
 public:
 	std::tuple<std::vector<std::string>, std::vector<std::string>> read(std::string const & text) const override;
+	void read(std::string_view text, ArticleHandler const& onArticle) const override;
+	void readFile(std::string const& filePath, ArticleHandler const& onArticle) const;
+	// parse text parts between top-level papers concurrently, articles are passed to the handler in the source order
+	void readParallel(std::string_view text, ArticleHandler const& onArticle, size_t threadsCount = 0) const;
 private:
-	mutable std::vector<std::string> _titles;
-	mutable std::vector<std::string> _contents;
-	mutable std::string _text;
-	mutable size_t _ptr = 0, _size = 0;
+	class Parser;
+	std::vector<size_t> findPapersStarts(std::string_view text) const;
 	const std::string nameTag = "name";
 	const std::string contentTag = "content";
 	const std::string paperTag = "paper";
 	const std::string definitionTag = "paperDef";
-	std::string readToEnd(const std::string& tagName) const;
-	void parsePaper() const;
-	void parse() const;
-	std::string readWord() const;
-	std::tuple<std::string, bool> readTag() const;
-	void skipSpace() const;
-	
 };
-
-
-
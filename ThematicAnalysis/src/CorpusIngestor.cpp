@@ -0,0 +1,201 @@
+﻿#include "CorpusIngestor.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+#include "ArticlesReader/MathArticlesReader.h"
+#include "ArticlesReader/XmlArticlesReader.h"
+#include "Utils/EncodingUtils.h"
+#include "Utils/MappedFile.h"
+
+const std::string_view UTF8_BOM = "\xEF\xBB\xBF";
+// encoding is detected by this count of first bytes
+constexpr size_t ENCODING_SAMPLE_SIZE = 1024 * 1024;
+
+double IngestionReport::megabytesPerSecond() const
+{
+	return seconds > 0 ? bytesCount / (1024.0 * 1024.0) / seconds : 0;
+}
+
+CorpusIngestor::CorpusIngestor(size_t ioThreadsCount) : _ioThreadsCount(ioThreadsCount)
+{
+	if (_ioThreadsCount == 0)
+		_ioThreadsCount = std::max(1u, std::thread::hardware_concurrency());
+}
+
+std::vector<std::string> CorpusIngestor::listFiles(std::string const& corpusPath)
+{
+	namespace fs = std::filesystem;
+	std::vector<std::string> filePaths;
+	if (fs::is_directory(corpusPath))
+	{
+		for (auto const& entry : fs::recursive_directory_iterator(corpusPath))
+			if (entry.is_regular_file())
+				filePaths.push_back(entry.path().string());
+		std::sort(filePaths.begin(), filePaths.end());
+		return filePaths;
+	}
+	std::ifstream manifest(corpusPath);
+	if (!manifest.is_open())
+		throw std::runtime_error("Can't open corpus " + corpusPath);
+	auto manifestDir = fs::path(corpusPath).parent_path();
+	std::string line;
+	while (std::getline(manifest, line))
+	{
+		line.erase(line.find_last_not_of(" \t\r") + 1);
+		if (line.empty() || line[0] == '#')
+			continue;
+		fs::path filePath(line);
+		filePaths.push_back((filePath.is_relative() ? manifestDir / filePath : filePath).string());
+	}
+	return filePaths;
+}
+
+/**
+ * \brief text is UTF-8 if it has BOM or its non-ASCII bytes are valid UTF-8 sequences
+ */
+CorpusIngestor::Encoding CorpusIngestor::detectEncoding(std::string_view text)
+{
+	if (text.substr(0, UTF8_BOM.size()) == UTF8_BOM)
+		return Encoding::UTF8;
+	text = text.substr(0, ENCODING_SAMPLE_SIZE);
+	bool hasMultibyte = false;
+	for (size_t i = 0; i < text.size(); )
+	{
+		auto c = static_cast<unsigned char>(text[i]);
+		size_t length = c < 0x80 ? 1 : (c & 0xE0) == 0xC0 ? 2 : (c & 0xF0) == 0xE0 ? 3 : (c & 0xF8) == 0xF0 ? 4 : 0;
+		if (length == 0 || (length == 2 && c < 0xC2))
+			return Encoding::Cp1251;
+		// the sample may end in the middle of a sequence
+		auto end = std::min(i + length, text.size());
+		for (size_t j = i + 1; j < end; j++)
+			if ((static_cast<unsigned char>(text[j]) & 0xC0) != 0x80)
+				return Encoding::Cp1251;
+		hasMultibyte |= length > 1;
+		i += length;
+	}
+	return hasMultibyte ? Encoding::UTF8 : Encoding::Cp1251;
+}
+
+IArticlesReader const& CorpusIngestor::selectReader(std::string const& filePath, std::string_view text)
+{
+	static const XmlArticlesReader xmlReader;
+	static const MathArticlesReader mathReader;
+	auto extension = std::filesystem::path(filePath).extension().string();
+	std::transform(extension.begin(), extension.end(), extension.begin(), [](char c) {return static_cast<char>(tolower(c)); });
+	if (extension == ".xml")
+		return xmlReader;
+	auto begin = text.find_first_not_of(" \t\r\n");
+	if (begin != std::string_view::npos && text[begin] == '<' && text.substr(0, ENCODING_SAMPLE_SIZE).find("<paper") != std::string_view::npos)
+		return xmlReader;
+	return mathReader;
+}
+
+IngestionReport CorpusIngestor::ingest(std::string const& corpusPath, IArticlesReader::ArticleHandler const& onArticle) const
+{
+	return ingest(listFiles(corpusPath), onArticle);
+}
+
+/**
+ * \brief files are read concurrently and handed off in their order: the file whose turn it is passes its articles
+ * to the handler as they are read, the next files keep copies of theirs until their turn comes.
+ * So at most ioThreadsCount files are held at once and articles of a corpus always come in the same order
+ */
+IngestionReport CorpusIngestor::ingest(std::vector<std::string> const& filePaths, IArticlesReader::ArticleHandler const& onArticle) const
+{
+	auto start = std::chrono::steady_clock::now();
+	IngestionReport report;
+	std::mutex turnMutex;
+	std::condition_variable turnChanged;
+	// index of the file whose articles are passed to the handler, it's changed under turnMutex
+	std::atomic<size_t> turnFile = 0;
+	std::atomic<size_t> nextFile = 0;
+	std::atomic<bool> isFailed = false;
+
+	auto readFiles = [&]()
+	{
+		try
+		{
+			for (size_t i = nextFile++; i < filePaths.size() && !isFailed; i = nextFile++)
+			{
+				MappedFile file(filePaths[i]);
+				auto text = file.view();
+				std::string converted;
+				bool isConverted = detectEncoding(text) == Encoding::UTF8;
+				if (isConverted)
+				{
+					if (text.substr(0, UTF8_BOM.size()) == UTF8_BOM)
+						text.remove_prefix(UTF8_BOM.size());
+					converted = EncodingUtils::UTF8ToCp1251(text);
+					text = converted;
+				}
+				size_t articlesCount = 0;
+				std::vector<std::pair<std::string, std::string>> pendingArticles;
+				auto passPendingArticles = [&]()
+				{
+					for (auto const& [title, content] : pendingArticles)
+						onArticle(title, content);
+					articlesCount += pendingArticles.size();
+					pendingArticles = {};
+				};
+				selectReader(filePaths[i], text).read(text, [&](std::string_view title, std::string_view content)
+					{
+						if (turnFile != i)
+						{
+							pendingArticles.emplace_back(title, content);
+							return;
+						}
+						passPendingArticles();
+						onArticle(title, content);
+						articlesCount++;
+					});
+
+				{
+					std::unique_lock lock(turnMutex);
+					turnChanged.wait(lock, [&]() {return turnFile == i || isFailed; });
+				}
+				if (isFailed)
+					return;
+				passPendingArticles();
+				// only the file of the turn changes the report
+				report.filesCount++;
+				report.bytesCount += file.size();
+				report.convertedFilesCount += isConverted;
+				report.articlesCount += articlesCount;
+				{
+					std::lock_guard lock(turnMutex);
+					turnFile++;
+				}
+				turnChanged.notify_all();
+			}
+		}
+		catch (...)
+		{
+			{
+				std::lock_guard lock(turnMutex);
+				isFailed = true;
+			}
+			turnChanged.notify_all();
+			throw;
+		}
+	};
+
+	std::vector<std::future<void>> workers;
+	for (size_t i = 0; i < std::min(_ioThreadsCount, filePaths.size()); i++)
+		workers.push_back(std::async(std::launch::async, readFiles));
+	for (auto& worker : workers)
+		worker.wait();
+	for (auto& worker : workers)
+		worker.get();
+
+	report.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	return report;
+}
@@ -0,0 +1,45 @@
+﻿#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "ArticlesReader/IArticlesReader.h"
+
+struct IngestionReport
+{
+	size_t filesCount = 0;
+	size_t bytesCount = 0;	// size of source files
+	size_t convertedFilesCount = 0;	// files converted from UTF-8
+	size_t articlesCount = 0;
+	double seconds = 0;
+	double megabytesPerSecond() const;
+};
+
+/**
+ * \brief reads corpus files of different formats and encodings with a bounded pool of I/O threads.
+ * Files are read concurrently, articles are passed to the handler one at a time in the order of files
+ */
+class CorpusIngestor
+{
+public:
+	enum class Encoding { Cp1251, UTF8 };
+
+	// ioThreadsCount - count of files read at once, 0 - hardware concurrency
+	explicit CorpusIngestor(size_t ioThreadsCount = 4);
+
+	// corpusPath is a directory (files are searched recursively) or a manifest file with a file path in each line,
+	// relative paths in the manifest are relative to its directory
+	// throw std::runtime_error when corpus path doesn't exist
+	static std::vector<std::string> listFiles(std::string const& corpusPath);
+	// articles are passed in cp1251
+	// throw std::runtime_error when file can't be read, exceptions of the handler are rethrown
+	IngestionReport ingest(std::string const& corpusPath, IArticlesReader::ArticleHandler const& onArticle) const;
+	IngestionReport ingest(std::vector<std::string> const& filePaths, IArticlesReader::ArticleHandler const& onArticle) const;
+
+	static Encoding detectEncoding(std::string_view text);
+	// xml reader for files with .xml extension or with paper tags, math reader otherwise
+	static IArticlesReader const& selectReader(std::string const& filePath, std::string_view text);
+
+private:
+	size_t _ioThreadsCount;
+};
@@ -0,0 +1,365 @@
+﻿#include "FrozenSemanticGraph.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+
+#include "Utils/BinaryUtils.h"
+#include "Utils/MappedFile.h"
+#include "Utils/MemoryStreamBuf.h"
+
+constexpr char SNAPSHOT_MAGIC[4] = { 'T', 'A', 'F', 'G' };
+// a snapshot of other version isn't read, the version is changed with the format
+constexpr uint32_t SNAPSHOT_VERSION = 1;
+
+/**
+ * \brief links are collected in the order of hashes first, then nodes are placed in the given order
+ * and the targets of each node are sorted by their new indexes
+ */
+template <typename Weight>
+FrozenSemanticGraph<Weight>::FrozenSemanticGraph(SemanticGraph const& graph, NodesOrdering::Order order) :
+	_nForNgram(graph.getNForNgram()),
+	_nodesOrder(order)
+{
+	auto linksCount = graph.getLinksCount();
+	if (graph.nodes.size() >= TermTable::NO_INDEX || linksCount > std::numeric_limits<uint32_t>::max())
+		throw std::length_error("Graph is too large to freeze");
+	std::vector<Node const*> nodes;
+	std::vector<size_t> hashes;
+	nodes.reserve(graph.nodes.size());
+	hashes.reserve(graph.nodes.size());
+	for (auto&& [hash, node] : graph.nodes)
+	{
+		nodes.push_back(&node);
+		hashes.push_back(hash);
+	}
+	std::vector<uint32_t> hashOffsets = { 0 };
+	std::vector<Index> hashTargets;
+	std::vector<double> hashLinksWeights;
+	hashOffsets.reserve(nodes.size() + 1);
+	hashTargets.reserve(linksCount);
+	hashLinksWeights.reserve(linksCount);
+	for (auto node : nodes)
+	{
+		for (auto&& [neighborHash, link] : node->neighbors)
+		{
+			auto target = std::lower_bound(hashes.begin(), hashes.end(), neighborHash);
+			if (target == hashes.end() || *target != neighborHash)
+				throw std::invalid_argument("Link of " + node->term.view + " leads to a missing term");
+			hashTargets.push_back(static_cast<Index>(target - hashes.begin()));
+			hashLinksWeights.push_back(link.weight);
+		}
+		hashOffsets.push_back(static_cast<uint32_t>(hashTargets.size()));
+	}
+
+	auto newOrder = NodesOrdering::calculate(order, hashOffsets, hashTargets);
+	std::vector<Index> newIndexes(nodes.size());
+	for (Index i = 0; i < newOrder.size(); i++)
+		newIndexes[newOrder[i]] = i;
+	std::vector<double> weights;
+	std::vector<double> linksWeights;
+	std::vector<std::pair<Index, double>> links;
+	weights.reserve(nodes.size());
+	linksWeights.reserve(linksCount);
+	_linksOffsets.reserve(nodes.size() + 1);
+	_linksTargets.reserve(linksCount);
+	for (auto oldIndex : newOrder)
+	{
+		_terms.add(nodes[oldIndex]->term);
+		weights.push_back(nodes[oldIndex]->weight);
+		links.clear();
+		for (auto link = hashOffsets[oldIndex]; link < hashOffsets[oldIndex + 1]; link++)
+			links.emplace_back(newIndexes[hashTargets[link]], hashLinksWeights[link]);
+		std::sort(links.begin(), links.end());
+		for (auto [target, weight] : links)
+		{
+			_linksTargets.push_back(target);
+			linksWeights.push_back(weight);
+		}
+		_linksOffsets.push_back(static_cast<uint32_t>(_linksTargets.size()));
+	}
+	_idf = IdfTable(_terms, graph.getArticlesCount());
+	_weights = WeightArray<Weight>(weights);
+	_linksWeights = WeightArray<Weight>(linksWeights);
+}
+
+template <typename Weight>
+size_t FrozenSemanticGraph<Weight>::getNForNgram() const
+{
+	return _nForNgram;
+}
+
+template <typename Weight>
+NodesOrdering::Order FrozenSemanticGraph<Weight>::nodesOrder() const
+{
+	return _nodesOrder;
+}
+
+template <typename Weight>
+size_t FrozenSemanticGraph<Weight>::nodesCount() const
+{
+	return _terms.size();
+}
+
+template <typename Weight>
+size_t FrozenSemanticGraph<Weight>::getLinksCount() const
+{
+	return _linksTargets.size();
+}
+
+template <typename Weight>
+TermTable const& FrozenSemanticGraph<Weight>::terms() const
+{
+	return _terms;
+}
+
+template <typename Weight>
+bool FrozenSemanticGraph<Weight>::isTermExist(size_t termHash) const
+{
+	return _terms.find(termHash) != TermTable::NO_INDEX;
+}
+
+template <typename Weight>
+typename FrozenSemanticGraph<Weight>::Index FrozenSemanticGraph<Weight>::find(size_t termHash) const
+{
+	return _terms.find(termHash);
+}
+
+template <typename Weight>
+double FrozenSemanticGraph<Weight>::getWeight(Index node) const
+{
+	return _weights[node];
+}
+
+template <typename Weight>
+size_t FrozenSemanticGraph<Weight>::getArticlesCount() const
+{
+	return _idf.getArticlesCount();
+}
+
+template <typename Weight>
+IdfTable const& FrozenSemanticGraph<Weight>::idf() const
+{
+	return _idf;
+}
+
+template <typename Weight>
+void FrozenSemanticGraph<Weight>::setDocumentsCount(Index node, uint32_t documentsCount)
+{
+	_terms.setDocumentsCount(node, documentsCount);
+	_idf.update(_terms, node);
+}
+
+template <typename Weight>
+void FrozenSemanticGraph<Weight>::setArticlesCount(size_t articlesCount)
+{
+	_idf.setArticlesCount(_terms, articlesCount);
+}
+
+template <typename Weight>
+size_t FrozenSemanticGraph<Weight>::getLinksBegin(Index node) const
+{
+	return _linksOffsets[node];
+}
+
+template <typename Weight>
+size_t FrozenSemanticGraph<Weight>::getLinksEnd(Index node) const
+{
+	return _linksOffsets[node + 1];
+}
+
+template <typename Weight>
+typename FrozenSemanticGraph<Weight>::Index FrozenSemanticGraph<Weight>::getLinkTarget(size_t link) const
+{
+	return _linksTargets[link];
+}
+
+template <typename Weight>
+double FrozenSemanticGraph<Weight>::getLinkWeight(size_t link) const
+{
+	return _linksWeights[link];
+}
+
+template <typename Weight>
+double FrozenSemanticGraph<Weight>::getLinkWeight(size_t firstTermHash, size_t secondTermHash) const
+{
+	auto first = find(firstTermHash);
+	auto second = find(secondTermHash);
+	if (first == TermTable::NO_INDEX || second == TermTable::NO_INDEX)
+		throw std::out_of_range("No such term in the frozen graph");
+	auto begin = _linksTargets.begin() + getLinksBegin(first);
+	auto end = _linksTargets.begin() + getLinksEnd(first);
+	auto it = std::lower_bound(begin, end, second);
+	if (it == end || *it != second)
+		throw std::out_of_range("No such link in the frozen graph");
+	return getLinkWeight(static_cast<size_t>(it - _linksTargets.begin()));
+}
+
+template <typename Weight>
+double FrozenSemanticGraph<Weight>::sumLinksWeight(Index node) const
+{
+	double sum = 0;
+	for (auto link = getLinksBegin(node); link < getLinksEnd(node); link++)
+		sum += getLinkWeight(link);
+	return sum;
+}
+
+/**
+ * \brief breadth-first, so each node is within radius even if it's reached by a longer path first.
+ * Visited nodes are flags by index, so a query doesn't hash or allocate per node
+ */
+template <typename Weight>
+std::vector<typename FrozenSemanticGraph<Weight>::Index> FrozenSemanticGraph<Weight>::getNeighborhood(size_t centerHash, unsigned radius, double minWeight) const
+{
+	std::vector<Index> neighborhood;
+	auto center = find(centerHash);
+	if (center == TermTable::NO_INDEX)
+		return neighborhood;
+	std::vector<bool> isVisited(nodesCount());
+	isVisited[center] = true;
+	neighborhood.push_back(center);
+	for (size_t levelBegin = 0; radius > 0 && levelBegin < neighborhood.size(); radius--)
+	{
+		auto levelEnd = neighborhood.size();
+		for (auto i = levelBegin; i < levelEnd; i++)
+			for (auto link = getLinksBegin(neighborhood[i]); link < getLinksEnd(neighborhood[i]); link++)
+			{
+				auto target = getLinkTarget(link);
+				if (getLinkWeight(link) >= minWeight && !isVisited[target])
+				{
+					isVisited[target] = true;
+					neighborhood.push_back(target);
+				}
+			}
+		levelBegin = levelEnd;
+	}
+	return neighborhood;
+}
+
+template <typename Weight>
+SemanticGraph FrozenSemanticGraph<Weight>::toSemanticGraph() const
+{
+	SemanticGraph graph(_nForNgram);
+	graph.setArticlesCount(getArticlesCount());
+	for (Index node = 0; node < nodesCount(); node++)
+	{
+		graph.addTerm(_terms.getTerm(node));
+		graph.addTermWeight(_terms.getHash(node), getWeight(node));
+	}
+	for (Index node = 0; node < nodesCount(); node++)
+		for (auto link = getLinksBegin(node); link < getLinksEnd(node); link++)
+			graph.createLink(_terms.getHash(node), _terms.getHash(getLinkTarget(link)), getLinkWeight(link));
+	return graph;
+}
+
+template <typename Weight>
+void FrozenSemanticGraph<Weight>::exportToStream(std::ostream& out) const
+{
+	out << nodesCount() << std::endl;
+	for (Index node = 0; node < nodesCount(); node++)
+	{
+		out << _terms.getView(node) << '\n' << getWeight(node) << ' ' << _terms.getDocumentsCount(node) << ' ' << _terms.getWordsCount(node) << ' ';
+		for (size_t i = 0; i < _terms.getWordsCount(node); i++)
+			out << _terms.getWord(node, i) << ' ';
+		out << std::endl;
+	}
+
+	out << getLinksCount() << std::endl;
+	for (Index node = 0; node < nodesCount(); node++)
+		for (auto link = getLinksBegin(node); link < getLinksEnd(node); link++)
+			out << node << ' ' << getLinkTarget(link) << ' ' << getLinkWeight(link) << std::endl;
+	out << getArticlesCount() << std::endl;
+}
+
+/**
+ * \brief snapshot is: magic, version, weight type, nodes order, n for n-grams, articles count, terms, weights, links offsets, targets and weights
+ */
+template <typename Weight>
+void FrozenSemanticGraph<Weight>::saveToStream(std::ostream& out) const
+{
+	out.write(SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+	BinaryUtils::write(out, SNAPSHOT_VERSION);
+	BinaryUtils::writeString(out, WeightArray<Weight>::NAME);
+	BinaryUtils::write(out, static_cast<uint32_t>(_nodesOrder));
+	BinaryUtils::write<uint64_t>(out, _nForNgram);
+	BinaryUtils::write<uint64_t>(out, getArticlesCount());
+	_terms.saveToStream(out);
+	_weights.saveToStream(out);
+	BinaryUtils::writeVector(out, _linksOffsets);
+	BinaryUtils::writeVector(out, _linksTargets);
+	_linksWeights.saveToStream(out);
+}
+
+template <typename Weight>
+void FrozenSemanticGraph<Weight>::loadFromStream(std::istream& in)
+{
+	char magic[sizeof(SNAPSHOT_MAGIC)];
+	if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, SNAPSHOT_MAGIC, sizeof(magic)) != 0)
+		throw std::runtime_error("Not a frozen graph snapshot");
+	auto version = BinaryUtils::read<uint32_t>(in);
+	if (version != SNAPSHOT_VERSION)
+		throw std::runtime_error("Unsupported frozen graph snapshot version " + std::to_string(version));
+	auto weightType = BinaryUtils::readString(in);
+	if (weightType != WeightArray<Weight>::NAME)
+		throw std::runtime_error("Snapshot weights are " + weightType + ", not " + WeightArray<Weight>::NAME);
+
+	FrozenSemanticGraph graph;
+	auto order = BinaryUtils::read<uint32_t>(in);
+	if (order >= NodesOrdering::ORDERS.size())
+		throw std::runtime_error("Broken frozen graph snapshot");
+	graph._nodesOrder = static_cast<NodesOrdering::Order>(order);
+	graph._nForNgram = static_cast<size_t>(BinaryUtils::read<uint64_t>(in));
+	auto articlesCount = static_cast<size_t>(BinaryUtils::read<uint64_t>(in));
+	graph._terms.loadFromStream(in);
+	graph._weights.loadFromStream(in);
+	graph._linksOffsets = BinaryUtils::readVector<uint32_t>(in);
+	graph._linksTargets = BinaryUtils::readVector<Index>(in);
+	graph._linksWeights.loadFromStream(in);
+
+	auto const& offsets = graph._linksOffsets;
+	auto const& targets = graph._linksTargets;
+	auto nodesCount = graph.nodesCount();
+	if (articlesCount == 0 || graph._weights.size() != nodesCount || offsets.size() != nodesCount + 1 || offsets.front() != 0
+		|| !std::is_sorted(offsets.begin(), offsets.end()) || offsets.back() != targets.size()
+		|| graph._linksWeights.size() != targets.size()
+		|| std::any_of(targets.begin(), targets.end(), [nodesCount](Index target) {return target >= nodesCount; }))
+		throw std::runtime_error("Broken frozen graph snapshot");
+	graph._idf = IdfTable(graph._terms, articlesCount);
+	*this = std::move(graph);
+}
+
+template <typename Weight>
+void FrozenSemanticGraph<Weight>::saveToFile(std::string const& filePath) const
+{
+	std::ofstream fout(filePath, std::ios::binary | std::ios::trunc);
+	if (!fout.is_open())
+		throw std::runtime_error("Can't create file " + filePath);
+	saveToStream(fout);
+	if (!fout)
+		throw std::runtime_error("Can't write file " + filePath);
+}
+
+/**
+ * \brief the file is mapped into memory and its arrays are copied from it
+ */
+template <typename Weight>
+void FrozenSemanticGraph<Weight>::loadFromFile(std::string const& filePath)
+{
+	MappedFile file(filePath);
+	MemoryStreamBuf buffer(file.view());
+	std::istream in(&buffer);
+	loadFromStream(in);
+}
+
+template <typename Weight>
+size_t FrozenSemanticGraph<Weight>::getMemoryUsage() const
+{
+	return _terms.getMemoryUsage() + _idf.getMemoryUsage() + _weights.getMemoryUsage() + _linksOffsets.capacity() * sizeof(uint32_t)
+		+ _linksTargets.capacity() * sizeof(Index) + _linksWeights.getMemoryUsage();
+}
+
+template class FrozenSemanticGraph<double>;
+template class FrozenSemanticGraph<float>;
+template class FrozenSemanticGraph<Quantized16>;
@@ -0,0 +1,82 @@
+﻿#pragma once
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "IdfTable.h"
+#include "NodesOrdering.h"
+#include "SemanticGraph.h"
+#include "TermTable.h"
+#include "WeightArray.h"
+
+/**
+ * \brief read-only form of a semantic graph: terms are in a TermTable, links of all nodes are in one array
+ * ordered by source node (compressed sparse rows), weights are stored as Weight (double, float or Quantized16).
+ * Nodes are indexed in the given order, so traversals may read neighbors close to each other
+ */
+template <typename Weight>
+class FrozenSemanticGraph
+{
+public:
+	using Index = TermTable::Index;
+
+	FrozenSemanticGraph() = default;
+	explicit FrozenSemanticGraph(SemanticGraph const& graph, NodesOrdering::Order order = NodesOrdering::Order::Hash);
+
+	size_t getNForNgram() const;
+	NodesOrdering::Order nodesOrder() const;
+	size_t nodesCount() const;
+	size_t getLinksCount() const;
+	TermTable const& terms() const;
+	bool isTermExist(size_t termHash) const;
+	// TermTable::NO_INDEX when there is no such term
+	Index find(size_t termHash) const;
+	double getWeight(Index node) const;
+
+	size_t getArticlesCount() const;
+	IdfTable const& idf() const;
+	// statistics of new articles, the idf of the term or of all terms are updated
+	void setDocumentsCount(Index node, uint32_t documentsCount);
+	void setArticlesCount(size_t articlesCount);
+
+	// links of the node are [getLinksBegin(node), getLinksEnd(node)), their targets are sorted
+	size_t getLinksBegin(Index node) const;
+	size_t getLinksEnd(Index node) const;
+	Index getLinkTarget(size_t link) const;
+	double getLinkWeight(size_t link) const;
+	// throw std::out_of_range when there is no such link
+	double getLinkWeight(size_t firstTermHash, size_t secondTermHash) const;
+	double sumLinksWeight(Index node) const;
+	// nodes within radius links from the center by links not lighter than minWeight, the center is the first
+	std::vector<Index> getNeighborhood(size_t centerHash, unsigned radius, double minWeight = 0) const;
+
+	SemanticGraph toSemanticGraph() const;
+	// the text format of SemanticGraph::exportToStream
+	void exportToStream(std::ostream& out) const;
+
+	// binary snapshot, loading throws std::runtime_error when the data is broken or has other weight type
+	void saveToStream(std::ostream& out) const;
+	void loadFromStream(std::istream& in);
+	// throw std::runtime_error when file can't be opened
+	void saveToFile(std::string const& filePath) const;
+	void loadFromFile(std::string const& filePath);
+
+	// bytes of terms, idf, weights and links arrays
+	size_t getMemoryUsage() const;
+
+private:
+	size_t _nForNgram = 4;
+	NodesOrdering::Order _nodesOrder = NodesOrdering::Order::Hash;
+	TermTable _terms;
+	IdfTable _idf;
+	WeightArray<Weight> _weights;
+	// links of node i are [_linksOffsets[i], _linksOffsets[i + 1])
+	std::vector<uint32_t> _linksOffsets = { 0 };
+	std::vector<Index> _linksTargets;
+	WeightArray<Weight> _linksWeights;
+};
+
+extern template class FrozenSemanticGraph<double>;
+extern template class FrozenSemanticGraph<float>;
+extern template class FrozenSemanticGraph<Quantized16>;
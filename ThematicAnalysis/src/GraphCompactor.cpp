@@ -0,0 +1,140 @@
+﻿#include "GraphCompactor.h"
+
+#include <algorithm>
+#include <numeric>
+
+#include "TagsAnalyzer.h"
+#include "Utils/ThreadPool.h"
+
+GraphCompactor::GraphCompactor(size_t maxLinksPerNode, double minLinkWeight) :
+	_maxLinksPerNode(maxLinksPerNode),
+	_minLinkWeight(minLinkWeight)
+{
+}
+
+/**
+ * \brief keep only links heavier than min weight and not more than max links count for the node
+ * (the heaviest links are kept)
+ */
+std::vector<size_t> GraphCompactor::selectPrunedLinks(Node const& node) const
+{
+	std::vector<size_t> pruned;
+	std::vector<std::pair<double, size_t>> links;
+	links.reserve(node.neighbors.size());
+	for (auto&& [hash, link] : node.neighbors)
+		if (link.weight < _minLinkWeight)
+			pruned.push_back(hash);
+		else
+			links.emplace_back(link.weight, hash);
+
+	if (_maxLinksPerNode > 0 && links.size() > _maxLinksPerNode)
+	{
+		auto isHeavier = [](auto const& a, auto const& b) {return a.first > b.first || (a.first == b.first && a.second < b.second); };
+		std::nth_element(links.begin(), links.begin() + static_cast<ptrdiff_t>(_maxLinksPerNode), links.end(), isHeavier);
+		for (auto it = links.begin() + static_cast<ptrdiff_t>(_maxLinksPerNode); it != links.end(); ++it)
+			pruned.push_back(it->second);
+	}
+	return pruned;
+}
+
+/**
+ * \brief terms which have at least one incoming or outgoing link
+ */
+std::set<size_t> GraphCompactor::getLinkedTerms(SemanticGraph const& graph)
+{
+	std::set<size_t> linked;
+	for (auto&& [hash, node] : graph.nodes)
+	{
+		if (!node.neighbors.empty())
+			linked.insert(hash);
+		for (auto&& [neighborHash, link] : node.neighbors)
+			linked.insert(neighborHash);
+	}
+	return linked;
+}
+
+/**
+ * \brief remove terms which lost all their links in compaction
+ * (terms which had no links before are kept)
+ */
+void GraphCompactor::removeOrphans(SemanticGraph& graph, std::set<size_t> const& linkedBefore)
+{
+	auto linkedAfter = getLinkedTerms(graph);
+	for (auto hash : linkedBefore)
+		if (linkedAfter.find(hash) == linkedAfter.end())
+			graph.nodes.erase(hash);
+}
+
+CompactionReport GraphCompactor::compact(SemanticGraph& graph) const
+{
+	CompactionReport report;
+	report.nodesBefore = graph.nodes.size();
+	report.linksBefore = graph.getLinksCount();
+
+	// without the articles count the idf would depend on the nodes count, which changes when orphans are removed,
+	// so the count of the graph before compaction is kept
+	if (!graph.hasArticlesCount())
+		graph.setArticlesCount(graph.nodes.size() + 1);
+	auto linkedBefore = getLinkedTerms(graph);
+	std::vector<Node*> nodes;
+	nodes.reserve(graph.nodes.size());
+	for (auto& [hash, node] : graph.nodes)
+		nodes.push_back(&node);
+	// links are selected in parallel and removed by one thread, because the graph pool isn't synchronized
+	std::vector<std::vector<size_t>> prunedLinks(nodes.size());
+	ThreadPool::instance().parallelFor(0, nodes.size(), [this, &nodes, &prunedLinks](size_t begin, size_t end)
+		{
+			for (auto i = begin; i < end; i++)
+				prunedLinks[i] = selectPrunedLinks(*nodes[i]);
+		});
+	for (size_t i = 0; i < nodes.size(); i++)
+	{
+		for (auto hash : prunedLinks[i])
+			nodes[i]->neighbors.erase(hash);
+		nodes[i]->isSumLinksWeightsChanged = true;
+	}
+	removeOrphans(graph, linkedBefore);
+
+	report.nodesAfter = graph.nodes.size();
+	report.linksAfter = graph.getLinksCount();
+	return report;
+}
+
+/**
+ * \brief compact graph and measure how the tags of sample texts changed
+ * \param normalizedSamples texts for tagging quality estimation
+ * \param tagsCount count of the top tags to compare
+ */
+CompactionReport GraphCompactor::compact(SemanticGraph& graph, std::vector<std::vector<std::string>> const& normalizedSamples, size_t tagsCount) const
+{
+	auto source = graph;
+	auto report = compact(graph);
+	if (!normalizedSamples.empty())
+	{
+		auto overlapSum = ThreadPool::instance().parallelReduce(0, normalizedSamples.size(), 0., [&](size_t begin, size_t end)
+			{
+				double sum = 0;
+				for (auto i = begin; i < end; i++)
+					sum += calcTagsOverlap(source, graph, normalizedSamples[i], tagsCount);
+				return sum;
+			}, std::plus<>(), 1);
+		report.tagsOverlap = overlapSum / static_cast<double>(normalizedSamples.size());
+	}
+	return report;
+}
+
+double GraphCompactor::calcTagsOverlap(SemanticGraph const& source, SemanticGraph const& compacted, std::vector<std::string> const& normalizedText, size_t tagsCount)
+{
+	TagsAnalyzer analyzer;
+	analyzer.analyze(normalizedText, source);
+	auto sourceTags = analyzer.getRelevantTags(tagsCount);
+	analyzer.analyze(normalizedText, compacted);
+	auto compactedTags = analyzer.getRelevantTags(tagsCount);
+	if (sourceTags.empty()) return 1.;
+
+	std::set<std::string> compactedViews;
+	for (auto& tag : compactedTags)
+		compactedViews.insert(tag.termView);
+	auto sameCount = std::count_if(sourceTags.begin(), sourceTags.end(), [&compactedViews](Tag const& tag) {return compactedViews.count(tag.termView) > 0; });
+	return static_cast<double>(sameCount) / static_cast<double>(sourceTags.size());
+}
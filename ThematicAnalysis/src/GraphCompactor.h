@@ -0,0 +1,32 @@
+﻿#pragma once
+#include <set>
+
+#include "SemanticGraph.h"
+
+struct CompactionReport
+{
+	size_t nodesBefore = 0;
+	size_t nodesAfter = 0;
+	size_t linksBefore = 0;
+	size_t linksAfter = 0;
+	double tagsOverlap = 1.;	// average share of the top tags which are the same before and after compaction
+};
+
+class GraphCompactor
+{
+public:
+	// maxLinksPerNode == 0 - keep all links which are heavier than minLinkWeight
+	GraphCompactor(size_t maxLinksPerNode = 0, double minLinkWeight = 0);
+	CompactionReport compact(SemanticGraph& graph) const;
+	CompactionReport compact(SemanticGraph& graph, std::vector<std::vector<std::string>> const& normalizedSamples, size_t tagsCount = 10) const;
+
+private:
+	// hashes of the neighbors which links are removed
+	std::vector<size_t> selectPrunedLinks(Node const& node) const;
+	static std::set<size_t> getLinkedTerms(SemanticGraph const& graph);
+	static void removeOrphans(SemanticGraph& graph, std::set<size_t> const& linkedBefore);
+	static double calcTagsOverlap(SemanticGraph const& source, SemanticGraph const& compacted, std::vector<std::string> const& normalizedText, size_t tagsCount);
+
+	size_t _maxLinksPerNode;
+	double _minLinkWeight;
+};
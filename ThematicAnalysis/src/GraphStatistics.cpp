@@ -0,0 +1,184 @@
+﻿#include "GraphStatistics.h"
+
+#include <algorithm>
+#include <numeric>
+#include <unordered_map>
+
+#include "TermTable.h"
+#include "Utils/ThreadPool.h"
+
+const std::vector<double> GraphStatistics::QUANTILES = { 0., 0.1, 0.25, 0.5, 0.75, 0.9, 0.99, 1. };
+
+size_t GraphMemoryUsage::total() const
+{
+	return nodes + links + views + normalizedWords;
+}
+
+/**
+ * \brief calculate statistics of the graph, independent parts are calculated in parallel
+ * \param hubMinDegree min count of node links (incoming and outgoing) to detect node as hub
+ */
+GraphStatistics GraphStatistics::calculate(SemanticGraph const& graph, size_t hubMinDegree)
+{
+	GraphStatistics statistics;
+	statistics.nodesCount = graph.nodes.size();
+	statistics.linksCount = graph.getLinksCount();
+
+	auto& pool = ThreadPool::instance();
+	pool.wait({
+		pool.run([&] {statistics.calcDegrees(graph, hubMinDegree); }),
+		pool.run([&] {statistics.calcWeightQuantiles(graph); }),
+		pool.run([&] {statistics.calcComponents(graph); }),
+		pool.run([&] {statistics.calcMemoryUsage(graph); }),
+	});
+	return statistics;
+}
+
+void GraphStatistics::calcDegrees(SemanticGraph const& graph, size_t hubMinDegree)
+{
+	std::unordered_map<size_t, size_t> inDegrees;
+	inDegrees.reserve(graph.nodes.size());
+	for (auto&& [hash, node] : graph.nodes)
+		for (auto&& [neighborHash, link] : node.neighbors)
+			++inDegrees[neighborHash];
+
+	for (auto&& [hash, node] : graph.nodes)
+	{
+		auto inDegreeIt = inDegrees.find(hash);
+		auto inDegree = inDegreeIt == inDegrees.end() ? 0 : inDegreeIt->second;
+		++outDegreeDistribution[node.neighbors.size()];
+		++inDegreeDistribution[inDegree];
+		if (node.neighbors.size() + inDegree > hubMinDegree)
+			hubs.push_back({ node.term.view, node.neighbors.size(), inDegree });
+	}
+	std::sort(hubs.begin(), hubs.end(), [](Hub const& a, Hub const& b) {return a.outDegree + a.inDegree > b.outDegree + b.inDegree; });
+}
+
+void GraphStatistics::calcWeightQuantiles(SemanticGraph const& graph)
+{
+	std::vector<double> weights;
+	weights.reserve(linksCount);
+	for (auto&& [hash, node] : graph.nodes)
+		for (auto&& [neighborHash, link] : node.neighbors)
+			weights.push_back(link.weight);
+	if (weights.empty()) return;
+
+	std::sort(weights.begin(), weights.end());
+	for (auto quantile : QUANTILES)
+		weightQuantiles.push_back(weights[static_cast<size_t>(quantile * static_cast<double>(weights.size() - 1))]);
+}
+
+size_t findRoot(std::vector<size_t>& parents, size_t index)
+{
+	while (parents[index] != index)
+		index = parents[index] = parents[parents[index]];
+	return index;
+}
+
+/**
+ * \brief find weakly connected components with union-find
+ */
+void GraphStatistics::calcComponents(SemanticGraph const& graph)
+{
+	std::unordered_map<size_t, size_t> indexes;
+	indexes.reserve(graph.nodes.size());
+	for (auto&& [hash, node] : graph.nodes)
+		indexes.emplace(hash, indexes.size());
+
+	std::vector<size_t> parents(indexes.size());
+	std::iota(parents.begin(), parents.end(), 0);
+	for (auto&& [hash, node] : graph.nodes)
+		for (auto&& [neighborHash, link] : node.neighbors)
+		{
+			auto neighborIt = indexes.find(neighborHash);
+			if (neighborIt == indexes.end()) continue;
+			auto first = findRoot(parents, indexes[hash]), second = findRoot(parents, neighborIt->second);
+			if (first != second)
+				parents[std::max(first, second)] = std::min(first, second);
+		}
+
+	std::vector<size_t> componentsSizes(parents.size(), 0);
+	for (size_t i = 0; i < parents.size(); i++)
+		++componentsSizes[findRoot(parents, i)];
+	for (auto size : componentsSizes)
+	{
+		if (size == 0) continue;
+		++componentsCount;
+		if (size == 1) ++isolatedNodesCount;
+		largestComponentSize = std::max(largestComponentSize, size);
+	}
+}
+
+/**
+ * \brief heap memory used by string (0 for short strings which are stored inside the object)
+ */
+size_t getHeapSize(std::string const& str)
+{
+	return str.capacity() > std::string().capacity() ? str.capacity() + 1 : 0;
+}
+
+void GraphStatistics::calcMemoryUsage(SemanticGraph const& graph)
+{
+	constexpr size_t treeNodeOverhead = 3 * sizeof(void*) + 2 * sizeof(char);
+	memory.nodes = sizeof(graph.nodes) + graph.nodes.size() * (treeNodeOverhead + sizeof(std::pair<size_t const, Node>));
+	for (auto&& [hash, node] : graph.nodes)
+	{
+		memory.links += node.neighbors.size() * (treeNodeOverhead + sizeof(std::pair<size_t const, Link>));
+		memory.views += getHeapSize(node.term.view);
+		memory.normalizedWords += node.term.normalizedWords.capacity() * sizeof(std::string);
+		for (auto& word : node.term.normalizedWords)
+			memory.normalizedWords += getHeapSize(word);
+	}
+	memory.termTable = TermTable(graph).getMemoryUsage();
+}
+
+void writeJsonString(std::ostream& out, std::string const& str)
+{
+	out << '"';
+	for (auto ch : str)
+	{
+		if (ch == '"' || ch == '\\') out << '\\' << ch;
+		else if (ch == '\n') out << "\\n";
+		else if (ch == '\t') out << "\\t";
+		else out << ch;
+	}
+	out << '"';
+}
+
+void writeJsonDistribution(std::ostream& out, std::map<size_t, size_t> const& distribution)
+{
+	out << '{';
+	for (auto it = distribution.begin(); it != distribution.end(); ++it)
+		out << (it == distribution.begin() ? "" : ", ") << '"' << it->first << "\": " << it->second;
+	out << '}';
+}
+
+void GraphStatistics::exportToJson(std::ostream& out) const
+{
+	out << "{\n";
+	out << "  \"nodesCount\": " << nodesCount << ",\n";
+	out << "  \"linksCount\": " << linksCount << ",\n";
+	out << "  \"outDegreeDistribution\": ";
+	writeJsonDistribution(out, outDegreeDistribution);
+	out << ",\n  \"inDegreeDistribution\": ";
+	writeJsonDistribution(out, inDegreeDistribution);
+	out << ",\n  \"weightQuantiles\": {";
+	for (size_t i = 0; i < weightQuantiles.size(); i++)
+		out << (i == 0 ? "" : ", ") << '"' << QUANTILES[i] << "\": " << weightQuantiles[i];
+	out << "},\n";
+	out << "  \"componentsCount\": " << componentsCount << ",\n";
+	out << "  \"largestComponentSize\": " << largestComponentSize << ",\n";
+	out << "  \"isolatedNodesCount\": " << isolatedNodesCount << ",\n";
+	out << "  \"hubs\": [";
+	for (size_t i = 0; i < hubs.size(); i++)
+	{
+		out << (i == 0 ? "\n    " : ",\n    ") << "{\"term\": ";
+		writeJsonString(out, hubs[i].termView);
+		out << ", \"outDegree\": " << hubs[i].outDegree << ", \"inDegree\": " << hubs[i].inDegree << '}';
+	}
+	out << (hubs.empty() ? "],\n" : "\n  ],\n");
+	out << "  \"memory\": {\"nodes\": " << memory.nodes << ", \"links\": " << memory.links
+		<< ", \"views\": " << memory.views << ", \"normalizedWords\": " << memory.normalizedWords
+		<< ", \"termTable\": " << memory.termTable << ", \"total\": " << memory.total() << "}\n";
+	out << "}\n";
+}
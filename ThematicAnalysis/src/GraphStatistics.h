@@ -0,0 +1,51 @@
+﻿#pragma once
+#include <map>
+#include <ostream>
+
+#include "SemanticGraph.h"
+
+struct Hub
+{
+	std::string termView;
+	size_t outDegree;
+	size_t inDegree;
+};
+
+/**
+ * \brief approximate memory usage of graph structures in bytes
+ */
+struct GraphMemoryUsage
+{
+	size_t nodes = 0;	// nodes tree
+	size_t links = 0;	// neighbors trees
+	size_t views = 0;	// term views
+	size_t normalizedWords = 0;	// term normalized words
+	size_t termTable = 0;	// the same terms in TermTable, isn't part of total
+	size_t total() const;
+};
+
+class GraphStatistics
+{
+public:
+	static GraphStatistics calculate(SemanticGraph const& graph, size_t hubMinDegree = 200);
+	void exportToJson(std::ostream& out) const;
+
+	static const std::vector<double> QUANTILES;
+
+	size_t nodesCount = 0;
+	size_t linksCount = 0;
+	std::map<size_t, size_t> outDegreeDistribution;	// out degree -> count of nodes
+	std::map<size_t, size_t> inDegreeDistribution;	// in degree -> count of nodes
+	std::vector<double> weightQuantiles;	// link weights at QUANTILES levels
+	size_t componentsCount = 0;	// weakly connected components
+	size_t largestComponentSize = 0;
+	size_t isolatedNodesCount = 0;
+	std::vector<Hub> hubs;	// nodes with in + out degree more than hubMinDegree, sorted by degree
+	GraphMemoryUsage memory;
+
+private:
+	void calcDegrees(SemanticGraph const& graph, size_t hubMinDegree);
+	void calcWeightQuantiles(SemanticGraph const& graph);
+	void calcComponents(SemanticGraph const& graph);
+	void calcMemoryUsage(SemanticGraph const& graph);
+};
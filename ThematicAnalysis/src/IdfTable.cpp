@@ -0,0 +1,61 @@
+﻿#include "IdfTable.h"
+#include <stdexcept>
+
+#include "Utils/TermsUtils.h"
+
+IdfTable::IdfTable(TermTable const& terms, size_t articlesCount)
+{
+	setArticlesCount(terms, articlesCount);
+}
+
+size_t IdfTable::getArticlesCount() const
+{
+	return _articlesCount;
+}
+
+void IdfTable::setArticlesCount(TermTable const& terms, size_t articlesCount)
+{
+	_articlesCount = articlesCount;
+	_idf.resize(terms.size());
+	for (TermTable::Index i = 0; i < _idf.size(); i++)
+		_idf[i] = TermsUtils::calcIdf(terms.getDocumentsCount(i), _articlesCount);
+}
+
+void IdfTable::update(TermTable const& terms, TermTable::Index index)
+{
+	if (index >= terms.size() || index > _idf.size())
+		throw std::out_of_range("No such term in the idf table");
+	if (index == _idf.size())
+		_idf.push_back(0);
+	_idf[index] = TermsUtils::calcIdf(terms.getDocumentsCount(index), _articlesCount);
+}
+
+double IdfTable::operator[](TermTable::Index index) const
+{
+	return _idf[index];
+}
+
+size_t IdfTable::size() const
+{
+	return _idf.size();
+}
+
+/**
+ * \brief one pass over the text terms without branches, only their idf and weights are touched, not the whole table.
+ * The division is kept before the multiplication to get the same values as TermsUtils::calcTfIdf
+ */
+void IdfTable::addTfIdf(std::vector<TermTable::Index> const& terms, std::vector<size_t> const& counts, std::vector<double>& weights) const
+{
+	if (counts.size() != terms.size() || weights.size() != _idf.size())
+		throw std::invalid_argument("Counts must be of the terms size and weights of the idf table size");
+	auto termsCount = static_cast<double>(terms.size());
+	auto const* idf = _idf.data();
+	auto* weight = weights.data();
+	for (size_t i = 0; i < terms.size(); i++)
+		weight[terms[i]] += static_cast<double>(counts[i]) / termsCount * idf[terms[i]];
+}
+
+size_t IdfTable::getMemoryUsage() const
+{
+	return _idf.capacity() * sizeof(double);
+}
@@ -0,0 +1,35 @@
+﻿#pragma once
+#include <cstddef>
+#include <vector>
+
+#include "TermTable.h"
+
+/**
+ * \brief inverse document frequencies of the terms of a TermTable, indexed like the table.
+ * They are calculated once from the documents counts and updated when the counts change
+ */
+class IdfTable
+{
+public:
+	IdfTable() = default;
+	IdfTable(TermTable const& terms, size_t articlesCount);
+
+	size_t getArticlesCount() const;
+	// idf of all terms are recalculated
+	void setArticlesCount(TermTable const& terms, size_t articlesCount);
+	// after the documents count of the term is changed or the term is added to the table
+	void update(TermTable const& terms, TermTable::Index index);
+
+	double operator[](TermTable::Index index) const;
+	size_t size() const;
+
+	// weights[terms[i]] += counts[i] / terms.size() * idf[terms[i]] for the distinct terms of a text,
+	// weights are of the table size
+	void addTfIdf(std::vector<TermTable::Index> const& terms, std::vector<size_t> const& counts, std::vector<double>& weights) const;
+
+	size_t getMemoryUsage() const;
+
+private:
+	size_t _articlesCount = 0;
+	std::vector<double> _idf;
+};
@@ -1,14 +1,18 @@
 #include "Lemmatizer.h"
 #include <locale>
+#include <algorithm>
 #include <filesystem>
+#include <stdexcept>
+#include <string_view>
 
 #include "Utils/FileUtils.h"
+#include "Utils/Profiler.h"
 #include "Utils/StringUtils.h"
 
-std::string runMyStem(std::string const& tempFile)
+std::string runMyStem(std::string const& tempFile, std::string const& params)
 {
 	std::string output;
-	auto isExecuted = FileUtils::executeExeWithParams("external\\mystem.exe", "-e cp1251 -nl " + tempFile, output);
+	auto isExecuted = FileUtils::executeExeWithParams("external\\mystem.exe", params + " " + tempFile, output);
 	if (!isExecuted)
 	{
 		throw std::runtime_error("Can't run mystem.exe!");
@@ -25,12 +29,15 @@ std::string handleMyStemLine(std::string line)
 }
 
 
-std::string useMyStem(const std::string& text)
+std::string useMyStem(const std::string& text, std::string const& params = "-e cp1251 -nl")
 {
+	PROFILE_SCOPE("mystem");
+	PROFILE_COUNT("mystemCalls", 1);
+	PROFILE_COUNT("mystemInputBytes", text.size());
 	std::filesystem::create_directory("temp");
 	std::string tempFile = "temp/temp.txt";
 	FileUtils::writeToFile(tempFile, text);
-	auto resStr = runMyStem(tempFile);
+	auto resStr = runMyStem(tempFile, params);
 	std::filesystem::remove(tempFile);
 	return resStr;
 }
@@ -38,13 +45,59 @@ std::string useMyStem(const std::string& text)
 
 std::vector<std::string> Lemmatizer::lemmatizeText(const std::string& text) const
 {
+	PROFILE_SCOPE("Lemmatizer::lemmatizeText");
 	return lemmatizeTextWithMyStem(text);
 }
 
+std::string Lemmatizer::name() const
+{
+	return "mystem";
+}
+
 std::vector<std::string> Lemmatizer::lemmatizeTextWithMyStem(const std::string& text) const
 {
 	auto resText = useMyStem(text);
 	auto lines = StringUtils::split(resText, "\n", true);
 	std::transform(lines.begin(), lines.end(), lines.begin(), [](std::string& line) {return handleMyStemLine(line); });
 	return lines;
-}
\ No newline at end of file
+}
+
+/**
+ * \brief lemma of the word is the first of alternatives, "?" marks unknown words
+ */
+void addLemma(std::string_view lemma, std::vector<std::string>& tokens)
+{
+	lemma = lemma.substr(0, lemma.find('|'));
+	while (!lemma.empty() && lemma.back() == '?') lemma.remove_suffix(1);
+	if (!lemma.empty())
+		tokens.emplace_back(lemma);
+}
+
+/**
+ * \brief mystem copies the text (-c) with lemmas in braces after words: "word{lemma}",
+ * so lines of the output are the same as lines of the text
+ */
+SegmentedTokens Lemmatizer::lemmatizeLines(const std::string& text, size_t segmentsCount) const
+{
+	auto output = useMyStem(text, "-e cp1251 -cl");
+	SegmentedTokens result;
+	result.offsets.reserve(segmentsCount + 1);
+	std::string_view rest = output;
+	while (result.offsets.size() <= segmentsCount && !rest.empty())
+	{
+		auto line = rest.substr(0, rest.find('\n'));
+		rest.remove_prefix(std::min(rest.size(), line.size() + 1));
+		for (auto lemmaBegin = line.find('{'); lemmaBegin != std::string_view::npos; lemmaBegin = line.find('{', lemmaBegin))
+		{
+			auto lemmaEnd = line.find('}', lemmaBegin);
+			addLemma(line.substr(lemmaBegin + 1, lemmaEnd - lemmaBegin - 1), result.tokens);
+			lemmaBegin = lemmaEnd;
+		}
+		result.offsets.push_back(result.tokens.size());
+	}
+	if (rest.find('{') != std::string_view::npos)
+		throw std::runtime_error("mystem output has more lines than text");
+	// empty lines at the end may be omitted in output
+	result.offsets.resize(segmentsCount + 1, result.tokens.size());
+	return result;
+}
@@ -2,11 +2,19 @@
 #include <string>
 #include <vector>
 
-class Lemmatizer
+#include "Lemmatizer/ILemmatizer.h"
+
+/**
+ * \brief lemmatizer backend which runs mystem.exe from the external directory
+ */
+class Lemmatizer : public ILemmatizer
 {
 public:
 
-	std::vector<std::string> lemmatizeText(const std::string& text) const;
+	std::vector<std::string> lemmatizeText(const std::string& text) const override;
+	// each line of the text is a segment, throw std::runtime_error when lemmatizer output has more lines
+	SegmentedTokens lemmatizeLines(const std::string& text, size_t segmentsCount) const override;
+	std::string name() const override;
 private: 
 	std::vector<std::string> lemmatizeTextWithMyStem(const std::string& text) const;
 };
@@ -0,0 +1,59 @@
+﻿#include "DictionaryLemmatizer.h"
+
+#include <algorithm>
+#include <fstream>
+#include <utility>
+
+#include "Utils/MappedFile.h"
+
+DictionaryLemmatizer::DictionaryLemmatizer(std::unordered_map<std::string, std::string> lemmas) : _lemmas(std::move(lemmas))
+{
+}
+
+DictionaryLemmatizer DictionaryLemmatizer::loadFromFile(std::string const& filePath)
+{
+	MappedFile file(filePath);
+	DictionaryLemmatizer lemmatizer;
+	auto rest = file.view();
+	while (!rest.empty())
+	{
+		auto line = rest.substr(0, rest.find('\n'));
+		rest.remove_prefix(std::min(rest.size(), line.size() + 1));
+		if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+		auto separator = line.find(' ');
+		if (separator != std::string_view::npos)
+			lemmatizer.add(std::string(line.substr(0, separator)), std::string(line.substr(separator + 1)));
+	}
+	return lemmatizer;
+}
+
+void DictionaryLemmatizer::saveToFile(std::string const& filePath) const
+{
+	std::ofstream fout(filePath, std::ios::binary);
+	for (auto const& [word, lemma] : _lemmas)
+		fout << word << ' ' << lemma << '\n';
+}
+
+void DictionaryLemmatizer::add(std::string word, std::string lemma)
+{
+	_lemmas.insert_or_assign(std::move(word), std::move(lemma));
+}
+
+size_t DictionaryLemmatizer::size() const
+{
+	return _lemmas.size();
+}
+
+std::string DictionaryLemmatizer::name() const
+{
+	size_t contentHash = 0;
+	for (auto const& [word, lemma] : _lemmas)
+		contentHash += std::hash<std::string>()(word + ' ' + lemma);
+	return "dictionary-" + std::to_string(_lemmas.size()) + "-" + std::to_string(contentHash);
+}
+
+std::string DictionaryLemmatizer::lemmatizeWord(std::string_view word) const
+{
+	auto it = _lemmas.find(std::string(word));
+	return it != _lemmas.end() ? it->second : std::string(word);
+}
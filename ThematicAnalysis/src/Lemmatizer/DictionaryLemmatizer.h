@@ -0,0 +1,28 @@
+﻿#pragma once
+#include <unordered_map>
+
+#include "WordsLemmatizer.h"
+
+/**
+ * \brief lemmatizer with in-memory dictionary of word forms, unknown words are kept as they are
+ */
+class DictionaryLemmatizer : public WordsLemmatizer
+{
+public:
+	DictionaryLemmatizer() = default;
+	explicit DictionaryLemmatizer(std::unordered_map<std::string, std::string> lemmas);
+	// each line of the file is "word lemma" in cp1251, throw std::runtime_error when file can't be opened
+	static DictionaryLemmatizer loadFromFile(std::string const& filePath);
+	void saveToFile(std::string const& filePath) const;
+
+	void add(std::string word, std::string lemma);
+	size_t size() const;
+	// depends on the dictionary content
+	std::string name() const override;
+
+protected:
+	std::string lemmatizeWord(std::string_view word) const override;
+
+private:
+	std::unordered_map<std::string, std::string> _lemmas;
+};
@@ -0,0 +1,26 @@
+﻿#pragma once
+#include <string>
+#include <vector>
+
+/**
+ * \brief tokens of several text segments in one array, tokens of i-th segment are [offsets[i], offsets[i + 1])
+ */
+struct SegmentedTokens
+{
+	std::vector<std::string> tokens;
+	std::vector<size_t> offsets = { 0 };
+};
+
+/**
+ * \brief lemmatizer backend, the text is already cleared and lower-cased by TextNormalizer
+ */
+class ILemmatizer
+{
+public:
+	virtual std::vector<std::string> lemmatizeText(const std::string& text) const = 0;
+	// each line of the text is a segment, throw std::runtime_error when the text has more lines with words
+	virtual SegmentedTokens lemmatizeLines(const std::string& text, size_t segmentsCount) const = 0;
+	// identifies the backend and its settings, e.g. in keys of cached normalized articles
+	virtual std::string name() const = 0;
+	virtual ~ILemmatizer() = default;
+};
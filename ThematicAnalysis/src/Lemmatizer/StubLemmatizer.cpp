@@ -0,0 +1,37 @@
+﻿#include "StubLemmatizer.h"
+
+#include <array>
+
+const size_t StubLemmatizer::MIN_STEM_SIZE = 3;
+
+// common russian inflections, longer suffixes are first
+constexpr std::array<std::string_view, 40> SUFFIXES = {
+	"ями", "ами", "ого", "его", "ому", "ему", "ыми", "ими", "иях", "ией",
+	"ах", "ях", "ов", "ев", "ей", "ой", "ый", "ий", "ая", "яя", "ое", "ее", "ые", "ие", "ом", "ем", "ам", "ям", "ую", "юю",
+	"а", "я", "ы", "и", "е", "о", "у", "ю", "ь", "й",
+};
+
+StubLemmatizer::StubLemmatizer(Mode mode) : _mode(mode)
+{
+}
+
+std::string StubLemmatizer::name() const
+{
+	return _mode == Mode::Identity ? "stub-identity" : "stub-suffixes";
+}
+
+std::string StubLemmatizer::lemmatizeWord(std::string_view word) const
+{
+	if (_mode == Mode::SuffixStripping)
+	{
+		for (auto suffix : SUFFIXES)
+		{
+			if (word.size() >= MIN_STEM_SIZE + suffix.size() && word.substr(word.size() - suffix.size()) == suffix)
+			{
+				word.remove_suffix(suffix.size());
+				break;
+			}
+		}
+	}
+	return std::string(word);
+}
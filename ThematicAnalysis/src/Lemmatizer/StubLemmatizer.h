@@ -0,0 +1,26 @@
+﻿#pragma once
+#include "WordsLemmatizer.h"
+
+/**
+ * \brief deterministic lemmatizer without external dependencies for tests and benchmarks:
+ * words are kept as they are or their inflection suffixes are stripped
+ */
+class StubLemmatizer : public WordsLemmatizer
+{
+public:
+	enum class Mode
+	{
+		Identity,
+		SuffixStripping
+	};
+
+	explicit StubLemmatizer(Mode mode = Mode::Identity);
+	std::string name() const override;
+
+protected:
+	std::string lemmatizeWord(std::string_view word) const override;
+
+private:
+	static const size_t MIN_STEM_SIZE;
+	Mode _mode;
+};
@@ -0,0 +1,53 @@
+﻿#include "WordsLemmatizer.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "Utils/EncodingUtils.h"
+
+/**
+ * \brief words are sequences of letters and digits, numbers are skipped as mystem does
+ */
+void WordsLemmatizer::lemmatizeLine(std::string_view line, std::vector<std::string>& tokens) const
+{
+	auto it = line.begin();
+	while (it != line.end())
+	{
+		auto wordBegin = std::find_if(it, line.end(), EncodingUtils::isLetterOrDigit);
+		auto wordEnd = std::find_if_not(wordBegin, line.end(), EncodingUtils::isLetterOrDigit);
+		if (std::any_of(wordBegin, wordEnd, EncodingUtils::isLetter))
+		{
+			std::string word(wordBegin, wordEnd);
+			std::transform(word.begin(), word.end(), word.begin(), EncodingUtils::toLower);
+			auto lemma = lemmatizeWord(word);
+			if (!lemma.empty())
+				tokens.push_back(std::move(lemma));
+		}
+		it = wordEnd;
+	}
+}
+
+std::vector<std::string> WordsLemmatizer::lemmatizeText(const std::string& text) const
+{
+	std::vector<std::string> tokens;
+	lemmatizeLine(text, tokens);
+	return tokens;
+}
+
+SegmentedTokens WordsLemmatizer::lemmatizeLines(const std::string& text, size_t segmentsCount) const
+{
+	SegmentedTokens result;
+	result.offsets.reserve(segmentsCount + 1);
+	std::string_view rest = text;
+	while (result.offsets.size() <= segmentsCount && !rest.empty())
+	{
+		auto line = rest.substr(0, rest.find('\n'));
+		rest.remove_prefix(std::min(rest.size(), line.size() + 1));
+		lemmatizeLine(line, result.tokens);
+		result.offsets.push_back(result.tokens.size());
+	}
+	if (std::any_of(rest.begin(), rest.end(), EncodingUtils::isLetter))
+		throw std::runtime_error("text has more lines than segments");
+	result.offsets.resize(segmentsCount + 1, result.tokens.size());
+	return result;
+}
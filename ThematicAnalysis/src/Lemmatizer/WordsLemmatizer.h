@@ -0,0 +1,21 @@
+﻿#pragma once
+#include <string_view>
+
+#include "ILemmatizer.h"
+
+/**
+ * \brief base of local lemmatizers which handle words independently of their context
+ */
+class WordsLemmatizer : public ILemmatizer
+{
+public:
+	std::vector<std::string> lemmatizeText(const std::string& text) const override;
+	SegmentedTokens lemmatizeLines(const std::string& text, size_t segmentsCount) const override;
+
+protected:
+	// word is a lower-case sequence of letters and digits, empty lemma means the word is skipped
+	virtual std::string lemmatizeWord(std::string_view word) const = 0;
+
+private:
+	void lemmatizeLine(std::string_view line, std::vector<std::string>& tokens) const;
+};
@@ -0,0 +1,79 @@
+﻿#include "LinkedTermsStore.h"
+
+#include <cstdio>
+#include <stdexcept>
+
+#include "Utils/BinaryUtils.h"
+#include "Utils/FileUtils.h"
+
+LinkedTermsStore::LinkedTermsStore(size_t memoryBudget) : _memoryBudget(memoryBudget)
+{
+}
+
+LinkedTermsStore::~LinkedTermsStore()
+{
+	if (_spillFile.is_open())
+	{
+		_spillFile.close();
+		std::remove(_spillPath.c_str());
+	}
+}
+
+void LinkedTermsStore::add(uint32_t titleIndex, std::vector<TermCount> const& termsCounts)
+{
+	_records.push_back({ titleIndex, static_cast<uint32_t>(termsCounts.size()) });
+	_records.insert(_records.end(), termsCounts.begin(), termsCounts.end());
+	_count++;
+	if (_records.size() * sizeof(TermCount) > _memoryBudget)
+		spill();
+}
+
+/**
+ * \brief records in memory are appended to temporary file as one chunk
+ */
+void LinkedTermsStore::spill()
+{
+	if (!_spillFile.is_open())
+	{
+		_spillPath = FileUtils::getTemporaryPath(".links");
+		_spillFile.open(_spillPath, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+		if (!_spillFile.is_open())
+			throw std::runtime_error("Can't create temporary file " + _spillPath);
+	}
+	_spillFile.seekp(0, std::ios::end);
+	BinaryUtils::writeVector(_spillFile, _records);
+	if (!_spillFile)
+		throw std::runtime_error("Can't write temporary file " + _spillPath);
+	_spilledCount = _count;
+	_spilledChunksCount++;
+	_records.clear();
+	_records.shrink_to_fit();
+}
+
+void LinkedTermsStore::visitChunk(std::vector<TermCount> const& chunk, RecordVisitor const& onRecord)
+{
+	for (size_t i = 0; i < chunk.size(); i += chunk[i].count + 1)
+		onRecord(chunk[i].termIndex, chunk.data() + i + 1, chunk.data() + i + 1 + chunk[i].count);
+}
+
+void LinkedTermsStore::forEach(RecordVisitor const& onRecord) const
+{
+	if (_spilledChunksCount > 0)
+	{
+		_spillFile.flush();
+		_spillFile.seekg(0, std::ios::beg);
+		for (size_t i = 0; i < _spilledChunksCount; i++)
+			visitChunk(BinaryUtils::readVector<TermCount>(_spillFile), onRecord);
+	}
+	visitChunk(_records, onRecord);
+}
+
+size_t LinkedTermsStore::size() const
+{
+	return _count;
+}
+
+size_t LinkedTermsStore::spilledCount() const
+{
+	return _spilledCount;
+}
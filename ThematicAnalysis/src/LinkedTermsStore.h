@@ -0,0 +1,46 @@
+﻿#pragma once
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <vector>
+
+/**
+ * \brief counts of terms linked with the title of each article, terms are referred by 32-bit indexes.
+ * Records are spilled to a temporary binary file when their size exceeds the memory budget,
+ * and are visited in the order of adding by one spilled chunk at a time
+ */
+class LinkedTermsStore
+{
+public:
+	struct TermCount
+	{
+		uint32_t termIndex;
+		uint32_t count;
+	};
+	using RecordVisitor = std::function<void(uint32_t titleIndex, TermCount const* begin, TermCount const* end)>;
+
+	explicit LinkedTermsStore(size_t memoryBudget);
+	LinkedTermsStore(LinkedTermsStore const&) = delete;
+	LinkedTermsStore& operator=(LinkedTermsStore const&) = delete;
+	~LinkedTermsStore();
+
+	// throw std::runtime_error when temporary file can't be written
+	void add(uint32_t titleIndex, std::vector<TermCount> const& termsCounts);
+	void forEach(RecordVisitor const& onRecord) const;
+	size_t size() const;
+	size_t spilledCount() const;
+
+private:
+	void spill();
+	static void visitChunk(std::vector<TermCount> const& chunk, RecordVisitor const& onRecord);
+
+	size_t _memoryBudget;
+	size_t _count = 0;
+	size_t _spilledCount = 0;
+	size_t _spilledChunksCount = 0;
+	// each record is a header of the title index and the count of terms, then counts of the terms
+	std::vector<TermCount> _records;
+	std::string _spillPath;
+	mutable std::fstream _spillFile;
+};
@@ -0,0 +1,129 @@
+﻿#include "NodesOrdering.h"
+
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+
+const std::vector<NodesOrdering::Order> NodesOrdering::ORDERS = { Order::Hash, Order::BreadthFirst, Order::ReverseCuthillMcKee, Order::DegreeDescending };
+
+uint32_t NodesOrdering::Adjacency::getDegree(uint32_t node) const
+{
+	return offsets[node + 1] - offsets[node];
+}
+
+/**
+ * \brief outgoing and incoming links of each node
+ */
+NodesOrdering::Adjacency NodesOrdering::makeUndirected(std::vector<uint32_t> const& offsets, std::vector<uint32_t> const& targets)
+{
+	auto nodesCount = offsets.size() - 1;
+	Adjacency adjacency;
+	adjacency.offsets.assign(nodesCount + 1, 0);
+	for (uint32_t node = 0; node < nodesCount; node++)
+	{
+		adjacency.offsets[node + 1] += offsets[node + 1] - offsets[node];
+		for (auto link = offsets[node]; link < offsets[node + 1]; link++)
+			adjacency.offsets[targets[link] + 1]++;
+	}
+	std::partial_sum(adjacency.offsets.begin(), adjacency.offsets.end(), adjacency.offsets.begin());
+
+	adjacency.neighbors.resize(adjacency.offsets.back());
+	auto positions = adjacency.offsets;
+	for (uint32_t node = 0; node < nodesCount; node++)
+		for (auto link = offsets[node]; link < offsets[node + 1]; link++)
+		{
+			adjacency.neighbors[positions[node]++] = targets[link];
+			adjacency.neighbors[positions[targets[link]]++] = node;
+		}
+	return adjacency;
+}
+
+/**
+ * \brief breadth-first search of each component from its first node in starts
+ * \param isByDegree new neighbors of a node are visited in the order of their degrees
+ */
+std::vector<uint32_t> NodesOrdering::traverse(Adjacency const& adjacency, std::vector<uint32_t> const& starts, bool isByDegree)
+{
+	std::vector<bool> isVisited(starts.size());
+	std::vector<uint32_t> order;
+	order.reserve(starts.size());
+	auto isLess = [&adjacency](uint32_t first, uint32_t second)
+	{
+		return adjacency.getDegree(first) < adjacency.getDegree(second) || (adjacency.getDegree(first) == adjacency.getDegree(second) && first < second);
+	};
+	for (auto start : starts)
+	{
+		if (isVisited[start])
+			continue;
+		isVisited[start] = true;
+		order.push_back(start);
+		// the order is the queue
+		for (auto head = order.size() - 1; head < order.size(); head++)
+		{
+			auto node = order[head];
+			auto firstNew = order.size();
+			for (auto i = adjacency.offsets[node]; i < adjacency.offsets[node + 1]; i++)
+			{
+				auto neighbor = adjacency.neighbors[i];
+				if (!isVisited[neighbor])
+				{
+					isVisited[neighbor] = true;
+					order.push_back(neighbor);
+				}
+			}
+			if (isByDegree)
+				std::sort(order.begin() + static_cast<ptrdiff_t>(firstNew), order.end(), isLess);
+		}
+	}
+	return order;
+}
+
+std::vector<uint32_t> NodesOrdering::calculate(Order order, std::vector<uint32_t> const& offsets, std::vector<uint32_t> const& targets)
+{
+	std::vector<uint32_t> nodes(offsets.size() - 1);
+	std::iota(nodes.begin(), nodes.end(), 0);
+	if (order == Order::Hash)
+		return nodes;
+
+	auto adjacency = makeUndirected(offsets, targets);
+	auto isHeavier = [&adjacency](uint32_t first, uint32_t second) {return adjacency.getDegree(first) > adjacency.getDegree(second); };
+	auto isLighter = [&adjacency](uint32_t first, uint32_t second) {return adjacency.getDegree(first) < adjacency.getDegree(second); };
+	switch (order)
+	{
+	case Order::BreadthFirst:
+		std::stable_sort(nodes.begin(), nodes.end(), isHeavier);
+		return traverse(adjacency, nodes, false);
+	case Order::ReverseCuthillMcKee:
+	{
+		std::stable_sort(nodes.begin(), nodes.end(), isLighter);
+		auto cuthillMcKee = traverse(adjacency, nodes, true);
+		std::reverse(cuthillMcKee.begin(), cuthillMcKee.end());
+		return cuthillMcKee;
+	}
+	case Order::DegreeDescending:
+		std::stable_sort(nodes.begin(), nodes.end(), isHeavier);
+		return nodes;
+	default:
+		throw std::invalid_argument("Unknown nodes order");
+	}
+}
+
+std::string NodesOrdering::getName(Order order)
+{
+	switch (order)
+	{
+	case Order::Hash: return "hash";
+	case Order::BreadthFirst: return "bfs";
+	case Order::ReverseCuthillMcKee: return "rcm";
+	case Order::DegreeDescending: return "degree";
+	default: throw std::invalid_argument("Unknown nodes order");
+	}
+}
+
+NodesOrdering::Order NodesOrdering::parse(std::string const& name)
+{
+	for (auto order : ORDERS)
+		if (getName(order) == name)
+			return order;
+	throw std::invalid_argument("Unknown nodes order " + name);
+}
@@ -0,0 +1,39 @@
+﻿#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * \brief orders of graph nodes which place linked nodes close to each other, so traversals touch less memory.
+ * Links are given in compressed sparse rows: links of node i are targets[offsets[i]..offsets[i + 1])
+ */
+class NodesOrdering
+{
+public:
+	enum class Order
+	{
+		Hash,	// the order of term hashes, as in SemanticGraph
+		BreadthFirst,	// breadth-first search from the hubs, links are followed in both directions
+		ReverseCuthillMcKee,	// breadth-first search from low degree nodes, neighbors by degree, reversed
+		DegreeDescending	// hubs first
+	};
+
+	// order[newIndex] == old index
+	static std::vector<uint32_t> calculate(Order order, std::vector<uint32_t> const& offsets, std::vector<uint32_t> const& targets);
+
+	static std::string getName(Order order);
+	// throw std::invalid_argument for unknown names
+	static Order parse(std::string const& name);
+	static const std::vector<Order> ORDERS;
+
+private:
+	struct Adjacency
+	{
+		std::vector<uint32_t> offsets;
+		std::vector<uint32_t> neighbors;
+		uint32_t getDegree(uint32_t node) const;
+	};
+
+	static Adjacency makeUndirected(std::vector<uint32_t> const& offsets, std::vector<uint32_t> const& targets);
+	static std::vector<uint32_t> traverse(Adjacency const& adjacency, std::vector<uint32_t> const& starts, bool isByDegree);
+};
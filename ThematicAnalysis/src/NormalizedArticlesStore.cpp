@@ -0,0 +1,134 @@
+﻿#include "NormalizedArticlesStore.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <stdexcept>
+
+#include "Utils/FileUtils.h"
+
+const size_t NormalizedArticlesStore::DEFAULT_MEMORY_BUDGET = 512ull * 1024 * 1024;
+
+NormalizedArticlesStore::NormalizedArticlesStore(size_t memoryBudget) : _memoryBudget(memoryBudget)
+{
+}
+
+NormalizedArticlesStore::~NormalizedArticlesStore()
+{
+	if (_spillFile.is_open())
+	{
+		_spillFile.close();
+		std::remove(_spillPath.c_str());
+	}
+}
+
+size_t NormalizedArticlesStore::estimateSize(NormalizedArticle const& article)
+{
+	auto size = sizeof(NormalizedArticle) + article.titleView.size();
+	for (auto const& words : { &article.titleWords, &article.text })
+		for (auto const& word : *words)
+			size += sizeof(std::string) + word.size();
+	return size;
+}
+
+void NormalizedArticlesStore::add(NormalizedArticle article)
+{
+	_memorySize += estimateSize(article);
+	_articles.push_back(std::move(article));
+	if (_memorySize > _memoryBudget)
+		spill();
+}
+
+void writeString(std::ostream& out, std::string const& str)
+{
+	auto size = static_cast<uint64_t>(str.size());
+	out.write(reinterpret_cast<char const*>(&size), sizeof(size));
+	out.write(str.data(), static_cast<std::streamsize>(str.size()));
+}
+
+void writeWords(std::ostream& out, std::vector<std::string> const& words)
+{
+	auto count = static_cast<uint64_t>(words.size());
+	out.write(reinterpret_cast<char const*>(&count), sizeof(count));
+	for (auto const& word : words)
+		writeString(out, word);
+}
+
+void readString(std::istream& in, std::string& str)
+{
+	uint64_t size;
+	in.read(reinterpret_cast<char*>(&size), sizeof(size));
+	str.resize(static_cast<size_t>(size));
+	in.read(str.data(), static_cast<std::streamsize>(size));
+}
+
+void readWords(std::istream& in, std::vector<std::string>& words)
+{
+	uint64_t count;
+	in.read(reinterpret_cast<char*>(&count), sizeof(count));
+	words.resize(static_cast<size_t>(count));
+	for (auto& word : words)
+		readString(in, word);
+}
+
+/**
+ * \brief move all articles from memory to the end of temporary file
+ */
+void NormalizedArticlesStore::spill()
+{
+	if (!_spillFile.is_open())
+	{
+		_spillPath = FileUtils::getTemporaryPath(".articles");
+		_spillFile.open(_spillPath, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+		if (!_spillFile.is_open())
+			throw std::runtime_error("Can't create temporary file " + _spillPath);
+	}
+	_spillFile.seekp(0, std::ios::end);
+	for (auto const& article : _articles)
+	{
+		writeWords(_spillFile, article.titleWords);
+		writeString(_spillFile, article.titleView);
+		writeWords(_spillFile, article.text);
+	}
+	if (!_spillFile)
+		throw std::runtime_error("Can't write temporary file " + _spillPath);
+	_spilledCount += _articles.size();
+	_articles.clear();
+	_articles.shrink_to_fit();
+	_memorySize = 0;
+}
+
+void NormalizedArticlesStore::forEach(std::function<void(NormalizedArticle const&)> const& onArticle) const
+{
+	if (_spilledCount > 0)
+	{
+		_spillFile.flush();
+		_spillFile.seekg(0, std::ios::beg);
+		NormalizedArticle article({}, "", {});
+		for (size_t i = 0; i < _spilledCount; i++)
+		{
+			readWords(_spillFile, article.titleWords);
+			readString(_spillFile, article.titleView);
+			readWords(_spillFile, article.text);
+			if (!_spillFile)
+				throw std::runtime_error("Can't read temporary file " + _spillPath);
+			onArticle(article);
+		}
+	}
+	for (auto const& article : _articles)
+		onArticle(article);
+}
+
+size_t NormalizedArticlesStore::size() const
+{
+	return _spilledCount + _articles.size();
+}
+
+size_t NormalizedArticlesStore::spilledCount() const
+{
+	return _spilledCount;
+}
+
+size_t NormalizedArticlesStore::memorySize() const
+{
+	return _memorySize;
+}
@@ -0,0 +1,41 @@
+﻿#pragma once
+#include <fstream>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "NormalizedArticle.h"
+
+/**
+ * \brief sequential storage of normalized articles, which are spilled to a temporary binary file
+ * when their size exceeds the memory budget. Articles are visited in the order of adding
+ */
+class NormalizedArticlesStore
+{
+public:
+	static const size_t DEFAULT_MEMORY_BUDGET;
+
+	// throw std::runtime_error when temporary file can't be created
+	explicit NormalizedArticlesStore(size_t memoryBudget = DEFAULT_MEMORY_BUDGET);
+	NormalizedArticlesStore(NormalizedArticlesStore const&) = delete;
+	NormalizedArticlesStore& operator=(NormalizedArticlesStore const&) = delete;
+	~NormalizedArticlesStore();
+
+	void add(NormalizedArticle article);
+	void forEach(std::function<void(NormalizedArticle const&)> const& onArticle) const;
+	size_t size() const;
+	size_t spilledCount() const;
+	// estimated size of the articles kept in memory, it doesn't exceed the memory budget
+	size_t memorySize() const;
+
+private:
+	void spill();
+	static size_t estimateSize(NormalizedArticle const& article);
+
+	size_t _memoryBudget;
+	size_t _memorySize = 0;
+	size_t _spilledCount = 0;
+	std::vector<NormalizedArticle> _articles;
+	std::string _spillPath;
+	mutable std::fstream _spillFile;
+};
@@ -0,0 +1,236 @@
+﻿#include "NormalizedCorpusCache.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+#include "Utils/MappedFile.h"
+
+const uint32_t NormalizedCorpusCache::FORMAT_VERSION = 1;
+
+constexpr char MAGIC[4] = { 'T', 'A', 'N', 'C' };
+constexpr uint64_t FNV_OFFSET_BASIS = 14695981039346656037ull;
+constexpr uint64_t FNV_PRIME = 1099511628211ull;
+
+uint64_t calcFNV1a(std::string_view data, uint64_t hash)
+{
+	for (auto c : data)
+	{
+		hash ^= static_cast<unsigned char>(c);
+		hash *= FNV_PRIME;
+	}
+	return hash;
+}
+
+uint64_t NormalizedCorpusCache::calcKey(std::string_view corpusText, std::string_view salt)
+{
+	return calcFNV1a(corpusText, calcFNV1a(salt, FNV_OFFSET_BASIS));
+}
+
+std::string NormalizedCorpusCache::getFilePath(std::string const& cacheDirectory, uint64_t key)
+{
+	std::ostringstream name;
+	name << std::hex << std::setw(16) << std::setfill('0') << key << ".normalized";
+	return (std::filesystem::path(cacheDirectory) / name.str()).string();
+}
+
+void NormalizedCorpusCache::addLemmas(std::vector<std::string> const& words)
+{
+	for (auto const& word : words)
+	{
+		auto [it, isInserted] = _lemmasIds.try_emplace(word, static_cast<uint32_t>(_lemmas.size()));
+		if (isInserted)
+			_lemmas.push_back(word);
+		_tokens.push_back(it->second);
+	}
+	_offsets.push_back(_tokens.size());
+}
+
+void NormalizedCorpusCache::add(NormalizedArticle const& article)
+{
+	_titlesViews.push_back(article.titleView);
+	addLemmas(article.titleWords);
+	addLemmas(article.text);
+}
+
+void NormalizedCorpusCache::forEach(std::function<void(NormalizedArticle const&)> const& onArticle) const
+{
+	NormalizedArticle article({}, "", {});
+	auto setWords = [this](std::vector<std::string>& words, size_t segment)
+	{
+		words.resize(_offsets[segment + 1] - _offsets[segment]);
+		std::transform(_tokens.begin() + _offsets[segment], _tokens.begin() + _offsets[segment + 1], words.begin(),
+			[this](uint32_t id) -> std::string const& {return _lemmas[id]; });
+	};
+	for (size_t i = 0; i < _titlesViews.size(); i++)
+	{
+		article.titleView = _titlesViews[i];
+		setWords(article.titleWords, 2 * i);
+		setWords(article.text, 2 * i + 1);
+		onArticle(article);
+	}
+}
+
+size_t NormalizedCorpusCache::size() const
+{
+	return _titlesViews.size();
+}
+
+size_t NormalizedCorpusCache::lemmasCount() const
+{
+	return _lemmas.size();
+}
+
+template<typename T>
+void writeValue(std::ostream& out, T value)
+{
+	out.write(reinterpret_cast<char const*>(&value), sizeof(value));
+}
+
+void writeStrings(std::ostream& out, std::vector<std::string> const& strings)
+{
+	writeValue(out, static_cast<uint64_t>(strings.size()));
+	for (auto const& str : strings)
+	{
+		writeValue(out, static_cast<uint32_t>(str.size()));
+		out.write(str.data(), static_cast<std::streamsize>(str.size()));
+	}
+}
+
+/**
+ * \brief file is: magic, version, key, lemmas, titles views, offsets and tokens ids.
+ * It's written to a temporary file which replaces the file when it's complete, so a failed write doesn't leave a file with the key
+ */
+void NormalizedCorpusCache::save(std::string const& filePath, uint64_t key) const
+{
+	auto temporaryPath = filePath + ".tmp";
+	{
+		std::ofstream fout(temporaryPath, std::ios::binary | std::ios::trunc);
+		if (!fout.is_open())
+			throw std::runtime_error("Can't create file " + temporaryPath);
+		fout.write(MAGIC, sizeof(MAGIC));
+		writeValue(fout, FORMAT_VERSION);
+		writeValue(fout, key);
+		writeStrings(fout, _lemmas);
+		writeStrings(fout, _titlesViews);
+		writeValue(fout, static_cast<uint64_t>(_offsets.size()));
+		for (auto offset : _offsets)
+			writeValue(fout, static_cast<uint64_t>(offset));
+		fout.write(reinterpret_cast<char const*>(_tokens.data()), static_cast<std::streamsize>(_tokens.size() * sizeof(uint32_t)));
+		fout.close();
+		if (!fout)
+		{
+			std::filesystem::remove(temporaryPath);
+			throw std::runtime_error("Can't write file " + temporaryPath);
+		}
+	}
+	std::filesystem::rename(temporaryPath, filePath);
+}
+
+/**
+ * \brief reader of the mapped file which checks bounds
+ */
+class CacheReader
+{
+public:
+	CacheReader(std::string_view data, std::string const& filePath) : _rest(data), _filePath(filePath)
+	{
+	}
+
+	template<typename T>
+	T read()
+	{
+		T value;
+		std::memcpy(&value, take(sizeof(T)).data(), sizeof(T));
+		return value;
+	}
+
+	std::string_view take(size_t size)
+	{
+		if (_rest.size() < size)
+			throw std::runtime_error("Damaged cache file " + _filePath);
+		auto data = _rest.substr(0, size);
+		_rest.remove_prefix(size);
+		return data;
+	}
+
+	// a count of elements of elementSize bytes, a broken count isn't allocated
+	size_t readCount(size_t elementSize)
+	{
+		auto count = read<uint64_t>();
+		checkCount(count, elementSize);
+		return static_cast<size_t>(count);
+	}
+
+	void checkCount(uint64_t count, size_t elementSize) const
+	{
+		if (_rest.size() / elementSize < count)
+			throw std::runtime_error("Damaged cache file " + _filePath);
+	}
+
+	void readStrings(std::vector<std::string>& strings)
+	{
+		// each string has at least its size
+		strings.resize(readCount(sizeof(uint32_t)));
+		for (auto& str : strings)
+			str = take(read<uint32_t>());
+	}
+
+	bool isEnd() const
+	{
+		return _rest.empty();
+	}
+
+private:
+	std::string_view _rest;
+	std::string const& _filePath;
+};
+
+bool NormalizedCorpusCache::load(std::string const& filePath, uint64_t key)
+{
+	if (!std::filesystem::exists(filePath))
+		return false;
+	MappedFile file(filePath);
+	CacheReader reader(file.view(), filePath);
+	if (file.size() < sizeof(MAGIC) + sizeof(FORMAT_VERSION) + sizeof(key) || std::memcmp(reader.take(sizeof(MAGIC)).data(), MAGIC, sizeof(MAGIC)) != 0
+		|| reader.read<uint32_t>() != FORMAT_VERSION || reader.read<uint64_t>() != key)
+		return false;
+
+	clear();
+	try
+	{
+		reader.readStrings(_lemmas);
+		reader.readStrings(_titlesViews);
+		_offsets.resize(reader.readCount(sizeof(uint64_t)));
+		for (auto& offset : _offsets)
+			offset = static_cast<size_t>(reader.read<uint64_t>());
+		if (_offsets.size() != 2 * _titlesViews.size() + 1 || _offsets.front() != 0 || !std::is_sorted(_offsets.begin(), _offsets.end()))
+			throw std::runtime_error("Damaged cache file " + filePath);
+		reader.checkCount(_offsets.back(), sizeof(uint32_t));
+		_tokens.resize(_offsets.back());
+		std::memcpy(_tokens.data(), reader.take(_tokens.size() * sizeof(uint32_t)).data(), _tokens.size() * sizeof(uint32_t));
+		if (!reader.isEnd() || std::any_of(_tokens.begin(), _tokens.end(), [this](uint32_t id) {return id >= _lemmas.size(); }))
+			throw std::runtime_error("Damaged cache file " + filePath);
+	}
+	catch (...)
+	{
+		clear();
+		throw;
+	}
+	for (size_t i = 0; i < _lemmas.size(); i++)
+		_lemmasIds.emplace(_lemmas[i], static_cast<uint32_t>(i));
+	return true;
+}
+
+void NormalizedCorpusCache::clear()
+{
+	_lemmas.clear();
+	_lemmasIds.clear();
+	_titlesViews.clear();
+	_tokens.clear();
+	_offsets = { 0 };
+}
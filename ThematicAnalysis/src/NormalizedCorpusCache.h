@@ -0,0 +1,46 @@
+﻿#pragma once
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "NormalizedArticle.h"
+
+/**
+ * \brief normalized articles with interned lemmas: each article keeps its title view and ids of its lemmas.
+ * It is saved to a binary file with the key of the source corpus, so the corpus is lemmatized only once
+ */
+class NormalizedCorpusCache
+{
+public:
+	// FNV-1a hash of the salt (e.g. names of the reader and the lemmatizer) and the corpus text
+	static uint64_t calcKey(std::string_view corpusText, std::string_view salt = {});
+	static std::string getFilePath(std::string const& cacheDirectory, uint64_t key);
+
+	void add(NormalizedArticle const& article);
+	void forEach(std::function<void(NormalizedArticle const&)> const& onArticle) const;
+	size_t size() const;
+	size_t lemmasCount() const;
+
+	// the file is replaced only when it's written completely
+	// throw std::runtime_error when file can't be written
+	void save(std::string const& filePath, uint64_t key) const;
+	// return false when there is no file or it has other key or format version,
+	// throw std::runtime_error when file is damaged
+	bool load(std::string const& filePath, uint64_t key);
+
+private:
+	static const uint32_t FORMAT_VERSION;
+
+	void addLemmas(std::vector<std::string> const& words);
+	void clear();
+
+	std::vector<std::string> _lemmas;
+	std::unordered_map<std::string, uint32_t> _lemmasIds;
+	std::vector<std::string> _titlesViews;
+	// lemmas ids of all articles, title of i-th article is [offsets[2i], offsets[2i + 1]), text is [offsets[2i + 1], offsets[2i + 2])
+	std::vector<uint32_t> _tokens;
+	std::vector<size_t> _offsets = { 0 };
+};
@@ -0,0 +1,29 @@
+﻿#include "PipelineMetrics.h"
+
+#include <algorithm>
+
+double StageMetrics::articlesPerSecond() const
+{
+	return busySeconds > 0 ? static_cast<double>(articlesCount) / busySeconds : 0.;
+}
+
+StageMetrics const* PipelineMetrics::findBottleneck() const
+{
+	auto it = std::max_element(stages.begin(), stages.end(), [](StageMetrics const& a, StageMetrics const& b) {return a.busySeconds < b.busySeconds; });
+	return it == stages.end() ? nullptr : &*it;
+}
+
+void PipelineMetrics::exportToJson(std::ostream& out) const
+{
+	out << "{\n  \"seconds\": " << seconds << ",\n  \"stages\": [";
+	for (size_t i = 0; i < stages.size(); i++)
+	{
+		auto const& stage = stages[i];
+		out << (i == 0 ? "\n    " : ",\n    ") << "{\"name\": \"" << stage.name << "\", \"batches\": " << stage.batchesCount
+			<< ", \"articles\": " << stage.articlesCount << ", \"busySeconds\": " << stage.busySeconds
+			<< ", \"inputWaitingSeconds\": " << stage.inputWaitingSeconds << ", \"outputWaitingSeconds\": " << stage.outputWaitingSeconds
+			<< ", \"articlesPerSecond\": " << stage.articlesPerSecond()
+			<< ", \"maxQueueDepth\": " << stage.maxQueueDepth << ", \"averageQueueDepth\": " << stage.averageQueueDepth << '}';
+	}
+	out << (stages.empty() ? "]\n}\n" : "\n  ]\n}\n");
+}
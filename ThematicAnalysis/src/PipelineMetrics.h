@@ -0,0 +1,32 @@
+﻿#pragma once
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * \brief work of one pipeline stage, waiting is for input items or for place in the output queue
+ */
+struct StageMetrics
+{
+	std::string name;
+	size_t batchesCount = 0;
+	size_t articlesCount = 0;
+	double busySeconds = 0;
+	double inputWaitingSeconds = 0;
+	double outputWaitingSeconds = 0;
+	// depth of the input queue after each push
+	size_t maxQueueDepth = 0;
+	double averageQueueDepth = 0;
+
+	double articlesPerSecond() const;
+};
+
+struct PipelineMetrics
+{
+	std::vector<StageMetrics> stages;
+	double seconds = 0;
+
+	// the busiest stage, nullptr when there are no stages
+	StageMetrics const* findBottleneck() const;
+	void exportToJson(std::ostream& out) const;
+};
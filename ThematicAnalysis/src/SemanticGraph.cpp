@@ -1,16 +1,19 @@
-﻿#include <execution>
-#include <sstream>
+﻿#include <sstream>
 #include <fstream>
 #include <numeric>
 #include "UGraphviz/UGraphviz.hpp"
 #include "SemanticGraph.h"
 #include "Utils/FileUtils.h"
+#include "Utils/MappedFile.h"
+#include "Utils/MemoryStreamBuf.h"
+#include "Utils/Profiler.h"
 #include "Hasher.h"
 #include "Utils/StringUtils.h"
 
-Node::Node(Term term) :
-	term(term),
-	weight(0)
+Node::Node(Term term, allocator_type allocator) :
+	term(std::move(term)),
+	weight(0),
+	neighbors(allocator)
 {
 }
 
@@ -18,6 +21,33 @@ Node::Node() : weight(0)
 {
 }
 
+Node::Node(allocator_type allocator) : weight(0), neighbors(allocator)
+{
+}
+
+Node::Node(Node const& node, allocator_type allocator) :
+	term(node.term),
+	weight(node.weight),
+	neighbors(node.neighbors, allocator),
+	isSumLinksWeightsChanged(node.isSumLinksWeightsChanged),
+	sumLinksWeights(node.sumLinksWeights)
+{
+}
+
+// links of a graph node are copied out of the graph pool, so the node may outlive the graph
+Node::Node(Node&& node) : Node(std::move(node), allocator_type())
+{
+}
+
+Node::Node(Node&& node, allocator_type allocator) :
+	term(std::move(node.term)),
+	weight(node.weight),
+	neighbors(std::move(node.neighbors), allocator),
+	isSumLinksWeightsChanged(node.isSumLinksWeightsChanged),
+	sumLinksWeights(node.sumLinksWeights)
+{
+}
+
 double Node::sumLinksWeight() const
 {
 	//if (isSumLinksWeightsChanged) {
@@ -46,13 +76,35 @@ size_t SemanticGraph::getNForNgram() const
 	return _nForNgram;
 }
 
-SemanticGraph::SemanticGraph(size_t nForNgrams) : _nForNgram(nForNgrams)
+size_t SemanticGraph::getArticlesCount() const
+{
+	return _articlesCount != 0 ? _articlesCount : nodes.size() + 1;
+}
+
+bool SemanticGraph::hasArticlesCount() const
+{
+	return _articlesCount != 0;
+}
+
+void SemanticGraph::setArticlesCount(size_t articlesCount)
+{
+	_articlesCount = articlesCount;
+}
+
+SemanticGraph::SemanticGraph(size_t nForNgrams) : nodes(NodesAllocator::createPool()), _nForNgram(nForNgrams)
+{
+}
+
+SemanticGraph::SemanticGraph(SemanticGraph const& graph) :
+	nodes(graph.nodes, NodesAllocator::createPool()),
+	_nForNgram(graph._nForNgram),
+	_articlesCount(graph._articlesCount)
 {
 }
 
 void SemanticGraph::addTerm(Term const& term)
 {
-	nodes.emplace(term.getHashCode(), Node(term));
+	nodes.try_emplace(term.getHashCode(), term);
 }
 
 void SemanticGraph::createLink(size_t firstTermHash, size_t secondTermHash, double weight)
@@ -91,6 +143,11 @@ bool SemanticGraph::isLinkExist(size_t firstTermHash, size_t secondTermHash) con
 	return ptr != nodes.end() && ptr->second.neighbors.find(secondTermHash) != ptr->second.neighbors.end();
 }
 
+size_t SemanticGraph::getLinksCount() const
+{
+	return std::accumulate(nodes.begin(), nodes.end(), 0ull, [](size_t count, auto const& pair) {return count + pair.second.neighbors.size(); });
+}
+
 
 /**
  * \brief Extract subGraph
@@ -100,7 +157,9 @@ bool SemanticGraph::isLinkExist(size_t firstTermHash, size_t secondTermHash) con
  */
 SemanticGraph SemanticGraph::getNeighborhood(size_t centerHash, unsigned radius, double minWeight) const
 {
+	PROFILE_SCOPE("SemanticGraph::getNeighborhood");
 	auto neighbors = SemanticGraph();
+	neighbors._articlesCount = getArticlesCount();
 	buildNeighborhood(centerHash, radius, minWeight, neighbors);
 	return neighbors;
 }
@@ -194,6 +253,7 @@ std::string SemanticGraph::getDotView(size_t centerHash) const
 /// <edges count>
 ///	<first term index> <second term index> <weight>
 ///	...
+/// <articles count>, older files end before it
 void SemanticGraph::exportToFile(std::string const& filePath)
 {
 	std::ofstream fout(filePath);
@@ -216,22 +276,22 @@ void SemanticGraph::exportToStream(std::ostream& out)
 		indexes[hash] = index++;
 	}
 
-	auto edgesCount = std::transform_reduce(std::execution::par, nodes.begin(), nodes.end(), 0ull,
-		[](size_t cnt, size_t cnt2) {return cnt + cnt2; },
-		[](auto const& pair) {return pair.second.neighbors.size(); });
-
-	out << edgesCount << std::endl;
+	out << getLinksCount() << std::endl;
 	for (auto&& [hash, node] : nodes)
 		for (auto&& [neighborHash, link] : node.neighbors)
 			out << indexes[hash] << ' ' << indexes[neighborHash] << ' ' << link.weight << std::endl;
+	out << getArticlesCount() << std::endl;
 }
 
+/**
+ * \brief the file is mapped into memory and parsed in place
+ */
 void SemanticGraph::importFromFile(std::string const& filePath)
 {
-	std::ifstream fin(filePath);
-	std::stringstream ss(FileUtils::readAllFile(fin));
-	importFromStream(ss);
-	fin.close();
+	MappedFile file(filePath);
+	MemoryStreamBuf buffer(file.view());
+	std::istream in(&buffer);
+	importFromStream(in);
 }
 
 Term readTerm(std::istream& in)
@@ -241,6 +301,8 @@ Term readTerm(std::istream& in)
 	size_t wordsCount, numberOfArticlesThatUseIt;
 	std::ws(in);
 	std::getline(in, view);
+	// files written in text mode on Windows
+	if (!view.empty() && view.back() == '\r') view.pop_back();
 	in >> weight >> numberOfArticlesThatUseIt >> wordsCount;
 	std::vector<std::string> words(wordsCount);
 	for (size_t i = 0; i < wordsCount; i++)
@@ -253,14 +315,15 @@ Term readTerm(std::istream& in)
 
 void SemanticGraph::importFromStream(std::istream& in)
 {
+	PROFILE_SCOPE("SemanticGraph::importFromStream");
 	int termsCount, linksCount;
 	in >> termsCount;
-	std::vector<Term> terms;
-	terms.reserve(termsCount);
+	std::vector<size_t> termsHashes;
+	termsHashes.reserve(termsCount);
 	for (int i = 0; i < termsCount; i++) {
 		auto term = readTerm(in);
-		terms.push_back(term);
-		addTerm(term);
+		termsHashes.push_back(term.getHashCode());
+		nodes.try_emplace(term.getHashCode(), std::move(term));
 	}
 	in >> linksCount;
 	while (linksCount--) {
@@ -268,8 +331,11 @@ void SemanticGraph::importFromStream(std::istream& in)
 		double weight;
 		in >> firstTermIndex >> secondTermIndex >> weight;
 
-		createLink(terms[firstTermIndex].getHashCode(), terms[secondTermIndex].getHashCode(), weight);
+		createLink(termsHashes[firstTermIndex], termsHashes[secondTermIndex], weight);
 	}
+	// older files end before the articles count, the end isn't read as a failure
+	if (in.good() && !(in >> std::ws).eof())
+		in >> _articlesCount;
 }
 
 void drawDotToImage(std::string const& dotView, std::string const& dirPath, std::string const& imageName)
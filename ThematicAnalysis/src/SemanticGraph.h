@@ -1,18 +1,33 @@
 ﻿#pragma once
+#include <cstddef>
 #include <map>
+#include <memory_resource>
 #include "Term.h"
+#include "Utils/PoolAllocator.h"
 
 class Link;
 
+/**
+ * \brief links are allocated by the allocator, nodes of a graph get the graph pool.
+ * Copied and moved nodes allocate from the default resource unless they are given an allocator
+ */
 class Node
 {
 public:
-	Node(Term term);
+	using allocator_type = std::pmr::polymorphic_allocator<std::byte>;
+
+	Node(Term term, allocator_type allocator = {});
 	Node();
+	explicit Node(allocator_type allocator);
 	Node(Node const& node) = default;
+	Node(Node const& node, allocator_type allocator);
+	Node(Node&& node);
+	Node(Node&& node, allocator_type allocator);
+	Node& operator=(Node const& node) = default;
+	Node& operator=(Node&& node) = default;
 	Term term;
 	double weight;
-	std::map<size_t, Link> neighbors;
+	std::pmr::map<size_t, Link> neighbors;
 	double sumLinksWeight() const;
 
 	mutable bool isSumLinksWeightsChanged = true;
@@ -31,24 +46,39 @@ public:
 
 namespace Ubpa::UGraphviz { class Graph; }
 
+/**
+ * \brief nodes and their links are allocated from the graph pool, so loading and destruction of a graph don't go
+ * through the heap for each link. Copies get their own pool, moves take the pool along
+ */
 class SemanticGraph
 {
 public:
-	std::map<size_t, Node> nodes;
+	using NodesAllocator = PoolAllocator<std::pair<size_t const, Node>>;
+	std::map<size_t, Node, std::less<size_t>, NodesAllocator> nodes;
 	size_t getNForNgram() const;
+	// articles of the corpus the graph is built from, nodes count + 1 when it is unknown (files without it)
+	size_t getArticlesCount() const;
+	bool hasArticlesCount() const;
+	void setArticlesCount(size_t articlesCount);
 	SemanticGraph(size_t nForNgrams = 4);
+	SemanticGraph(SemanticGraph const& graph);
+	SemanticGraph(SemanticGraph&& graph) = default;
+	SemanticGraph& operator=(SemanticGraph const& graph) = default;
+	SemanticGraph& operator=(SemanticGraph&& graph) = default;
 	void addTerm(Term const& term);
 	void createLink(size_t firstTermHash, size_t secondTermHash, double weight = 0);
 	void addTermWeight(size_t termHash, double weight);
 	double getLinkWeight(size_t firstTermHash, size_t secondTermHash) const;
 	bool isTermExist(size_t termHash) const;
 	bool isLinkExist(size_t firstTermHash, size_t secondTermHash) const;
+	size_t getLinksCount() const;
 	SemanticGraph getNeighborhood(size_t centerHash, unsigned radius, double minWeight = 0) const;
 	std::string getDotView() const;
 	std::string getDotView(size_t centerHash) const;
 
 	void exportToFile(std::string const& filePath);
 	void exportToStream(std::ostream& out);
+	// throw std::runtime_error when file can't be opened
 	void importFromFile(std::string const& filePath);
 	void importFromStream(std::istream& in);
 	void drawToImage(std::string const& dirPath, std::string const& imageName) const;
@@ -56,6 +86,8 @@ public:
 
 private:
 	size_t _nForNgram = 4;
+	// 0 when unknown
+	size_t _articlesCount = 0;
 	void buildNeighborhood(size_t curHash, unsigned radius, double minWeight, SemanticGraph& current) const;
 	Ubpa::UGraphviz::Graph createDotView(std::map<size_t, size_t>& registredNodes) const;
 };
\ No newline at end of file
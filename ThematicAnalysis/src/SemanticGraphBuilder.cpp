@@ -1,118 +1,323 @@
 ﻿#include "SemanticGraphBuilder.h"
-#include <execution>
-#include <set>
+#include <algorithm>
+#include <filesystem>
 #include <iterator>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <typeinfo>
 
 #include "ArticlesNormalizer.h"
 #include "Hasher.h"
 #include "Utils/TermsUtils.h"
 #include "ArticlesReader/XmlArticlesReader.h"
+#include "Utils/MappedFile.h"
+#include "Utils/Profiler.h"
+#include "Utils/ThreadPool.h"
 
 constexpr double SemanticGraphBuilder::WEIGHT_ADDITION = 1.0;
+const size_t SemanticGraphBuilder::ARTICLES_BATCH_SIZE = 256;
 
-void SemanticGraphBuilder::addAllTermsToGraph(std::vector<NormalizedArticle> const& articles)
+SemanticGraphBuilder::SemanticGraphBuilder(std::shared_ptr<ILemmatizer const> lemmatizer) : _normalizer(std::move(lemmatizer))
 {
-	for (auto&& article : articles)
-		_graph.addTerm(Term(article.titleWords, article.titleView, Hasher::sortAndCalcHash(article.titleWords)));
 }
 
-std::vector<NormalizedArticle> concatArticlesWithSameName(std::vector<NormalizedArticle> const& articles)
+void SemanticGraphBuilder::addTitleTerm(NormalizedArticle const& article)
 {
-	std::map<size_t, std::vector<NormalizedArticle>> hashToArticles;
-	for (auto&& article : articles)
-	{
-		auto articleHash = Hasher::sortAndCalcHash(article.titleWords);
-		auto articleIt = hashToArticles.find(articleHash);
-		hashToArticles[articleHash].push_back(std::move(article));
-	}
-	if (articles.size() == hashToArticles.size()) return articles;
-	std::vector<NormalizedArticle> newArticles;
-	std::transform(hashToArticles.begin(), hashToArticles.end(), std::back_inserter(newArticles),
-		[](auto& it)
+	auto titleHash = Hasher::sortAndCalcHash(article.titleWords);
+	if (_titlesCounts[titleHash]++ == 0)
+		_graph.addTerm(Term(article.titleWords, article.titleView, titleHash));
+}
+
+/**
+ * \brief articles with the same title are passed as one article with concatenated content.
+ * Only duplicated articles are kept in memory until their last part is read
+ */
+void SemanticGraphBuilder::forEachMergedArticle(ArticlesSource const& forEachArticle, ArticleVisitor const& onArticle) const
+{
+	std::unordered_map<size_t, std::pair<size_t, NormalizedArticle>> mergingArticles;
+	forEachArticle([this, &mergingArticles, &onArticle](NormalizedArticle const& article)
 		{
-			std::vector<NormalizedArticle>& articles = it.second;
-			if (articles.size() > 1) {
-				std::vector<std::string> contentSum;
-				std::for_each(articles.begin(), articles.end(), [&contentSum](NormalizedArticle const& art)
-					{
-						contentSum.insert(contentSum.end(), art.text.begin(), art.text.end());
-					});
-				articles[0].text = contentSum;
+			auto titleHash = Hasher::sortAndCalcHash(article.titleWords);
+			auto titleCount = _titlesCounts.at(titleHash);
+			if (titleCount == 1)
+			{
+				onArticle(article);
+				return;
+			}
+			auto mergingIt = mergingArticles.find(titleHash);
+			if (mergingIt == mergingArticles.end())
+				mergingIt = mergingArticles.emplace(titleHash, std::pair<size_t, NormalizedArticle>(1, article)).first;
+			else
+			{
+				auto& [partsCount, mergedArticle] = mergingIt->second;
+				partsCount++;
+				mergedArticle.text.insert(mergedArticle.text.end(), article.text.begin(), article.text.end());
+			}
+			if (mergingIt->second.first == titleCount)
+			{
+				onArticle(mergingIt->second.second);
+				mergingArticles.erase(mergingIt);
 			}
-			return articles[0];
 		});
-	return newArticles;
 }
 
 /**
- * \brief for each term, count how many articles use it
+ * \brief merged articles are copied to batches, so the batch can be handled in parallel
  */
-void SemanticGraphBuilder::countTermsUsedDocuments(std::vector<NormalizedArticle> const& articles)
+void SemanticGraphBuilder::forEachMergedArticlesBatch(ArticlesSource const& forEachArticle,
+	std::function<void(std::vector<NormalizedArticle> const&)> const& onBatch) const
 {
-	for (auto&& article : articles)
-	{
-		auto terms = std::set<size_t>();
-		for (size_t n = 1; n < _graph.getNForNgram(); n++)
+	std::vector<NormalizedArticle> batch;
+	batch.reserve(ARTICLES_BATCH_SIZE);
+	forEachMergedArticle(forEachArticle, [&batch, &onBatch](NormalizedArticle const& article)
 		{
-			if (article.text.size() < n)
-				break;
-			for (size_t pos = 0; pos < article.text.size() - n + 1; pos++)
+			batch.push_back(article);
+			if (batch.size() == ARTICLES_BATCH_SIZE)
 			{
-				auto ngramHash = Hasher::sortAndCalcHash(article.text, pos, n);
-				if (_graph.isTermExist(ngramHash))
-				{
-					terms.insert(ngramHash);
-				}
+				onBatch(batch);
+				batch.clear();
 			}
-		}
-		for (auto termsHash : terms)
+		});
+	if (!batch.empty())
+		onBatch(batch);
+}
+
+/**
+ * \brief n-grams of the article are looked up once. As before the scan was shared, the documents counts use
+ * all occurrences of terms shorter than nForNgram words, links use the occurrences selected by TermsUtils::selectTermsCounts
+ */
+SemanticGraphBuilder::ArticleTerms SemanticGraphBuilder::findArticleTerms(NormalizedArticle const& article) const
+{
+	ArticleTerms articleTerms;
+	articleTerms.titleIndex = findTermIndex(Hasher::sortAndCalcHash(article.titleWords));
+	auto occurrences = TermsUtils::findTermsOccurrences(_graph, article.text);
+	for (auto const& occurrence : occurrences)
+		if (occurrence.wordsCount < _graph.getNForNgram())
+			articleTerms.usedTerms.push_back(occurrence.hash);
+	std::sort(articleTerms.usedTerms.begin(), articleTerms.usedTerms.end());
+	articleTerms.usedTerms.erase(std::unique(articleTerms.usedTerms.begin(), articleTerms.usedTerms.end()), articleTerms.usedTerms.end());
+	for (auto [termHash, count] : TermsUtils::selectTermsCounts(occurrences, article.text.size()))
+		articleTerms.linkedTermsCounts.push_back({ findTermIndex(termHash), static_cast<uint32_t>(count) });
+	PROFILE_VALUE("articleWords", article.text.size());
+	return articleTerms;
+}
+
+uint32_t SemanticGraphBuilder::findTermIndex(size_t termHash) const
+{
+	return static_cast<uint32_t>(std::lower_bound(_termsHashes.begin(), _termsHashes.end(), termHash) - _termsHashes.begin());
+}
+
+/**
+ * \brief for each term, count how many articles use it. Terms of articles are searched in parallel
+ */
+void SemanticGraphBuilder::countTermsUsedDocuments(std::vector<NormalizedArticle> const& articles, LinkedTermsStore& linkedTerms)
+{
+	PROFILE_SCOPE("SemanticGraphBuilder::countTermsUsedDocuments");
+	std::vector<ArticleTerms> articlesTerms(articles.size());
+	ThreadPool::instance().parallelFor(0, articles.size(), [this, &articles, &articlesTerms](size_t begin, size_t end)
 		{
-			_graph.nodes.at(termsHash).term.numberOfArticlesThatUseIt += 1;
-		}
+			for (auto i = begin; i < end; i++)
+				articlesTerms[i] = findArticleTerms(articles[i]);
+		}, 1);
+	for (auto const& articleTerms : articlesTerms)
+	{
+		for (auto termHash : articleTerms.usedTerms)
+			_graph.nodes.at(termHash).term.numberOfArticlesThatUseIt += 1;
+		linkedTerms.add(articleTerms.titleIndex, articleTerms.linkedTermsCounts);
 	}
 }
 
 /**
- * \brief total count terms in all articles
- * (count of words in text)
+ * \brief idf depends only on the count of articles which use a term, so it's calculated once for each count
+ * instead of once for each link, then it's taken for each term in the nodes order
+ */
+std::vector<double> calcTermsIdfs(SemanticGraph const& graph, size_t articlesCount)
+{
+	size_t maxDocumentsCount = 0;
+	for (auto&& [hash, node] : graph.nodes)
+		maxDocumentsCount = std::max(maxDocumentsCount, node.term.numberOfArticlesThatUseIt);
+	std::vector<double> idfs(maxDocumentsCount + 1);
+	for (size_t documentsCount = 0; documentsCount < idfs.size(); documentsCount++)
+		idfs[documentsCount] = TermsUtils::calcIdf(documentsCount, articlesCount);
+	std::vector<double> termsIdfs;
+	termsIdfs.reserve(graph.nodes.size());
+	for (auto&& [hash, node] : graph.nodes)
+		termsIdfs.push_back(idfs[node.term.numberOfArticlesThatUseIt]);
+	return termsIdfs;
+}
+
+void SemanticGraphBuilder::linkArticle(uint32_t titleIndex, LinkedTermsStore::TermCount const* begin, LinkedTermsStore::TermCount const* end,
+	std::vector<double> const& idfs)
+{
+	// total count of terms in the article
+	auto linkedTermsSumCount = std::accumulate(begin, end, size_t(0), [](size_t sum, auto const& termCount) {return sum + termCount.count; });
+
+	for (auto it = begin; it != end; ++it)
+		if (titleIndex != it->termIndex) {
+			auto tfIdf = TermsUtils::calcTf(it->count, linkedTermsSumCount) * idfs[it->termIndex];
+			_graph.createLink(_termsHashes[titleIndex], _termsHashes[it->termIndex], tfIdf);
+		}
+}
+
+/**
+ * \brief articles are read once to add title terms, then once more to find their terms, so only a batch of merged articles
+ * and the counts of linked terms of each article are needed in memory
  */
-size_t getTermsCountsSum(std::map<size_t, size_t> const& termsCount)
+SemanticGraph SemanticGraphBuilder::buildFromSource(ArticlesSource const& forEachArticle, size_t memoryBudget)
 {
-	return std::transform_reduce(std::execution::par, termsCount.begin(), termsCount.end(), 0ull, [](size_t a, size_t b) {return a + b; }, [](auto const& pair) {return pair.second; });
+	PROFILE_SCOPE("SemanticGraphBuilder::build");
+	clearGraph();
+	forEachArticle([this](NormalizedArticle const& article) {addTitleTerm(article); });
+	return linkTerms(forEachArticle, memoryBudget);
 }
 
-SemanticGraph SemanticGraphBuilder::build(std::vector<NormalizedArticle> const& sourceArticles)
+void SemanticGraphBuilder::clearGraph()
 {
 	_graph = SemanticGraph();
-	auto articles = concatArticlesWithSameName(sourceArticles);
-	addAllTermsToGraph(articles);
-	countTermsUsedDocuments(articles);
-	for (auto&& article : articles)
+	_titlesCounts.clear();
+}
+
+/**
+ * \brief title terms must be added already. No terms are added while linking, so terms are referred by their positions
+ * in the nodes order, and a link count takes 8 bytes
+ * \throw std::length_error when the terms count doesn't fit 32 bits
+ */
+SemanticGraph SemanticGraphBuilder::linkTerms(ArticlesSource const& forEachArticle, size_t memoryBudget)
+{
+	if (_graph.nodes.size() > std::numeric_limits<uint32_t>::max())
+		throw std::length_error("Graph is too large to link");
+	_termsHashes.clear();
+	_termsHashes.reserve(_graph.nodes.size());
+	for (auto&& [hash, node] : _graph.nodes)
+		_termsHashes.push_back(hash);
+
+	LinkedTermsStore linkedTerms(memoryBudget);
+	forEachMergedArticlesBatch(forEachArticle, [this, &linkedTerms](std::vector<NormalizedArticle> const& articles) {countTermsUsedDocuments(articles, linkedTerms); });
+	auto articlesCount = _titlesCounts.size();
+	_graph.setArticlesCount(articlesCount);
+	auto idfs = calcTermsIdfs(_graph, articlesCount);
 	{
-		auto titleHash = Hasher::sortAndCalcHash(article.titleWords);
-		auto const& contentWords = article.text;
-		auto linkedTermsCounts = TermsUtils::extractTermsCounts(_graph, contentWords);
-		auto linkedTermsSumCount = getTermsCountsSum(linkedTermsCounts);
-		auto articlesCount = articles.size();
-
-		for (auto [termHash, linkCount] : linkedTermsCounts)
-			if (titleHash != termHash) {
-				auto const& term = _graph.nodes[termHash].term;
-				auto tfIdf = TermsUtils::calcTfIdf(linkCount, linkedTermsSumCount, term.numberOfArticlesThatUseIt, articlesCount);
-				_graph.createLink(titleHash, termHash, tfIdf);
-			}
+		PROFILE_SCOPE("SemanticGraphBuilder::linkArticles");
+		linkedTerms.forEach([this, &idfs](uint32_t titleIndex, LinkedTermsStore::TermCount const* begin, LinkedTermsStore::TermCount const* end)
+			{
+				linkArticle(titleIndex, begin, end, idfs);
+			});
 	}
+	_termsHashes = std::vector<size_t>();
 	return _graph;
 }
 
+SemanticGraph SemanticGraphBuilder::build(std::vector<NormalizedArticle> const& articles)
+{
+	return buildFromSource([&articles](ArticleVisitor const& onArticle)
+		{
+			for (auto const& article : articles)
+				onArticle(article);
+		});
+}
+
+SemanticGraph SemanticGraphBuilder::build(NormalizedArticlesStore const& articles)
+{
+	return buildFromSource([&articles](ArticleVisitor const& onArticle) {articles.forEach(onArticle); });
+}
+
+SemanticGraph SemanticGraphBuilder::build(NormalizedCorpusCache const& articles)
+{
+	return buildFromSource([&articles](ArticleVisitor const& onArticle) {articles.forEach(onArticle); });
+}
+
+void SemanticGraphBuilder::setCacheDirectory(std::string cacheDirectory)
+{
+	_cacheDirectory = std::move(cacheDirectory);
+}
+
+/**
+ * \brief the key of cached articles depends on the text, types of the reader and the lemmatizer.
+ * A damaged cache file is a miss, it's replaced by the articles normalized again
+ */
+SemanticGraph SemanticGraphBuilder::buildCached(std::string_view articlesText, IArticlesReader const& articlesReader)
+{
+	auto key = NormalizedCorpusCache::calcKey(articlesText, std::string(typeid(articlesReader).name()) + ' ' + _normalizer.lemmatizer().name());
+	auto filePath = NormalizedCorpusCache::getFilePath(_cacheDirectory, key);
+	NormalizedCorpusCache articles;
+	_pipelineMetrics = PipelineMetrics();
+	bool isLoaded = false;
+	try
+	{
+		isLoaded = articles.load(filePath, key);
+	}
+	catch (std::runtime_error const&)
+	{
+	}
+	if (!isLoaded)
+	{
+		_pipelineMetrics = _normalizer.readAndNormalizeArticles(articlesText, articlesReader, [&articles](NormalizedArticle&& article)
+			{
+				articles.add(article);
+			});
+		std::filesystem::create_directories(_cacheDirectory);
+		articles.save(filePath, key);
+	}
+	return build(articles);
+}
+
+PipelineMetrics const& SemanticGraphBuilder::getPipelineMetrics() const
+{
+	return _pipelineMetrics;
+}
+
+/**
+ * \brief title terms are added while the next articles are normalized, so the first pass overlaps normalization
+ */
+SemanticGraph SemanticGraphBuilder::buildFromNormalization(std::function<PipelineMetrics(std::function<void(NormalizedArticle&&)> const&)> const& normalizeArticles,
+	size_t memoryBudget)
+{
+	PROFILE_SCOPE("SemanticGraphBuilder::buildFromNormalization");
+	NormalizedArticlesStore articles(memoryBudget);
+	clearGraph();
+	_pipelineMetrics = normalizeArticles([this, &articles](NormalizedArticle&& article)
+		{
+			addTitleTerm(article);
+			articles.add(std::move(article));
+		});
+	// articles are kept while their terms are linked, so the counts of linked terms get the rest of the budget
+	return linkTerms([&articles](ArticleVisitor const& onArticle) {articles.forEach(onArticle); }, memoryBudget - articles.memorySize());
+}
+
+SemanticGraph SemanticGraphBuilder::buildFromStream(std::string_view articlesText, IArticlesReader const& articlesReader, size_t memoryBudget)
+{
+	if (!_cacheDirectory.empty())
+		return buildCached(articlesText, articlesReader);
+	return buildFromNormalization([this, articlesText, &articlesReader](std::function<void(NormalizedArticle&&)> const& onArticle)
+		{
+			return _normalizer.readAndNormalizeArticles(articlesText, articlesReader, onArticle);
+		}, memoryBudget);
+}
+
 SemanticGraph SemanticGraphBuilder::build(std::string const& xmlText)
 {
-	ArticlesNormalizer articlesNormalizer;
-	return build(articlesNormalizer.readAndNormalizeArticles(xmlText, XmlArticlesReader()));
+	return buildFromStream(xmlText, XmlArticlesReader(), NormalizedArticlesStore::DEFAULT_MEMORY_BUDGET);
+}
+
+SemanticGraph SemanticGraphBuilder::build(std::string const& articlesText, IArticlesReader const& articlesReader, size_t memoryBudget)
+{
+	return buildFromStream(articlesText, articlesReader, memoryBudget);
 }
 
-SemanticGraph SemanticGraphBuilder::build(std::string const& articlesText, IArticlesReader const& articlesReader)
+SemanticGraph SemanticGraphBuilder::buildFromFile(std::string const& filePath, IArticlesReader const& articlesReader, size_t memoryBudget)
 {
-	ArticlesNormalizer reader;
-	return build(reader.readAndNormalizeArticles(articlesText, articlesReader));
-}
\ No newline at end of file
+	MappedFile file(filePath);
+	return buildFromStream(file.view(), articlesReader, memoryBudget);
+}
+
+SemanticGraph SemanticGraphBuilder::buildFromCorpus(std::string const& corpusPath, CorpusIngestor const& ingestor, IngestionReport& report, size_t memoryBudget)
+{
+	return buildFromNormalization([this, &corpusPath, &ingestor, &report](std::function<void(NormalizedArticle&&)> const& onArticle)
+		{
+			return _normalizer.normalizeArticles([&corpusPath, &ingestor, &report](IArticlesReader::ArticleHandler const& onSourceArticle)
+				{
+					report = ingestor.ingest(corpusPath, onSourceArticle);
+				}, onArticle);
+		}, memoryBudget);
+}
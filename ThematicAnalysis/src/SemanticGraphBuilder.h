@@ -1,5 +1,15 @@
 ﻿#pragma once
+#include <functional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "ArticlesNormalizer.h"
+#include "CorpusIngestor.h"
+#include "LinkedTermsStore.h"
 #include "NormalizedArticle.h"
+#include "NormalizedArticlesStore.h"
+#include "NormalizedCorpusCache.h"
 #include "SemanticGraph.h"
 
 class IArticlesReader;
@@ -7,13 +17,72 @@ class IArticlesReader;
 class SemanticGraphBuilder
 {
 public:
+	SemanticGraphBuilder() = default;
+	explicit SemanticGraphBuilder(std::shared_ptr<ILemmatizer const> lemmatizer);
+
 	SemanticGraph build(std::vector<NormalizedArticle> const& articles);
+	SemanticGraph build(NormalizedArticlesStore const& articles);
+	SemanticGraph build(NormalizedCorpusCache const& articles);
 	SemanticGraph build(std::string const& xmlText);
-	SemanticGraph build(std::string const& articlesText, IArticlesReader const& articlesReader);
+	SemanticGraph build(std::string const& articlesText, IArticlesReader const& articlesReader,
+		size_t memoryBudget = NormalizedArticlesStore::DEFAULT_MEMORY_BUDGET);
+	// the file is mapped into memory, normalized articles and counts of their linked terms are spilled to temporary files
+	// when together they exceed memoryBudget
+	SemanticGraph buildFromFile(std::string const& filePath, IArticlesReader const& articlesReader,
+		size_t memoryBudget = NormalizedArticlesStore::DEFAULT_MEMORY_BUDGET);
+	// corpus files are read by the ingestor, see CorpusIngestor::ingest
+	SemanticGraph buildFromCorpus(std::string const& corpusPath, CorpusIngestor const& ingestor, IngestionReport& report,
+		size_t memoryBudget = NormalizedArticlesStore::DEFAULT_MEMORY_BUDGET);
+	// normalized articles of texts and files are saved to the directory and loaded on the next builds
+	// of the same text with the same reader and lemmatizer, see NormalizedCorpusCache
+	void setCacheDirectory(std::string cacheDirectory);
+	// metrics of normalization stages of the last build from text, file or corpus
+	PipelineMetrics const& getPipelineMetrics() const;
 	SemanticGraph _graph;
 	static const double WEIGHT_ADDITION;
 
 private:
-	void addAllTermsToGraph(std::vector<NormalizedArticle> const& articles);
-	void countTermsUsedDocuments(std::vector<NormalizedArticle> const& articles);
+	using ArticleVisitor = std::function<void(NormalizedArticle const&)>;
+	using ArticlesSource = std::function<void(ArticleVisitor const&)>;
+
+	SemanticGraph buildFromSource(ArticlesSource const& forEachArticle, size_t memoryBudget = NormalizedArticlesStore::DEFAULT_MEMORY_BUDGET);
+	SemanticGraph buildFromNormalization(std::function<PipelineMetrics(std::function<void(NormalizedArticle&&)> const&)> const& normalizeArticles,
+		size_t memoryBudget);
+	void clearGraph();
+	// counts of linked terms are spilled to temporary file when they exceed memoryBudget
+	SemanticGraph linkTerms(ArticlesSource const& forEachArticle, size_t memoryBudget);
+	SemanticGraph buildFromStream(std::string_view articlesText, IArticlesReader const& articlesReader, size_t memoryBudget);
+	SemanticGraph buildCached(std::string_view articlesText, IArticlesReader const& articlesReader);
+	void addTitleTerm(NormalizedArticle const& article);
+	void forEachMergedArticle(ArticlesSource const& forEachArticle, ArticleVisitor const& onArticle) const;
+	void forEachMergedArticlesBatch(ArticlesSource const& forEachArticle, std::function<void(std::vector<NormalizedArticle> const&)> const& onBatch) const;
+
+	// terms of a merged article found by one scan of its n-grams
+	struct ArticleTerms
+	{
+		uint32_t titleIndex;
+		// terms which count the article in their documents count, sorted
+		std::vector<size_t> usedTerms;
+		// counts of terms to link the title with, sorted by index
+		std::vector<LinkedTermsStore::TermCount> linkedTermsCounts;
+	};
+
+	ArticleTerms findArticleTerms(NormalizedArticle const& article) const;
+	uint32_t findTermIndex(size_t termHash) const;
+	// linked terms of the articles are stored until the documents counts of all articles are known
+	void countTermsUsedDocuments(std::vector<NormalizedArticle> const& articles, LinkedTermsStore& linkedTerms);
+	// idfs are indexed by the term index
+	void linkArticle(uint32_t titleIndex, LinkedTermsStore::TermCount const* begin, LinkedTermsStore::TermCount const* end,
+		std::vector<double> const& idfs);
+
+	// count of merged articles which terms are searched in parallel
+	static const size_t ARTICLES_BATCH_SIZE;
+
+	// count of articles with the same title
+	std::unordered_map<size_t, size_t> _titlesCounts;
+	// hashes of the graph terms in the nodes order while the terms are linked, term index is a position in it
+	std::vector<size_t> _termsHashes;
+	ArticlesNormalizer _normalizer;
+	std::string _cacheDirectory;
+	PipelineMetrics _pipelineMetrics;
 };
@@ -1,53 +1,41 @@
-#include "TagsAnalyzer.h"
+﻿#include "TagsAnalyzer.h"
 
 #include <algorithm>
-#include <execution>
 #include <iterator>
+#include <numeric>
 
 #include "ArticlesNormalizer.h"
 #include "SemanticGraphBuilder.h"
+#include "Utils/Profiler.h"
 #include "Utils/TermsUtils.h"
 
 constexpr double TagsAnalyzer::DISTRIBUTION_COEF = 1.;
 constexpr double TagsAnalyzer::ABSORPTION_COEF = 0.5;
 constexpr size_t TagsAnalyzer::LINK_RADIUS = 1;
 
-
-void TagsAnalyzer::analyze(std::string const& text, SemanticGraph const& graph)
+TagsAnalyzer::TagsAnalyzer(std::shared_ptr<ILemmatizer const> lemmatizer) : _normalizer(std::move(lemmatizer))
 {
-	TextNormalizer normalizer;
-	auto normText = normalizer.normalize(text);
-	analyze(normText, graph);
 }
 
-size_t getNotNullWeightNodesCount(SemanticGraph const& graph)
+void TagsAnalyzer::analyze(std::string const& text, SemanticGraph const& graph)
 {
-	return std::transform_reduce(std::execution::par, graph.nodes.begin(), graph.nodes.end(), 0ull,
-		[](size_t a, size_t b) {return a + b; },
-		[](std::pair<size_t, Node> const& pair) {return pair.second.weight > FLT_EPSILON ? 1ull : 0ull; });
+	PROFILE_SCOPE("TagsAnalyzer::analyze");
+	auto normText = _normalizer.normalize(text);
+	analyze(normText, graph);
 }
 
-
-
-void calcFrequency(SemanticGraph& graph, std::vector<std::string> const& normalizedText)
+/**
+ * \brief only the terms of the text are visited, tf-idf is added to the node weight
+ */
+void calcTfIdf(SemanticGraph& graph, std::vector<std::string> const& normalizedText)
 {
 	auto termsCounts = TermsUtils::extractTermsCounts(graph, normalizedText);
-	std::map<std::string, size_t> termsViewsCounts;
-	std::transform(termsCounts.begin(), termsCounts.end(), std::inserter(termsViewsCounts,termsViewsCounts.begin()), [&graph](std::pair<size_t, size_t> const& pair){return std::pair{graph.nodes.at(pair.first).term.view, pair.second};});
-	for(auto&& [termhash, count]: termsCounts)
+	auto articlesCount = graph.getArticlesCount();
+	for (auto&& [termHash, count] : termsCounts)
 	{
-		graph.addTermWeight(termhash, count);
+		auto& node = graph.nodes.at(termHash);
+		node.weight += TermsUtils::calcTfIdf(count, termsCounts.size(), node.term.numberOfArticlesThatUseIt, articlesCount);
 	}
-	
-}
-
-void calcTfIdf(SemanticGraph& graph)
-{
-	auto textTermsCount = getNotNullWeightNodesCount(graph);
-	for (auto&& [hash, node] : graph.nodes)
-		if (node.weight > FLT_EPSILON) {
-			node.weight = TermsUtils::calcTfIdf(static_cast<size_t>(node.weight), textTermsCount, node.term.numberOfArticlesThatUseIt, graph.nodes.size() + 1);
-		}
 }
 
 void TagsAnalyzer::distributeTermWeight(SemanticGraph& graph, size_t centerTermHash, size_t radius, double weight)
@@ -67,6 +55,7 @@ void TagsAnalyzer::distributeTermWeight(SemanticGraph& graph, size_t centerTermH
 
 SemanticGraph TagsAnalyzer::distributeTermsWeights(SemanticGraph const& graph)
 {
+	PROFILE_SCOPE("TagsAnalyzer::distributeTermsWeights");
 	auto distrGraph = graph;
 	for (auto&& [hash, node] : graph.nodes)
 		if (node.weight > FLT_EPSILON) {
@@ -77,15 +66,16 @@ SemanticGraph TagsAnalyzer::distributeTermsWeights(SemanticGraph const& graph)
 
 void TagsAnalyzer::analyze(std::vector<std::string> const& normalizedText, SemanticGraph const& graph)
 {
+	PROFILE_SCOPE("TagsAnalyzer::analyzeNormalized");
 	tagsGraph = graph;
-	calcFrequency(tagsGraph, normalizedText);
-	calcTfIdf(tagsGraph);
+	calcTfIdf(tagsGraph, normalizedText);
 	tagsGraph = distributeTermsWeights(tagsGraph);
 }
 
 
 std::vector<Tag> TagsAnalyzer::getRelevantTags(size_t tagsCount)
 {
+	PROFILE_SCOPE("TagsAnalyzer::getRelevantTags");
 	std::vector<Node> nodes;
 	nodes.reserve(tagsGraph.nodes.size());
 	std::transform(tagsGraph.nodes.begin(), tagsGraph.nodes.end(), std::back_inserter(nodes), [](auto el) {return el.second; });
@@ -99,4 +89,75 @@ std::vector<Tag> TagsAnalyzer::getRelevantTags(size_t tagsCount)
 
 }
 
+/**
+ * \brief links which weigh nothing in total (e.g. quantized to zero) don't get weight instead of NaN
+ */
+template <typename Weight>
+void TagsAnalyzer::distributeTermWeight(FrozenSemanticGraph<Weight> const& graph, std::vector<double>& weights, TermTable::Index center, size_t radius, double weight)
+{
+	const auto weightSum = radius > 0 ? graph.sumLinksWeight(center) : 0.;
+	if (weightSum > 0)
+	{
+		for (auto link = graph.getLinksBegin(center); link < graph.getLinksEnd(center); link++)
+		{
+			auto neighborWeight = weight * (graph.getLinkWeight(link) / weightSum);
+			weights[graph.getLinkTarget(link)] += neighborWeight * ABSORPTION_COEF;
+			distributeTermWeight(graph, weights, graph.getLinkTarget(link), radius - 1, neighborWeight * (1 - ABSORPTION_COEF));
+		}
+	}
+}
+
+template <typename Weight>
+std::vector<double> TagsAnalyzer::distributeTermsWeights(FrozenSemanticGraph<Weight> const& graph, std::vector<double> const& weights)
+{
+	PROFILE_SCOPE("TagsAnalyzer::distributeTermsWeightsFrozen");
+	auto distributedWeights = weights;
+	for (TermTable::Index i = 0; i < weights.size(); i++)
+		if (weights[i] > FLT_EPSILON)
+			distributeTermWeight(graph, distributedWeights, i, LINK_RADIUS, weights[i] * DISTRIBUTION_COEF);
+	return distributedWeights;
+}
+
+/**
+ * \brief weights are kept in an array by term index instead of a graph copy, tags of equal weights are ordered by term hash.
+ * Tf-idf of the text terms is added to the node weights in one pass over their indexes, counts and the idf table
+ */
+template <typename Weight>
+std::vector<Tag> TagsAnalyzer::getRelevantTags(std::vector<std::string> const& normalizedText, FrozenSemanticGraph<Weight> const& graph, size_t tagsCount)
+{
+	PROFILE_SCOPE("TagsAnalyzer::getRelevantTagsFrozen");
+	std::vector<double> weights(graph.nodesCount());
+	for (TermTable::Index i = 0; i < weights.size(); i++)
+		weights[i] = graph.getWeight(i);
+	std::vector<TermTable::Index> terms;
+	std::vector<size_t> counts;
+	for (auto&& [termHash, count] : TermsUtils::extractTermsCounts(graph, normalizedText))
+	{
+		terms.push_back(graph.find(termHash));
+		counts.push_back(count);
+	}
+	graph.idf().addTfIdf(terms, counts, weights);
+
+	auto distributedWeights = distributeTermsWeights(graph, weights);
+	std::vector<TermTable::Index> indexes(distributedWeights.size());
+	std::iota(indexes.begin(), indexes.end(), 0);
+	tagsCount = std::min(tagsCount, indexes.size());
+	// ties are broken by hash, so the order of tags doesn't depend on the nodes order
+	std::partial_sort(indexes.begin(), indexes.begin() + static_cast<ptrdiff_t>(tagsCount), indexes.end(), [&distributedWeights, &graph](auto first, auto second)
+		{
+			return distributedWeights[first] > distributedWeights[second]
+				|| (distributedWeights[first] == distributedWeights[second] && graph.terms().getHash(first) < graph.terms().getHash(second));
+		});
+	std::vector<Tag> tags;
+	tags.reserve(tagsCount);
+	for (size_t i = 0; i < tagsCount; i++)
+		tags.push_back(Tag{ std::string(graph.terms().getView(indexes[i])), distributedWeights[indexes[i]] });
+	return tags;
+}
 
+template std::vector<Tag> TagsAnalyzer::getRelevantTags(std::vector<std::string> const&, FrozenSemanticGraph<double> const&, size_t);
+template std::vector<Tag> TagsAnalyzer::getRelevantTags(std::vector<std::string> const&, FrozenSemanticGraph<float> const&, size_t);
+template std::vector<Tag> TagsAnalyzer::getRelevantTags(std::vector<std::string> const&, FrozenSemanticGraph<Quantized16> const&, size_t);
+template std::vector<double> TagsAnalyzer::distributeTermsWeights(FrozenSemanticGraph<double> const&, std::vector<double> const&);
+template std::vector<double> TagsAnalyzer::distributeTermsWeights(FrozenSemanticGraph<float> const&, std::vector<double> const&);
+template std::vector<double> TagsAnalyzer::distributeTermsWeights(FrozenSemanticGraph<Quantized16> const&, std::vector<double> const&);
@@ -1,5 +1,7 @@
 #pragma once
+#include "FrozenSemanticGraph.h"
 #include "SemanticGraph.h"
+#include "TextNormalizer.h"
 
 
 struct Tag
@@ -11,21 +13,33 @@ struct Tag
 class TagsAnalyzer
 {
 public:
+	TagsAnalyzer() = default;
+	explicit TagsAnalyzer(std::shared_ptr<ILemmatizer const> lemmatizer);
+
 	//why public?
 	SemanticGraph tagsGraph;
 	void analyze(std::string const& text, SemanticGraph const& graph);
 	void analyze(std::vector<std::string> const& normalizedText, SemanticGraph const& graph);
 
 	std::vector<Tag> getRelevantTags(size_t tagsCount);
+	// tags of the text over the frozen graph, weights are calculated and distributed as by analyze
+	template <typename Weight>
+	static std::vector<Tag> getRelevantTags(std::vector<std::string> const& normalizedText, FrozenSemanticGraph<Weight> const& graph, size_t tagsCount);
+	// weights of the frozen graph nodes (by index) after they are distributed to the neighbors
+	template <typename Weight>
+	static std::vector<double> distributeTermsWeights(FrozenSemanticGraph<Weight> const& graph, std::vector<double> const& weights);
 
 private:
 	static void distributeTermWeight(SemanticGraph& graph, size_t centerTermHash, size_t radius, double weight);
+	template <typename Weight>
+	static void distributeTermWeight(FrozenSemanticGraph<Weight> const& graph, std::vector<double>& weights, TermTable::Index center, size_t radius, double weight);
 	static SemanticGraph distributeTermsWeights(SemanticGraph const& graph);
 
 	static const double DISTRIBUTION_COEF;	// the percent of the central vertex weight, transfer to the neighbors in the distribution
 	static const double ABSORPTION_COEF;	// percent of weight absorbed by the vertex in distribution
 	static const size_t LINK_RADIUS;
 	SemanticGraph _sourceGraph;
+	TextNormalizer _normalizer;
 };
 
 
@@ -0,0 +1,144 @@
+﻿#include "TermTable.h"
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+#include "Utils/BinaryUtils.h"
+
+const TermTable::Index TermTable::NO_INDEX = std::numeric_limits<TermTable::Index>::max();
+
+const size_t MIN_TERMS_SLOTS_COUNT = 16;
+
+TermTable::TermTable(SemanticGraph const& graph)
+{
+	_records.reserve(graph.nodes.size());
+	for (auto&& [hash, node] : graph.nodes)
+		add(node.term);
+}
+
+/**
+ * \brief hashes are already well mixed, so the slot is the low bits of the hash
+ */
+size_t TermTable::findSlot(size_t hash) const
+{
+	auto mask = _slots.size() - 1;
+	for (auto slot = hash & mask;; slot = (slot + 1) & mask)
+		if (_slots[slot] == NO_INDEX || _records[_slots[slot]].hash == hash)
+			return slot;
+}
+
+void TermTable::rehash(size_t slotsCount)
+{
+	_slots.assign(slotsCount, NO_INDEX);
+	for (Index i = 0; i < _records.size(); i++)
+		_slots[findSlot(_records[i].hash)] = i;
+}
+
+TermTable::Index TermTable::add(Term const& term)
+{
+	if ((_records.size() + 1) * 2 > _slots.size())
+		rehash(std::max(MIN_TERMS_SLOTS_COUNT, _slots.size() * 2));
+	auto slot = findSlot(term.getHashCode());
+	if (_slots[slot] != NO_INDEX)
+		return _slots[slot];
+	if (_records.size() + 1 >= NO_INDEX || _words.size() + term.normalizedWords.size() > std::numeric_limits<uint32_t>::max()
+		|| term.numberOfArticlesThatUseIt > std::numeric_limits<uint32_t>::max())
+		throw std::length_error("Term " + term.view + " doesn't fit the terms table");
+
+	Record record;
+	record.hash = term.getHashCode();
+	record.view = _strings.add(term.view);
+	record.firstWord = static_cast<uint32_t>(_words.size());
+	record.wordsCount = static_cast<uint32_t>(term.normalizedWords.size());
+	record.documentsCount = static_cast<uint32_t>(term.numberOfArticlesThatUseIt);
+	for (auto const& word : term.normalizedWords)
+		_words.push_back(_strings.add(word));
+
+	auto index = static_cast<Index>(_records.size());
+	_records.push_back(record);
+	_slots[slot] = index;
+	return index;
+}
+
+TermTable::Index TermTable::find(size_t hash) const
+{
+	return _slots.empty() ? NO_INDEX : _slots[findSlot(hash)];
+}
+
+size_t TermTable::size() const
+{
+	return _records.size();
+}
+
+size_t TermTable::getHash(Index index) const
+{
+	return _records[index].hash;
+}
+
+std::string_view TermTable::getView(Index index) const
+{
+	return _strings.get(_records[index].view);
+}
+
+size_t TermTable::getWordsCount(Index index) const
+{
+	return _records[index].wordsCount;
+}
+
+std::string_view TermTable::getWord(Index index, size_t wordIndex) const
+{
+	return _strings.get(_words[_records[index].firstWord + wordIndex]);
+}
+
+uint32_t TermTable::getDocumentsCount(Index index) const
+{
+	return _records[index].documentsCount;
+}
+
+void TermTable::setDocumentsCount(Index index, uint32_t documentsCount)
+{
+	_records[index].documentsCount = documentsCount;
+}
+
+Term TermTable::getTerm(Index index) const
+{
+	std::vector<std::string> words;
+	words.reserve(getWordsCount(index));
+	for (size_t i = 0; i < getWordsCount(index); i++)
+		words.emplace_back(getWord(index, i));
+	Term term(std::move(words), std::string(getView(index)), getHash(index));
+	term.numberOfArticlesThatUseIt = getDocumentsCount(index);
+	return term;
+}
+
+size_t TermTable::getMemoryUsage() const
+{
+	return _records.capacity() * sizeof(Record) + _words.capacity() * sizeof(StringPool::Id)
+		+ _slots.capacity() * sizeof(Index) + _strings.getMemoryUsage();
+}
+
+void TermTable::saveToStream(std::ostream& out) const
+{
+	BinaryUtils::writeVector(out, _records);
+	BinaryUtils::writeVector(out, _words);
+	BinaryUtils::writeVector(out, _slots);
+	_strings.saveToStream(out);
+}
+
+void TermTable::loadFromStream(std::istream& in)
+{
+	auto records = BinaryUtils::readVector<Record>(in);
+	auto words = BinaryUtils::readVector<StringPool::Id>(in);
+	auto slots = BinaryUtils::readVector<Index>(in);
+	auto isRecordValid = [&words](Record const& record) {return size_t(record.firstWord) + record.wordsCount <= words.size(); };
+	auto isSlotValid = [&records](Index index) {return index == NO_INDEX || index < records.size(); };
+	// a full table would make findSlot of a missing hash loop forever
+	auto occupiedCount = static_cast<size_t>(std::count_if(slots.begin(), slots.end(), [](Index index) {return index != NO_INDEX; }));
+	if ((slots.size() & (slots.size() - 1)) != 0 || records.size() * 2 > slots.size() || occupiedCount != records.size()
+		|| !std::all_of(records.begin(), records.end(), isRecordValid) || !std::all_of(slots.begin(), slots.end(), isSlotValid))
+		throw std::runtime_error("Broken terms table data");
+	_strings.loadFromStream(in);
+	_records = std::move(records);
+	_words = std::move(words);
+	_slots = std::move(slots);
+}
@@ -0,0 +1,65 @@
+﻿#pragma once
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string_view>
+#include <vector>
+
+#include "SemanticGraph.h"
+#include "Term.h"
+#include "Utils/StringPool.h"
+
+/**
+ * \brief terms as fixed size records: views and lemmas are kept once in a string pool, lemmas of a term
+ * are a span of word ids. Terms are found by hash through an open addressing table of indexes
+ */
+class TermTable
+{
+public:
+	using Index = uint32_t;
+	static const Index NO_INDEX;
+
+	TermTable() = default;
+	// terms of the graph nodes in the order of hashes
+	explicit TermTable(SemanticGraph const& graph);
+
+	// index of the term with the same hash when it's already added,
+	// throw std::length_error when the articles count or the table size don't fit 32 bits
+	Index add(Term const& term);
+	// NO_INDEX when the term isn't added
+	Index find(size_t hash) const;
+	size_t size() const;
+
+	size_t getHash(Index index) const;
+	std::string_view getView(Index index) const;
+	size_t getWordsCount(Index index) const;
+	std::string_view getWord(Index index, size_t wordIndex) const;
+	uint32_t getDocumentsCount(Index index) const;
+	void setDocumentsCount(Index index, uint32_t documentsCount);
+	Term getTerm(Index index) const;
+
+	// bytes of records, word ids, the index and the string pool
+	size_t getMemoryUsage() const;
+
+	void saveToStream(std::ostream& out) const;
+	// throw std::runtime_error when the data is broken
+	void loadFromStream(std::istream& in);
+
+private:
+	struct Record
+	{
+		size_t hash;
+		StringPool::Id view;
+		uint32_t firstWord;
+		uint32_t wordsCount;
+		uint32_t documentsCount;
+	};
+
+	size_t findSlot(size_t hash) const;
+	void rehash(size_t slotsCount);
+
+	std::vector<Record> _records;
+	std::vector<StringPool::Id> _words;
+	std::vector<Index> _slots;
+	StringPool _strings;
+};
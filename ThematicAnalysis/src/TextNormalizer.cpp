@@ -1,15 +1,23 @@
 ﻿#include "TextNormalizer.h"
 
 #include <algorithm>
-#include <execution>
-#include <locale>
 
+#include "Lemmatizer.h"
+#include "Utils/EncodingUtils.h"
 #include "Utils/StringUtils.h"
+#include "Utils/ThreadPool.h"
+
+TextNormalizer::TextNormalizer() : _lemmatizer(std::make_shared<Lemmatizer>())
+{
+}
+
+TextNormalizer::TextNormalizer(std::shared_ptr<ILemmatizer const> lemmatizer) : _lemmatizer(std::move(lemmatizer))
+{
+}
 
 std::string TextNormalizer::clearText(std::string text) const
 {
-	static std::locale loc("ru-RU");
-	std::transform(std::execution::par, text.begin(), text.end(), text.begin(), [](char ch) {return isalpha(ch, loc) || isdigit(ch, loc) ? ch : ' '; });
+	std::transform(text.begin(), text.end(), text.begin(), [](char ch) {return EncodingUtils::isLetterOrDigit(ch) ? ch : ' '; });
 	text.erase(std::unique(text.begin(), text.end(), [](char ch, char ch2) {return ch == ch2 && ch == ' '; }), text.end());
 	if(text.size() > 0 && text.front() == ' ') text.erase(text.begin());
 	if(text.size() > 0 && text.back() == ' ') text.erase(text.end()-1);
@@ -27,8 +35,7 @@ std::string TextNormalizer::eraseStopWords(std::string text) const
 
 std::string TextNormalizer::toLowerText(std::string  word) const
 {
-	static std::locale loc("ru-RU");
-	std::transform(std::execution::par, word.begin(), word.end(), word.begin(), [](char ch) {return tolower(ch, loc); });
+	std::transform(word.begin(), word.end(), word.begin(), EncodingUtils::toLower);
 	return word;
 }
 
@@ -38,5 +45,36 @@ std::vector<std::string> TextNormalizer::normalize(std::string text) const
 	text = clearText(text);
 	text = toLowerText(text);
 	text = eraseStopWords(text);
-	return _lemmatizer.lemmatizeText(text);
+	return _lemmatizer->lemmatizeText(text);
+}
+
+ILemmatizer const& TextNormalizer::lemmatizer() const
+{
+	return *_lemmatizer;
+}
+
+SegmentedTokens TextNormalizer::normalizeSegments(std::vector<std::string_view> const& segments) const
+{
+	return _lemmatizer->lemmatizeLines(clearSegments(segments), segments.size());
+}
+
+std::string TextNormalizer::clearSegments(std::vector<std::string_view> const& segments) const
+{
+	std::vector<std::string> clearedSegments(segments.size());
+	ThreadPool::instance().parallelFor(0, segments.size(), [this, &segments, &clearedSegments](size_t begin, size_t end)
+		{
+			for (auto i = begin; i < end; i++)
+				clearedSegments[i] = eraseStopWords(toLowerText(clearText(std::string(segments[i]))));
+		});
+	size_t textSize = 0;
+	for (auto const& segment : clearedSegments)
+		textSize += segment.size() + 1;
+	std::string text;
+	text.reserve(textSize);
+	for (auto const& segment : clearedSegments)
+	{
+		text += segment;
+		text += '\n';
+	}
+	return text;
 }
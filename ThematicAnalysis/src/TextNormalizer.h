@@ -1,17 +1,28 @@
 ﻿#pragma once
+#include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 
-#include "Lemmatizer.h"
+#include "Lemmatizer/ILemmatizer.h"
 
 class TextNormalizer
 {
 public:
+	// mystem backend
+	TextNormalizer();
+	explicit TextNormalizer(std::shared_ptr<ILemmatizer const> lemmatizer);
+
 	std::string clearText(std::string text) const;
 	std::string eraseStopWords(std::string text) const;
 	std::string toLowerText(std::string word) const;
 	std::vector<std::string> normalize(std::string text) const;
+	// all segments are normalized at once, boundaries of segments are kept in offsets of result
+	SegmentedTokens normalizeSegments(std::vector<std::string_view> const& segments) const;
+	// cleared segments are lines of the result, which is ready for ILemmatizer::lemmatizeLines
+	std::string clearSegments(std::vector<std::string_view> const& segments) const;
+	ILemmatizer const& lemmatizer() const;
 
 private:
-	Lemmatizer _lemmatizer;
+	std::shared_ptr<ILemmatizer const> _lemmatizer;
 };
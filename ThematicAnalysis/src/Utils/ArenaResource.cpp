@@ -0,0 +1,76 @@
+﻿#include "ArenaResource.h"
+#include <algorithm>
+
+const size_t ArenaResource::MAX_BLOCK_SIZE = ArenaResource::GRANULARITY * ArenaResource::SIZE_CLASSES_COUNT;
+const size_t ArenaResource::MIN_CHUNK_SIZE = 4 * 1024;
+const size_t ArenaResource::MAX_CHUNK_SIZE = 1024 * 1024;
+
+ArenaResource::ArenaResource(std::pmr::memory_resource* upstream) : _upstream(upstream)
+{
+}
+
+ArenaResource::~ArenaResource()
+{
+	for (auto [chunk, size] : _chunks)
+		_upstream->deallocate(chunk, size, GRANULARITY);
+}
+
+size_t ArenaResource::chunksBytes() const
+{
+	return _chunksBytes;
+}
+
+bool ArenaResource::isBlock(size_t bytes, size_t alignment)
+{
+	return bytes <= MAX_BLOCK_SIZE && alignment <= GRANULARITY;
+}
+
+/**
+ * \brief the rest of the current chunk is left when a block doesn't fit, chunks grow twice up to the max size,
+ * so small arenas stay small
+ */
+void* ArenaResource::allocateFromChunk(size_t size)
+{
+	if (static_cast<size_t>(_chunkEnd - _chunkPosition) < size)
+	{
+		auto chunkSize = _chunks.empty() ? MIN_CHUNK_SIZE : std::min(MAX_CHUNK_SIZE, _chunks.back().second * 2);
+		auto chunk = static_cast<char*>(_upstream->allocate(chunkSize, GRANULARITY));
+		_chunks.emplace_back(chunk, chunkSize);
+		_chunksBytes += chunkSize;
+		_chunkPosition = chunk;
+		_chunkEnd = chunk + chunkSize;
+	}
+	auto block = _chunkPosition;
+	_chunkPosition += size;
+	return block;
+}
+
+void* ArenaResource::do_allocate(size_t bytes, size_t alignment)
+{
+	if (!isBlock(bytes, alignment))
+		return _upstream->allocate(bytes, alignment);
+	auto sizeClass = bytes == 0 ? 0 : (bytes - 1) / GRANULARITY;
+	if (auto block = _freeBlocks[sizeClass])
+	{
+		_freeBlocks[sizeClass] = *static_cast<void**>(block);
+		return block;
+	}
+	return allocateFromChunk((sizeClass + 1) * GRANULARITY);
+}
+
+void ArenaResource::do_deallocate(void* pointer, size_t bytes, size_t alignment)
+{
+	if (!isBlock(bytes, alignment))
+	{
+		_upstream->deallocate(pointer, bytes, alignment);
+		return;
+	}
+	auto sizeClass = bytes == 0 ? 0 : (bytes - 1) / GRANULARITY;
+	*static_cast<void**>(pointer) = _freeBlocks[sizeClass];
+	_freeBlocks[sizeClass] = pointer;
+}
+
+bool ArenaResource::do_is_equal(std::pmr::memory_resource const& other) const noexcept
+{
+	return this == &other;
+}
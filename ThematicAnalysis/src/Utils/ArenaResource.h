@@ -0,0 +1,45 @@
+﻿#pragma once
+#include <array>
+#include <memory_resource>
+#include <vector>
+
+/**
+ * \brief memory of small blocks in chunks of growing size: freed blocks are reused by allocations of the same
+ * size class, chunks are returned to the upstream resource when the arena is destroyed.
+ * Large and overaligned blocks are allocated by the upstream resource. The arena isn't synchronized
+ */
+class ArenaResource : public std::pmr::memory_resource
+{
+public:
+	explicit ArenaResource(std::pmr::memory_resource* upstream = std::pmr::new_delete_resource());
+	ArenaResource(ArenaResource const&) = delete;
+	ArenaResource& operator=(ArenaResource const&) = delete;
+	~ArenaResource() override;
+
+	// bytes of chunks taken from the upstream resource
+	size_t chunksBytes() const;
+
+	static const size_t MAX_BLOCK_SIZE;
+	static const size_t MIN_CHUNK_SIZE;
+	static const size_t MAX_CHUNK_SIZE;
+
+protected:
+	void* do_allocate(size_t bytes, size_t alignment) override;
+	void do_deallocate(void* pointer, size_t bytes, size_t alignment) override;
+	bool do_is_equal(std::pmr::memory_resource const& other) const noexcept override;
+
+private:
+	static const size_t GRANULARITY = 16;
+	static const size_t SIZE_CLASSES_COUNT = 32;
+
+	static bool isBlock(size_t bytes, size_t alignment);
+	void* allocateFromChunk(size_t size);
+
+	std::pmr::memory_resource* _upstream;
+	// freed blocks of each size class are linked through their first bytes
+	std::array<void*, SIZE_CLASSES_COUNT> _freeBlocks = {};
+	std::vector<std::pair<void*, size_t>> _chunks;
+	char* _chunkPosition = nullptr;
+	char* _chunkEnd = nullptr;
+	size_t _chunksBytes = 0;
+};
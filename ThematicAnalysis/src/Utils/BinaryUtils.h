@@ -0,0 +1,85 @@
+﻿#pragma once
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+/**
+ * \brief values and arrays of trivially copyable types in the byte order of the machine,
+ * arrays and strings are prefixed by their 64-bit size. Reading throws std::runtime_error when the stream ends
+ */
+class BinaryUtils
+{
+public:
+	template <typename T>
+	static void write(std::ostream& out, T const& value)
+	{
+		static_assert(std::is_trivially_copyable_v<T>);
+		out.write(reinterpret_cast<char const*>(&value), sizeof(T));
+	}
+
+	template <typename T>
+	static void writeVector(std::ostream& out, std::vector<T> const& values)
+	{
+		static_assert(std::is_trivially_copyable_v<T>);
+		write<uint64_t>(out, values.size());
+		out.write(reinterpret_cast<char const*>(values.data()), static_cast<std::streamsize>(values.size() * sizeof(T)));
+	}
+
+	static void writeString(std::ostream& out, std::string const& str)
+	{
+		write<uint64_t>(out, str.size());
+		out.write(str.data(), static_cast<std::streamsize>(str.size()));
+	}
+
+	template <typename T>
+	static T read(std::istream& in)
+	{
+		static_assert(std::is_trivially_copyable_v<T>);
+		T value;
+		readBytes(in, reinterpret_cast<char*>(&value), sizeof(T));
+		return value;
+	}
+
+	template <typename T>
+	static std::vector<T> readVector(std::istream& in)
+	{
+		static_assert(std::is_trivially_copyable_v<T>);
+		std::vector<T> values(readSize(in, sizeof(T)));
+		readBytes(in, reinterpret_cast<char*>(values.data()), values.size() * sizeof(T));
+		return values;
+	}
+
+	static std::string readString(std::istream& in)
+	{
+		std::string str(readSize(in, 1), '\0');
+		readBytes(in, str.data(), str.size());
+		return str;
+	}
+
+private:
+	static void readBytes(std::istream& in, char* data, size_t size)
+	{
+		if (!in.read(data, static_cast<std::streamsize>(size)))
+			throw std::runtime_error("Unexpected end of binary data");
+	}
+
+	// a broken size isn't allocated
+	static size_t readSize(std::istream& in, size_t elementSize)
+	{
+		auto size = read<uint64_t>(in);
+		auto position = in.tellg();
+		if (position != std::istream::pos_type(-1))
+		{
+			in.seekg(0, std::ios::end);
+			auto end = in.tellg();
+			in.seekg(position);
+			if (end != std::istream::pos_type(-1) && static_cast<uint64_t>(end - position) / elementSize < size)
+				throw std::runtime_error("Unexpected end of binary data");
+		}
+		return static_cast<size_t>(size);
+	}
+};
@@ -0,0 +1,155 @@
+﻿#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+/**
+ * \brief lock-free ring buffer for one producer and one consumer. Producer waits while the queue is full
+ * (back-pressure), consumer waits while it's empty. Depth and waiting times are measured for pipeline metrics
+ */
+template<typename T>
+class BoundedQueue
+{
+public:
+	explicit BoundedQueue(size_t capacity);
+	BoundedQueue(BoundedQueue const&) = delete;
+	BoundedQueue& operator=(BoundedQueue const&) = delete;
+
+	// return false when the queue is cancelled
+	bool push(T item);
+	// return false when the queue is closed and empty or it's cancelled
+	bool pop(T& item);
+	// producer has no more items
+	void close();
+	// consumer and producer stop waiting, e.g. when the other side failed
+	void cancel();
+
+	size_t size() const;
+	size_t capacity() const;
+	size_t maxSize() const;
+	double averageSize() const;
+	double pushWaitingSeconds() const;
+	double popWaitingSeconds() const;
+
+private:
+	template<typename Condition>
+	static double waitFor(Condition const& condition);
+
+	std::vector<T> _items;
+	std::atomic<size_t> _head = 0;	// count of popped items
+	std::atomic<size_t> _tail = 0;	// count of pushed items
+	std::atomic<bool> _isClosed = false;
+	std::atomic<bool> _isCancelled = false;
+
+	// changed by producer
+	size_t _maxSize = 0;
+	size_t _sizesSum = 0;
+	double _pushWaitingSeconds = 0;
+	// changed by consumer
+	double _popWaitingSeconds = 0;
+};
+
+template<typename T>
+BoundedQueue<T>::BoundedQueue(size_t capacity) : _items(std::max<size_t>(capacity, 1))
+{
+}
+
+/**
+ * \brief spin a little, then sleep: stages of pipelines handle large batches, so latency of waking isn't important
+ */
+template<typename T>
+template<typename Condition>
+double BoundedQueue<T>::waitFor(Condition const& condition)
+{
+	if (condition())
+		return 0;
+	auto start = std::chrono::steady_clock::now();
+	for (size_t i = 0; !condition(); i++)
+	{
+		if (i < 64)
+			std::this_thread::yield();
+		else
+			std::this_thread::sleep_for(std::chrono::microseconds(100));
+	}
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+template<typename T>
+bool BoundedQueue<T>::push(T item)
+{
+	auto tail = _tail.load(std::memory_order_relaxed);
+	_pushWaitingSeconds += waitFor([this, tail] {return tail - _head.load(std::memory_order_acquire) < _items.size() || _isCancelled; });
+	if (_isCancelled)
+		return false;
+	_items[tail % _items.size()] = std::move(item);
+	_tail.store(tail + 1, std::memory_order_release);
+
+	auto size = tail + 1 - _head.load(std::memory_order_acquire);
+	_maxSize = std::max(_maxSize, size);
+	_sizesSum += size;
+	return true;
+}
+
+template<typename T>
+bool BoundedQueue<T>::pop(T& item)
+{
+	auto head = _head.load(std::memory_order_relaxed);
+	_popWaitingSeconds += waitFor([this, head] {return _tail.load(std::memory_order_acquire) != head || _isClosed || _isCancelled; });
+	if (_isCancelled || _tail.load(std::memory_order_acquire) == head)
+		return false;
+	item = std::move(_items[head % _items.size()]);
+	_head.store(head + 1, std::memory_order_release);
+	return true;
+}
+
+template<typename T>
+void BoundedQueue<T>::close()
+{
+	_isClosed = true;
+}
+
+template<typename T>
+void BoundedQueue<T>::cancel()
+{
+	_isCancelled = true;
+}
+
+template<typename T>
+size_t BoundedQueue<T>::size() const
+{
+	return _tail.load(std::memory_order_acquire) - _head.load(std::memory_order_acquire);
+}
+
+template<typename T>
+size_t BoundedQueue<T>::capacity() const
+{
+	return _items.size();
+}
+
+template<typename T>
+size_t BoundedQueue<T>::maxSize() const
+{
+	return _maxSize;
+}
+
+// size after each push
+template<typename T>
+double BoundedQueue<T>::averageSize() const
+{
+	auto pushesCount = _tail.load(std::memory_order_acquire);
+	return pushesCount == 0 ? 0. : static_cast<double>(_sizesSum) / static_cast<double>(pushesCount);
+}
+
+template<typename T>
+double BoundedQueue<T>::pushWaitingSeconds() const
+{
+	return _pushWaitingSeconds;
+}
+
+template<typename T>
+double BoundedQueue<T>::popWaitingSeconds() const
+{
+	return _popWaitingSeconds;
+}
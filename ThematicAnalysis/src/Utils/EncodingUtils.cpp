@@ -0,0 +1,213 @@
+﻿#include "EncodingUtils.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+
+// unicode code points of cp1251 chars 0x80-0xFF
+constexpr std::array<uint16_t, 128> CP1251_HIGH_CHARS = {
+	0x0402, 0x0403, 0x201A, 0x0453, 0x201E, 0x2026, 0x2020, 0x2021, 0x20AC, 0x2030, 0x0409, 0x2039, 0x040A, 0x040C, 0x040B, 0x040F,
+	0x0452, 0x2018, 0x2019, 0x201C, 0x201D, 0x2022, 0x2013, 0x2014, 0x0098, 0x2122, 0x0459, 0x203A, 0x045A, 0x045C, 0x045B, 0x045F,
+	0x00A0, 0x040E, 0x045E, 0x0408, 0x00A4, 0x0490, 0x00A6, 0x00A7, 0x0401, 0x00A9, 0x0404, 0x00AB, 0x00AC, 0x00AD, 0x00AE, 0x0407,
+	0x00B0, 0x00B1, 0x0406, 0x0456, 0x0491, 0x00B5, 0x00B6, 0x00B7, 0x0451, 0x2116, 0x0454, 0x00BB, 0x0458, 0x0405, 0x0455, 0x0457,
+	0x0410, 0x0411, 0x0412, 0x0413, 0x0414, 0x0415, 0x0416, 0x0417, 0x0418, 0x0419, 0x041A, 0x041B, 0x041C, 0x041D, 0x041E, 0x041F,
+	0x0420, 0x0421, 0x0422, 0x0423, 0x0424, 0x0425, 0x0426, 0x0427, 0x0428, 0x0429, 0x042A, 0x042B, 0x042C, 0x042D, 0x042E, 0x042F,
+	0x0430, 0x0431, 0x0432, 0x0433, 0x0434, 0x0435, 0x0436, 0x0437, 0x0438, 0x0439, 0x043A, 0x043B, 0x043C, 0x043D, 0x043E, 0x043F,
+	0x0440, 0x0441, 0x0442, 0x0443, 0x0444, 0x0445, 0x0446, 0x0447, 0x0448, 0x0449, 0x044A, 0x044B, 0x044C, 0x044D, 0x044E, 0x044F,
+};
+
+constexpr uint64_t HIGH_BITS = 0x8080808080808080ull;
+constexpr char UNKNOWN_CHAR = '?';
+
+uint32_t toUnicode(unsigned char c)
+{
+	return c < 0x80 ? c : CP1251_HIGH_CHARS[c - 0x80];
+}
+
+/**
+ * \brief all tables are built once from the code points of cp1251 chars
+ */
+struct EncodingTables
+{
+	struct UTF8Char
+	{
+		uint8_t size;
+		char bytes[EncodingUtils::MAX_UTF8_CHAR_SIZE];
+	};
+	std::array<UTF8Char, 256> utf8Chars{};
+	// sorted pairs of code point and cp1251 char for chars 0x80-0xFF
+	std::array<std::pair<uint32_t, char>, 128> cp1251Chars{};
+	std::array<bool, 256> letters{};
+	std::array<char, 256> lowerChars{};
+	// cp1251 chars for code points below 0x800 (one or two UTF-8 bytes)
+	std::array<char, 0x800> twoBytesChars{};
+
+	EncodingTables()
+	{
+		for (size_t i = 0; i < 256; i++)
+		{
+			auto code = toUnicode(static_cast<unsigned char>(i));
+			auto& utf8 = utf8Chars[i];
+			if (code < 0x80)
+				utf8 = { 1, { static_cast<char>(code) } };
+			else if (code < 0x800)
+				utf8 = { 2, { static_cast<char>(0xC0 | code >> 6), static_cast<char>(0x80 | (code & 0x3F)) } };
+			else
+				utf8 = { 3, { static_cast<char>(0xE0 | code >> 12), static_cast<char>(0x80 | (code >> 6 & 0x3F)), static_cast<char>(0x80 | (code & 0x3F)) } };
+			if (i >= 0x80)
+				cp1251Chars[i - 0x80] = { code, static_cast<char>(i) };
+			letters[i] = (code >= 'A' && code <= 'Z') || (code >= 'a' && code <= 'z') || (code >= 0x400 && code < 0x500) || code == 0xB5;
+		}
+		std::sort(cp1251Chars.begin(), cp1251Chars.end());
+		twoBytesChars.fill(UNKNOWN_CHAR);
+		for (size_t i = 0; i < 256; i++)
+			if (toUnicode(static_cast<unsigned char>(i)) < twoBytesChars.size())
+				twoBytesChars[toUnicode(static_cast<unsigned char>(i))] = static_cast<char>(i);
+		for (size_t i = 0; i < 256; i++)
+		{
+			auto code = toUnicode(static_cast<unsigned char>(i));
+			if ((code >= 'A' && code <= 'Z') || (code >= 0x410 && code < 0x430))
+				code += 0x20;
+			else if (code >= 0x400 && code < 0x410)
+				code += 0x50;
+			else if (code == 0x490)
+				code = 0x491;
+			lowerChars[i] = toCp1251(code);
+		}
+	}
+
+	char toCp1251(uint32_t code) const
+	{
+		if (code < twoBytesChars.size())
+			return twoBytesChars[code];
+		auto it = std::lower_bound(cp1251Chars.begin(), cp1251Chars.end(), code, [](auto const& pair, uint32_t code) {return pair.first < code; });
+		return it != cp1251Chars.end() && it->first == code ? it->second : UNKNOWN_CHAR;
+	}
+};
+
+EncodingTables const& getTables()
+{
+	static const EncodingTables tables;
+	return tables;
+}
+
+/**
+ * \brief check if next 8 chars are ASCII, so they can be copied at once
+ */
+bool isASCIIBlock(char const* text)
+{
+	uint64_t block;
+	std::memcpy(&block, text, sizeof(block));
+	return (block & HIGH_BITS) == 0;
+}
+
+size_t EncodingUtils::cp1251ToUTF8(std::string_view text, char* output)
+{
+	auto const& utf8Chars = getTables().utf8Chars;
+	auto const begin = output;
+	size_t i = 0;
+	while (i < text.size())
+	{
+		if (i + sizeof(uint64_t) <= text.size() && isASCIIBlock(text.data() + i))
+		{
+			std::memcpy(output, text.data() + i, sizeof(uint64_t));
+			output += sizeof(uint64_t), i += sizeof(uint64_t);
+			continue;
+		}
+		auto const& utf8 = utf8Chars[static_cast<unsigned char>(text[i++])];
+		std::memcpy(output, utf8.bytes, MAX_UTF8_CHAR_SIZE);
+		output += utf8.size;
+	}
+	return static_cast<size_t>(output - begin);
+}
+
+std::string EncodingUtils::cp1251ToUTF8(std::string_view text)
+{
+	std::string result(text.size() * MAX_UTF8_CHAR_SIZE, '\0');
+	result.resize(cp1251ToUTF8(text, result.data()));
+	return result;
+}
+
+/**
+ * \brief decode one multibyte sequence, return its size (1 for invalid sequence)
+ */
+size_t decodeUTF8(unsigned char const* text, size_t size, uint32_t& code)
+{
+	auto first = text[0];
+	size_t length = (first & 0xE0) == 0xC0 ? 2 : (first & 0xF0) == 0xE0 ? 3 : (first & 0xF8) == 0xF0 ? 4 : 0;
+	if (length == 0 || length > size)
+		return code = UNKNOWN_CHAR, 1;
+	code = first & (0x7F >> length);
+	for (size_t i = 1; i < length; i++)
+	{
+		if ((text[i] & 0xC0) != 0x80)
+			return code = UNKNOWN_CHAR, 1;
+		code = code << 6 | (text[i] & 0x3F);
+	}
+	return length;
+}
+
+size_t EncodingUtils::UTF8ToCp1251(std::string_view text, char* output)
+{
+	auto const& tables = getTables();
+	auto const begin = output;
+	auto const data = reinterpret_cast<unsigned char const*>(text.data());
+	size_t i = 0;
+	while (i < text.size())
+	{
+		if (i + sizeof(uint64_t) <= text.size() && isASCIIBlock(text.data() + i))
+		{
+			std::memmove(output, text.data() + i, sizeof(uint64_t));
+			output += sizeof(uint64_t), i += sizeof(uint64_t);
+			continue;
+		}
+		auto c = data[i];
+		if (c < 0x80)
+		{
+			*output++ = static_cast<char>(c);
+			i++;
+		}
+		// two bytes sequences (all cyrillic letters) are converted by the table
+		else if ((c & 0xE0) == 0xC0 && i + 1 < text.size() && (data[i + 1] & 0xC0) == 0x80)
+		{
+			*output++ = tables.twoBytesChars[(c & 0x1F) << 6 | (data[i + 1] & 0x3F)];
+			i += 2;
+		}
+		else
+		{
+			uint32_t code;
+			i += decodeUTF8(data + i, text.size() - i, code);
+			*output++ = tables.toCp1251(code);
+		}
+	}
+	return static_cast<size_t>(output - begin);
+}
+
+std::string EncodingUtils::UTF8ToCp1251(std::string_view text)
+{
+	std::string result(text.size(), '\0');
+	result.resize(UTF8ToCp1251(text, result.data()));
+	return result;
+}
+
+void EncodingUtils::UTF8ToCp1251InPlace(std::string& text)
+{
+	text.resize(UTF8ToCp1251(text, text.data()));
+}
+
+bool EncodingUtils::isLetter(char c)
+{
+	return getTables().letters[static_cast<unsigned char>(c)];
+}
+
+bool EncodingUtils::isLetterOrDigit(char c)
+{
+	return (c >= '0' && c <= '9') || isLetter(c);
+}
+
+char EncodingUtils::toLower(char c)
+{
+	return getTables().lowerChars[static_cast<unsigned char>(c)];
+}
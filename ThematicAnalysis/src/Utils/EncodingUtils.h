@@ -0,0 +1,27 @@
+﻿#pragma once
+#include <string>
+#include <string_view>
+
+/**
+ * \brief table-driven conversions between cp1251 and UTF-8 and classification of cp1251 chars
+ * (doesn't depend on installed locales)
+ */
+class EncodingUtils
+{
+public:
+	// max count of UTF-8 bytes for one cp1251 char
+	static const size_t MAX_UTF8_CHAR_SIZE = 3;
+
+	// output must have place for text.size() * MAX_UTF8_CHAR_SIZE chars, return count of written chars
+	static size_t cp1251ToUTF8(std::string_view text, char* output);
+	static std::string cp1251ToUTF8(std::string_view text);
+	// output must have place for text.size() chars and may be equal to text.data() (in-place conversion),
+	// chars missing in cp1251 and invalid sequences are replaced with '?', return count of written chars
+	static size_t UTF8ToCp1251(std::string_view text, char* output);
+	static std::string UTF8ToCp1251(std::string_view text);
+	static void UTF8ToCp1251InPlace(std::string& text);
+
+	static bool isLetter(char c);
+	static bool isLetterOrDigit(char c);
+	static char toLower(char c);
+};
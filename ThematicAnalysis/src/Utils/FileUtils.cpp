@@ -1,13 +1,17 @@
 ﻿#include "FileUtils.h"
 
-#include <Windows.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <sstream>
+#include <stdexcept>
 #include <fstream>
-#include <cstdio>
 #include <filesystem>
-#include <memory>
+#include <iterator>
 #include <string>
-#include <array>
+
+#include "EncodingUtils.h"
+#include "StringUtils.h"
 
 
 std::string FileUtils::readAllFile(const std::ifstream& fin)
@@ -19,47 +23,31 @@ std::string FileUtils::readAllFile(const std::ifstream& fin)
 
 
 
+/**
+ * \brief file is read at once into the string of its size, line ends are converted as in text mode
+ */
 std::string FileUtils::readAllFile(std::string const& filePath)
 {
-	std::ifstream fin(filePath);
-	auto text = readAllFile(fin);
-	fin.close();
+	std::ifstream fin(filePath, std::ios::binary | std::ios::ate);
+	if (!fin.is_open()) return {};
+	std::string text(static_cast<size_t>(fin.tellg()), '\0');
+	fin.seekg(0);
+	fin.read(text.data(), static_cast<std::streamsize>(text.size()));
+	text.resize(static_cast<size_t>(fin.gcount()));
+#ifdef _WIN32
+	auto textEnd = text.begin();
+	for (auto it = text.begin(); it != text.end(); ++it)
+		if (*it != '\r' || std::next(it) == text.end() || *std::next(it) != '\n')
+			*textEnd++ = *it;
+	text.erase(textEnd, text.end());
+#endif
 	return text;
 }
 
-std::string convertEncodings(std::string const& str, UINT encodingFrom, UINT encodingTo)
-{
-		auto wsize = MultiByteToWideChar(encodingFrom, 0, str.c_str(), -1, nullptr, 0);
-	auto wres = new WCHAR[wsize];
-	MultiByteToWideChar(encodingFrom, 0, str.c_str(), -1, wres, wsize);
-
-	auto usize = WideCharToMultiByte(encodingTo, 0, wres, -1, nullptr, 0, nullptr, nullptr);
-	auto ures = new char[usize];
-	WideCharToMultiByte(encodingTo, 0, wres, -1, ures, usize, nullptr, nullptr);
-	std::string res = ures;
-
-	delete[] ures;
-	delete[] wres;
-
-	return res;
-}
-
-
-std::string UTF8ToCp1251(const std::string& str)
-{
-	return convertEncodings(str, CP_UTF8, 1251);
-}
-
-std::string cp1251ToUTF8(const std::string& str)
-{
-		return convertEncodings(str, 1251, CP_UTF8);
-
-}
-
 std::string FileUtils::readAllUTF8File(std::string const& filePath)
 {
 	auto text = readAllFile(filePath);
-	text = UTF8ToCp1251(text);
+	EncodingUtils::UTF8ToCp1251InPlace(text);
 	return text;
 }
 
@@ -67,7 +55,7 @@ void FileUtils::writeUTF8ToFile(std::string const& filePath, std::string const&
 {
 	std::ofstream fout(filePath);
 	fout.imbue(std::locale(""));
-	auto wtext = cp1251ToUTF8(text);
+	auto wtext = EncodingUtils::cp1251ToUTF8(text);
 	fout << wtext;
 	fout.close();
 }
@@ -80,18 +68,38 @@ void FileUtils::writeToFile(std::string const& filePath, std::string const& text
 	fout.close();
 }
 
+std::string FileUtils::getTemporaryPath(std::string const& extension)
+{
+	static std::atomic<size_t> filesCount = 0;
+	auto name = "ThematicAnalysis_" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count())
+		+ "_" + std::to_string(filesCount++) + extension;
+	return (std::filesystem::temp_directory_path() / name).string();
+}
+
 bool FileUtils::executeExeWithParams(std::string exe, std::string params, std::string& output)
 {
-		if(!std::filesystem::exists(exe)) return false;
-		auto cmd = exe + " " + params;
-		std::array<char, 128> buffer;
-		std::unique_ptr<FILE, decltype(&_pclose)> pipe(_popen(cmd.c_str(), "r"), _pclose);
-		if (pipe == nullptr) {
-			return false;
-		}
-		while (fgets(buffer.data(), buffer.size(), pipe.get()) != nullptr) {
-			output += buffer.data();
-		}
+	if (!std::filesystem::exists(exe)) return false;
+	try
+	{
+		ProcessRunner::run(exe, StringUtils::split(params, " ", true), output);
+	}
+	catch (std::runtime_error const&)
+	{
+		return false;
+	}
+	return true;
+}
 
-		return true;
+bool FileUtils::executeExeWithParams(std::string const& exe, std::vector<std::string> const& args, ProcessRunner::OutputHandler const& onOutput)
+{
+	if (!std::filesystem::exists(exe)) return false;
+	try
+	{
+		ProcessRunner::run(exe, args, onOutput);
+	}
+	catch (std::runtime_error const&)
+	{
+		return false;
+	}
+	return true;
 }
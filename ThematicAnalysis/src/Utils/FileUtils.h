@@ -1,5 +1,8 @@
 ﻿#pragma once
 #include <string>
+#include <vector>
+
+#include "ProcessRunner.h"
 
 class FileUtils
 {
@@ -9,5 +12,9 @@ public:
 	static std::string readAllFile(std::string const& filePath);
 	static void writeUTF8ToFile(std::string const& filePath, std::string const& text);
 	static void writeToFile(std::string const& filePath, std::string const& text);
+	// unique path of a file in the temporary directory, the file isn't created
+	static std::string getTemporaryPath(std::string const& extension);
 	static bool executeExeWithParams(std::string exe, std::string params, std::string& output);
+	// output of the process is passed to the handler by chunks
+	static bool executeExeWithParams(std::string const& exe, std::vector<std::string> const& args, ProcessRunner::OutputHandler const& onOutput);
 };
@@ -0,0 +1,165 @@
+﻿#include "MappedFile.h"
+#include "Profiler.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+MappedFile::MappedFile(std::string const& filePath)
+{
+	_file = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (_file == INVALID_HANDLE_VALUE)
+	{
+		_file = nullptr;
+		throw std::runtime_error("Can't open file " + filePath);
+	}
+	LARGE_INTEGER fileSize;
+	GetFileSizeEx(_file, &fileSize);
+	_size = static_cast<size_t>(fileSize.QuadPart);
+	PROFILE_COUNT("bytesRead", _size);
+	if (_size == 0) return;
+
+	_mapping = CreateFileMappingA(_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (_mapping != nullptr)
+		_data = static_cast<char const*>(MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0));
+	if (_data == nullptr)
+		readAll(filePath);
+}
+
+void MappedFile::readAll(std::string const& filePath)
+{
+	_buffer.reset(new char[_size]);
+	size_t readCount = 0;
+	DWORD count = 0;
+	while (readCount < _size && ReadFile(_file, _buffer.get() + readCount, static_cast<DWORD>(std::min<size_t>(_size - readCount, MAXDWORD)), &count, nullptr) && count > 0)
+		readCount += count;
+	if (readCount != _size)
+	{
+		close();
+		throw std::runtime_error("Can't read file " + filePath);
+	}
+	_data = _buffer.get();
+}
+
+void MappedFile::close()
+{
+	if (_data != nullptr && _buffer == nullptr) UnmapViewOfFile(_data);
+	if (_mapping != nullptr) CloseHandle(_mapping);
+	if (_file != nullptr) CloseHandle(_file);
+	_data = nullptr, _mapping = nullptr, _file = nullptr;
+	_buffer.reset();
+	_size = 0;
+}
+#else
+MappedFile::MappedFile(std::string const& filePath)
+{
+	_file = ::open(filePath.c_str(), O_RDONLY);
+	if (_file < 0)
+		throw std::runtime_error("Can't open file " + filePath);
+	struct stat fileStat;
+	fstat(_file, &fileStat);
+	_size = static_cast<size_t>(fileStat.st_size);
+	PROFILE_COUNT("bytesRead", _size);
+	if (_size == 0) return;
+
+	auto data = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, _file, 0);
+	if (data == MAP_FAILED)
+	{
+		readAll(filePath);
+		return;
+	}
+	_data = static_cast<char const*>(data);
+	madvise(data, _size, MADV_SEQUENTIAL);
+}
+
+void MappedFile::readAll(std::string const& filePath)
+{
+	_buffer.reset(new char[_size]);
+	size_t readCount = 0;
+	while (readCount < _size)
+	{
+		auto count = ::read(_file, _buffer.get() + readCount, _size - readCount);
+		if (count > 0)
+			readCount += static_cast<size_t>(count);
+		else if (count == 0 || errno != EINTR)
+			break;
+	}
+	if (readCount != _size)
+	{
+		close();
+		throw std::runtime_error("Can't read file " + filePath);
+	}
+	_data = _buffer.get();
+}
+
+void MappedFile::close()
+{
+	if (_data != nullptr && _buffer == nullptr) munmap(const_cast<char*>(_data), _size);
+	if (_file >= 0) ::close(_file);
+	_data = nullptr, _file = -1;
+	_buffer.reset();
+	_size = 0;
+}
+#endif
+
+MappedFile::MappedFile(MappedFile&& other) noexcept :
+	_data(std::exchange(other._data, nullptr)),
+	_size(std::exchange(other._size, 0)),
+	_buffer(std::move(other._buffer)),
+#ifdef _WIN32
+	_file(std::exchange(other._file, nullptr)),
+	_mapping(std::exchange(other._mapping, nullptr))
+#else
+	_file(std::exchange(other._file, -1))
+#endif
+{
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+	if (this != &other)
+	{
+		close();
+		_data = std::exchange(other._data, nullptr);
+		_size = std::exchange(other._size, 0);
+		_buffer = std::move(other._buffer);
+#ifdef _WIN32
+		_file = std::exchange(other._file, nullptr);
+		_mapping = std::exchange(other._mapping, nullptr);
+#else
+		_file = std::exchange(other._file, -1);
+#endif
+	}
+	return *this;
+}
+
+MappedFile::~MappedFile()
+{
+	close();
+}
+
+std::string_view MappedFile::view() const
+{
+	return { _data, _size };
+}
+
+size_t MappedFile::size() const
+{
+	return _size;
+}
+
+bool MappedFile::isMapped() const
+{
+	return _data != nullptr && _buffer == nullptr;
+}
@@ -0,0 +1,38 @@
+﻿#pragma once
+#include <memory>
+#include <string>
+#include <string_view>
+
+/**
+ * \brief read-only file mapped into memory, when mapping isn't supported (e.g. for pipes or some file systems)
+ * the file is read into a buffer at once
+ */
+class MappedFile
+{
+public:
+	// throw std::runtime_error when file can't be opened or mapped
+	explicit MappedFile(std::string const& filePath);
+	MappedFile(MappedFile&& other) noexcept;
+	MappedFile& operator=(MappedFile&& other) noexcept;
+	MappedFile(MappedFile const&) = delete;
+	MappedFile& operator=(MappedFile const&) = delete;
+	~MappedFile();
+
+	std::string_view view() const;
+	size_t size() const;
+	bool isMapped() const;
+
+private:
+	void close();
+	void readAll(std::string const& filePath);
+
+	char const* _data = nullptr;
+	size_t _size = 0;
+	std::unique_ptr<char[]> _buffer;
+#ifdef _WIN32
+	void* _file = nullptr;
+	void* _mapping = nullptr;
+#else
+	int _file = -1;
+#endif
+};
@@ -0,0 +1,23 @@
+﻿#include "MemoryStreamBuf.h"
+
+MemoryStreamBuf::MemoryStreamBuf(std::string_view data)
+{
+	// get area is never written by std::istream
+	auto begin = const_cast<char*>(data.data());
+	setg(begin, begin, begin + data.size());
+}
+
+MemoryStreamBuf::pos_type MemoryStreamBuf::seekoff(off_type offset, std::ios_base::seekdir direction, std::ios_base::openmode mode)
+{
+	auto base = direction == std::ios_base::beg ? eback() : direction == std::ios_base::cur ? gptr() : egptr();
+	auto position = base - eback() + offset;
+	if (!(mode & std::ios_base::in) || position < 0 || position > egptr() - eback())
+		return pos_type(off_type(-1));
+	setg(eback(), eback() + position, egptr());
+	return pos_type(position);
+}
+
+MemoryStreamBuf::pos_type MemoryStreamBuf::seekpos(pos_type position, std::ios_base::openmode mode)
+{
+	return seekoff(off_type(position), std::ios_base::beg, mode);
+}
@@ -0,0 +1,17 @@
+﻿#pragma once
+#include <streambuf>
+#include <string_view>
+
+/**
+ * \brief read-only stream buffer over memory (e.g. mapped file), so std::istream reads it without copying
+ */
+class MemoryStreamBuf : public std::streambuf
+{
+public:
+	explicit MemoryStreamBuf(std::string_view data);
+
+protected:
+	// positions are offsets from the beginning of the data
+	pos_type seekoff(off_type offset, std::ios_base::seekdir direction, std::ios_base::openmode mode) override;
+	pos_type seekpos(pos_type position, std::ios_base::openmode mode) override;
+};
@@ -0,0 +1,86 @@
+﻿#pragma once
+#include <memory>
+#include <memory_resource>
+#include <type_traits>
+#include <utility>
+
+#include "ArenaResource.h"
+
+/**
+ * \brief allocator of a memory pool shared by the allocator copies, the pool lives while they do.
+ * Unlike std::pmr::polymorphic_allocator it's propagated on move assignment and swap, so containers are moved
+ * without moving their elements, and copies of containers allocate from the default resource unless
+ * they are given an allocator. Elements are constructed by std::pmr::polymorphic_allocator of the same pool,
+ * so their std::pmr containers allocate from the pool too
+ */
+template<typename T>
+class PoolAllocator
+{
+public:
+	using value_type = T;
+	using propagate_on_container_copy_assignment = std::false_type;
+	using propagate_on_container_move_assignment = std::true_type;
+	using propagate_on_container_swap = std::true_type;
+
+	// allocates from std::pmr::new_delete_resource
+	PoolAllocator() noexcept = default;
+	explicit PoolAllocator(std::shared_ptr<std::pmr::memory_resource> resource) noexcept : _resource(std::move(resource))
+	{
+	}
+	template<typename U>
+	PoolAllocator(PoolAllocator<U> const& other) noexcept : _resource(other.sharedResource())
+	{
+	}
+
+	// the pool isn't synchronized, so containers in it must be changed by one thread at a time
+	static PoolAllocator createPool()
+	{
+		return PoolAllocator(std::make_shared<ArenaResource>());
+	}
+
+	T* allocate(size_t count)
+	{
+		return static_cast<T*>(resource()->allocate(count * sizeof(T), alignof(T)));
+	}
+
+	void deallocate(T* pointer, size_t count) noexcept
+	{
+		resource()->deallocate(pointer, count * sizeof(T), alignof(T));
+	}
+
+	template<typename U, typename... Args>
+	void construct(U* pointer, Args&&... args)
+	{
+		std::pmr::polymorphic_allocator<U>(resource()).construct(pointer, std::forward<Args>(args)...);
+	}
+
+	PoolAllocator select_on_container_copy_construction() const noexcept
+	{
+		return PoolAllocator();
+	}
+
+	std::pmr::memory_resource* resource() const noexcept
+	{
+		return _resource ? _resource.get() : std::pmr::new_delete_resource();
+	}
+
+	std::shared_ptr<std::pmr::memory_resource> const& sharedResource() const noexcept
+	{
+		return _resource;
+	}
+
+private:
+	std::shared_ptr<std::pmr::memory_resource> _resource;
+};
+
+template<typename T, typename U>
+bool operator==(PoolAllocator<T> const& first, PoolAllocator<U> const& second) noexcept
+{
+	return first.resource() == second.resource();
+}
+
+template<typename T, typename U>
+bool operator!=(PoolAllocator<T> const& first, PoolAllocator<U> const& second) noexcept
+{
+	return !(first == second);
+}
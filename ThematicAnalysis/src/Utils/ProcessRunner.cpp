@@ -0,0 +1,90 @@
+﻿#include "ProcessRunner.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <memory>
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <cstdlib>
+#else
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+extern char** environ;
+#endif
+
+const size_t ProcessRunner::DEFAULT_BUFFER_SIZE = 64 * 1024;
+
+#ifdef _WIN32
+std::string quoteArgument(std::string const& arg)
+{
+	return arg.find_first_of(" \t") == std::string::npos ? arg : '"' + arg + '"';
+}
+
+/**
+ * \brief output of the pipe is read by large blocks
+ */
+int ProcessRunner::run(std::string const& exe, std::vector<std::string> const& args, OutputHandler const& onOutput, size_t bufferSize)
+{
+	auto cmd = quoteArgument(exe);
+	for (auto const& arg : args)
+		cmd += ' ' + quoteArgument(arg);
+	FILE* pipe = _popen(cmd.c_str(), "r");
+	if (pipe == nullptr)
+		throw std::runtime_error("Can't run " + exe);
+	std::unique_ptr<char[]> buffer(new char[bufferSize]);
+	size_t count;
+	while ((count = fread(buffer.get(), 1, bufferSize, pipe)) > 0)
+		onOutput({ buffer.get(), count });
+	return _pclose(pipe);
+}
+#else
+int ProcessRunner::run(std::string const& exe, std::vector<std::string> const& args, OutputHandler const& onOutput, size_t bufferSize)
+{
+	int pipeEnds[2];
+	if (pipe(pipeEnds) != 0)
+		throw std::runtime_error("Can't create pipe for " + exe);
+
+	posix_spawn_file_actions_t actions;
+	posix_spawn_file_actions_init(&actions);
+	posix_spawn_file_actions_addclose(&actions, pipeEnds[0]);
+	posix_spawn_file_actions_adddup2(&actions, pipeEnds[1], STDOUT_FILENO);
+	posix_spawn_file_actions_addclose(&actions, pipeEnds[1]);
+
+	std::vector<char*> argv = { const_cast<char*>(exe.c_str()) };
+	for (auto const& arg : args)
+		argv.push_back(const_cast<char*>(arg.c_str()));
+	argv.push_back(nullptr);
+
+	pid_t pid;
+	auto error = posix_spawn(&pid, exe.c_str(), &actions, nullptr, argv.data(), environ);
+	posix_spawn_file_actions_destroy(&actions);
+	close(pipeEnds[1]);
+	if (error != 0)
+	{
+		close(pipeEnds[0]);
+		throw std::runtime_error("Can't run " + exe);
+	}
+
+	std::unique_ptr<char[]> buffer(new char[bufferSize]);
+	ssize_t count;
+	while ((count = read(pipeEnds[0], buffer.get(), bufferSize)) != 0)
+	{
+		if (count > 0)
+			onOutput({ buffer.get(), static_cast<size_t>(count) });
+		else if (errno != EINTR)
+			break;
+	}
+	close(pipeEnds[0]);
+
+	int status = 0;
+	while (waitpid(pid, &status, 0) < 0 && errno == EINTR);
+	return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+#endif
+
+int ProcessRunner::run(std::string const& exe, std::vector<std::string> const& args, std::string& output)
+{
+	return run(exe, args, [&output](std::string_view chunk) {output.append(chunk); });
+}
@@ -0,0 +1,23 @@
+﻿#pragma once
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * \brief runs a process and streams its standard output to the caller
+ */
+class ProcessRunner
+{
+public:
+	// chunk is valid only inside the handler call
+	using OutputHandler = std::function<void(std::string_view chunk)>;
+	static const size_t DEFAULT_BUFFER_SIZE;
+
+	// return exit code of the process
+	// throw std::runtime_error when process can't be started
+	static int run(std::string const& exe, std::vector<std::string> const& args, OutputHandler const& onOutput,
+		size_t bufferSize = DEFAULT_BUFFER_SIZE);
+	// output is appended to the string
+	static int run(std::string const& exe, std::vector<std::string> const& args, std::string& output);
+};
@@ -0,0 +1,413 @@
+﻿#include "Profiler.h"
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+std::atomic<bool> Profiler::_isEnabled = false;
+thread_local size_t Profiler::_currentScope = Profiler::NO_SCOPE;
+
+const size_t BUCKETS_COUNT = 65;
+
+/**
+ * \brief values are written by one thread only, so a load and a store are enough, atomics make reading
+ * from other threads safe
+ */
+void addRelaxed(std::atomic<uint64_t>& value, uint64_t delta)
+{
+	value.store(value.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+}
+
+/**
+ * \brief 0 for 0, otherwise 1 + index of the highest set bit, so bucket i > 0 holds values in [2^(i-1), 2^i)
+ */
+size_t getBucketIndex(uint64_t value)
+{
+	if (value == 0) return 0;
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanReverse64(&index, value);
+	return index + 1;
+#else
+	return static_cast<size_t>(64 - __builtin_clzll(value));
+#endif
+}
+
+struct HistogramValues
+{
+	std::atomic<uint64_t> count = 0;
+	std::atomic<uint64_t> sum = 0;
+	std::atomic<uint64_t> min = std::numeric_limits<uint64_t>::max();
+	std::atomic<uint64_t> max = 0;
+	std::array<std::atomic<uint64_t>, BUCKETS_COUNT> buckets = {};
+
+	void add(uint64_t value)
+	{
+		addRelaxed(count, 1);
+		addRelaxed(sum, value);
+		if (value < min.load(std::memory_order_relaxed)) min.store(value, std::memory_order_relaxed);
+		if (value > max.load(std::memory_order_relaxed)) max.store(value, std::memory_order_relaxed);
+		addRelaxed(buckets[getBucketIndex(value)], 1);
+	}
+
+	// the other histogram must not be changed meanwhile
+	void merge(HistogramValues const& other)
+	{
+		addRelaxed(count, other.count.load(std::memory_order_relaxed));
+		addRelaxed(sum, other.sum.load(std::memory_order_relaxed));
+		min.store(std::min(min.load(std::memory_order_relaxed), other.min.load(std::memory_order_relaxed)), std::memory_order_relaxed);
+		max.store(std::max(max.load(std::memory_order_relaxed), other.max.load(std::memory_order_relaxed)), std::memory_order_relaxed);
+		for (size_t i = 0; i < BUCKETS_COUNT; i++)
+			addRelaxed(buckets[i], other.buckets[i].load(std::memory_order_relaxed));
+	}
+
+	void clear()
+	{
+		count = 0, sum = 0, max = 0;
+		min = std::numeric_limits<uint64_t>::max();
+		for (auto& bucket : buckets)
+			bucket = 0;
+	}
+};
+
+struct ThreadValues
+{
+	std::array<HistogramValues, Profiler::MAX_HISTOGRAMS> histograms;
+	std::array<std::atomic<uint64_t>, Profiler::MAX_COUNTERS> counters = {};
+
+	void merge(ThreadValues const& other)
+	{
+		for (size_t i = 0; i < histograms.size(); i++)
+			histograms[i].merge(other.histograms[i]);
+		for (size_t i = 0; i < counters.size(); i++)
+			addRelaxed(counters[i], other.counters[i].load(std::memory_order_relaxed));
+	}
+
+	void clear()
+	{
+		for (auto& histogram : histograms)
+			histogram.clear();
+		for (auto& counter : counters)
+			counter = 0;
+	}
+};
+
+/**
+ * \brief names and values of live threads, values of finished threads are merged into retiredValues
+ */
+struct ProfilerRegistry
+{
+	std::mutex mutex;
+	std::vector<std::pair<std::string, Profiler::Kind>> histogramsNames;
+	std::vector<std::string> countersNames;
+	std::vector<ThreadValues*> threadsValues;
+	ThreadValues retiredValues;
+};
+
+// isn't destroyed, so threads may finish after static objects destruction
+ProfilerRegistry& getRegistry()
+{
+	static auto registry = new ProfilerRegistry();
+	return *registry;
+}
+
+class ThreadValuesHolder
+{
+public:
+	ThreadValuesHolder() : _values(new ThreadValues())
+	{
+		auto& registry = getRegistry();
+		std::lock_guard lock(registry.mutex);
+		registry.threadsValues.push_back(_values.get());
+	}
+	ThreadValuesHolder(ThreadValuesHolder const&) = delete;
+	ThreadValuesHolder& operator=(ThreadValuesHolder const&) = delete;
+	~ThreadValuesHolder()
+	{
+		auto& registry = getRegistry();
+		std::lock_guard lock(registry.mutex);
+		registry.retiredValues.merge(*_values);
+		registry.threadsValues.erase(std::find(registry.threadsValues.begin(), registry.threadsValues.end(), _values.get()));
+	}
+
+	ThreadValues& values() const
+	{
+		return *_values;
+	}
+
+private:
+	std::unique_ptr<ThreadValues> _values;
+};
+
+ThreadValues& getThreadValues()
+{
+	thread_local ThreadValuesHolder holder;
+	return holder.values();
+}
+
+std::string readProfilePathVariable()
+{
+	std::string value;
+#ifdef _WIN32
+	char* buffer = nullptr;
+	size_t size = 0;
+	if (_dupenv_s(&buffer, &size, "THEMATIC_ANALYSIS_PROFILE") == 0 && buffer != nullptr)
+	{
+		value = buffer;
+		free(buffer);
+	}
+#else
+	if (auto buffer = std::getenv("THEMATIC_ANALYSIS_PROFILE"))
+		value = buffer;
+#endif
+	return value;
+}
+
+/**
+ * \brief enables the profiler at start when THEMATIC_ANALYSIS_PROFILE is set and writes the report at exit.
+ * Thread pool is destroyed earlier, so values of its workers are already merged
+ */
+class ExitReporter
+{
+public:
+	ExitReporter() : _filePath(readProfilePathVariable())
+	{
+		if (!_filePath.empty())
+			Profiler::setEnabled(true);
+	}
+	~ExitReporter()
+	{
+		if (_filePath.empty()) return;
+		try
+		{
+			Profiler::dump(_filePath);
+		}
+		catch (std::exception const& e)
+		{
+			std::cerr << e.what() << std::endl;
+		}
+	}
+
+private:
+	std::string _filePath;
+};
+
+ExitReporter exitReporter;
+
+void Profiler::setEnabled(bool isEnabled)
+{
+	_isEnabled.store(isEnabled, std::memory_order_relaxed);
+}
+
+size_t Profiler::registerName(std::string const& name, Kind kind)
+{
+	auto& registry = getRegistry();
+	std::lock_guard lock(registry.mutex);
+	if (kind == Kind::Counter)
+	{
+		auto& names = registry.countersNames;
+		auto it = std::find(names.begin(), names.end(), name);
+		if (it != names.end())
+			return static_cast<size_t>(it - names.begin());
+		if (names.size() == MAX_COUNTERS)
+			throw std::logic_error("Too many profiler counters");
+		names.push_back(name);
+		return names.size() - 1;
+	}
+	auto& names = registry.histogramsNames;
+	auto it = std::find(names.begin(), names.end(), std::make_pair(name, kind));
+	if (it != names.end())
+		return static_cast<size_t>(it - names.begin());
+	if (names.size() == MAX_HISTOGRAMS)
+		throw std::logic_error("Too many profiler timers and histograms");
+	names.emplace_back(name, kind);
+	return names.size() - 1;
+}
+
+std::string Profiler::getName(size_t id)
+{
+	auto& registry = getRegistry();
+	std::lock_guard lock(registry.mutex);
+	if (id >= registry.histogramsNames.size())
+		throw std::logic_error("Profiler id isn't registered");
+	return registry.histogramsNames[id].first;
+}
+
+size_t Profiler::currentScope()
+{
+	return _currentScope;
+}
+
+size_t Profiler::setCurrentScope(size_t timerId)
+{
+	return std::exchange(_currentScope, timerId);
+}
+
+void Profiler::addValue(size_t id, uint64_t value)
+{
+	getThreadValues().histograms[id].add(value);
+}
+
+void Profiler::addToCounter(size_t id, uint64_t value)
+{
+	addRelaxed(getThreadValues().counters[id], value);
+}
+
+/**
+ * \brief the value is the upper bound of the bucket which contains the percentile, but not greater than max
+ */
+uint64_t estimatePercentile(HistogramValues const& values, double percentile)
+{
+	auto count = values.count.load(std::memory_order_relaxed);
+	auto rank = static_cast<uint64_t>(percentile * static_cast<double>(count));
+	uint64_t accumulated = 0;
+	for (size_t i = 0; i < BUCKETS_COUNT; i++)
+	{
+		accumulated += values.buckets[i].load(std::memory_order_relaxed);
+		if (accumulated > rank)
+		{
+			auto upperBound = i == 0 ? 0 : i == 64 ? std::numeric_limits<uint64_t>::max() : (uint64_t(1) << i) - 1;
+			return std::min(upperBound, values.max.load(std::memory_order_relaxed));
+		}
+	}
+	return values.max.load(std::memory_order_relaxed);
+}
+
+HistogramSummary summarize(std::string const& name, HistogramValues const& values)
+{
+	HistogramSummary summary;
+	summary.name = name;
+	summary.count = values.count.load(std::memory_order_relaxed);
+	if (summary.count == 0)
+		return summary;
+	summary.sum = values.sum.load(std::memory_order_relaxed);
+	summary.min = values.min.load(std::memory_order_relaxed);
+	summary.max = values.max.load(std::memory_order_relaxed);
+	summary.p50 = estimatePercentile(values, 0.5);
+	summary.p90 = estimatePercentile(values, 0.9);
+	summary.p99 = estimatePercentile(values, 0.99);
+	return summary;
+}
+
+ProfileReport Profiler::collect()
+{
+	auto& registry = getRegistry();
+	std::lock_guard lock(registry.mutex);
+	auto values = std::make_unique<ThreadValues>();
+	values->merge(registry.retiredValues);
+	for (auto threadValues : registry.threadsValues)
+		values->merge(*threadValues);
+
+	ProfileReport report;
+	for (size_t i = 0; i < registry.histogramsNames.size(); i++)
+	{
+		auto const& [name, kind] = registry.histogramsNames[i];
+		(kind == Kind::Timer ? report.timers : report.histograms).push_back(summarize(name, values->histograms[i]));
+	}
+	for (size_t i = 0; i < registry.countersNames.size(); i++)
+		report.counters.push_back({ registry.countersNames[i], values->counters[i].load(std::memory_order_relaxed) });
+	return report;
+}
+
+void Profiler::reset()
+{
+	auto& registry = getRegistry();
+	std::lock_guard lock(registry.mutex);
+	registry.retiredValues.clear();
+	for (auto threadValues : registry.threadsValues)
+		threadValues->clear();
+}
+
+void Profiler::dump(std::string const& filePath)
+{
+	std::ofstream out(filePath);
+	if (!out)
+		throw std::runtime_error("Can't write profile report " + filePath);
+	auto report = collect();
+	auto const jsonExtension = std::string(".json");
+	if (filePath.size() >= jsonExtension.size() && filePath.compare(filePath.size() - jsonExtension.size(), jsonExtension.size(), jsonExtension) == 0)
+		report.exportToJson(out);
+	else
+		report.exportToText(out);
+}
+
+double HistogramSummary::mean() const
+{
+	return count == 0 ? 0 : static_cast<double>(sum) / static_cast<double>(count);
+}
+
+HistogramSummary const* findSummary(std::vector<HistogramSummary> const& summaries, std::string const& name)
+{
+	auto it = std::find_if(summaries.begin(), summaries.end(), [&name](auto const& summary) {return summary.name == name; });
+	return it == summaries.end() ? nullptr : &*it;
+}
+
+HistogramSummary const* ProfileReport::findTimer(std::string const& name) const
+{
+	return findSummary(timers, name);
+}
+
+HistogramSummary const* ProfileReport::findHistogram(std::string const& name) const
+{
+	return findSummary(histograms, name);
+}
+
+uint64_t ProfileReport::getCounter(std::string const& name) const
+{
+	auto it = std::find_if(counters.begin(), counters.end(), [&name](auto const& counter) {return counter.name == name; });
+	return it == counters.end() ? 0 : it->value;
+}
+
+void exportSummariesToJson(std::ostream& out, std::vector<HistogramSummary> const& summaries)
+{
+	for (size_t i = 0; i < summaries.size(); i++)
+	{
+		auto const& summary = summaries[i];
+		out << (i == 0 ? "\n    " : ",\n    ") << "{\"name\": \"" << summary.name << "\", \"count\": " << summary.count
+			<< ", \"sum\": " << summary.sum << ", \"mean\": " << summary.mean() << ", \"min\": " << summary.min << ", \"max\": " << summary.max
+			<< ", \"p50\": " << summary.p50 << ", \"p90\": " << summary.p90 << ", \"p99\": " << summary.p99 << '}';
+	}
+	out << (summaries.empty() ? "]" : "\n  ]");
+}
+
+void ProfileReport::exportToJson(std::ostream& out) const
+{
+	out << "{\n  \"timersUnit\": \"ns\",\n  \"timers\": [";
+	exportSummariesToJson(out, timers);
+	out << ",\n  \"histograms\": [";
+	exportSummariesToJson(out, histograms);
+	out << ",\n  \"counters\": {";
+	for (size_t i = 0; i < counters.size(); i++)
+		out << (i == 0 ? "\n    " : ",\n    ") << '"' << counters[i].name << "\": " << counters[i].value;
+	out << (counters.empty() ? "}\n}\n" : "\n  }\n}\n");
+}
+
+void exportSummariesToText(std::ostream& out, std::vector<HistogramSummary> const& summaries, double unit)
+{
+	for (auto const& summary : summaries)
+		out << "  " << summary.name << ": count " << summary.count << ", total " << static_cast<double>(summary.sum) / unit
+			<< ", mean " << summary.mean() / unit << ", min " << static_cast<double>(summary.min) / unit
+			<< ", p50 " << static_cast<double>(summary.p50) / unit << ", p90 " << static_cast<double>(summary.p90) / unit
+			<< ", p99 " << static_cast<double>(summary.p99) / unit << ", max " << static_cast<double>(summary.max) / unit << '\n';
+}
+
+void ProfileReport::exportToText(std::ostream& out) const
+{
+	out << "Timers (ms):\n";
+	exportSummariesToText(out, timers, 1e6);
+	out << "Histograms:\n";
+	exportSummariesToText(out, histograms, 1);
+	out << "Counters:\n";
+	for (auto const& counter : counters)
+		out << "  " << counter.name << ": " << counter.value << '\n';
+}
@@ -0,0 +1,151 @@
+﻿#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * \brief summary of recorded values, percentiles are estimated by power of two buckets
+ */
+struct HistogramSummary
+{
+	std::string name;
+	uint64_t count = 0;
+	uint64_t sum = 0;
+	uint64_t min = 0;
+	uint64_t max = 0;
+	uint64_t p50 = 0;
+	uint64_t p90 = 0;
+	uint64_t p99 = 0;
+
+	double mean() const;
+};
+
+struct CounterSummary
+{
+	std::string name;
+	uint64_t value = 0;
+};
+
+/**
+ * \brief values of all threads at the moment of the call, timers are in nanoseconds
+ */
+struct ProfileReport
+{
+	std::vector<HistogramSummary> timers;
+	std::vector<HistogramSummary> histograms;
+	std::vector<CounterSummary> counters;
+
+	HistogramSummary const* findTimer(std::string const& name) const;
+	HistogramSummary const* findHistogram(std::string const& name) const;
+	// 0 when the counter isn't registered
+	uint64_t getCounter(std::string const& name) const;
+	void exportToJson(std::ostream& out) const;
+	void exportToText(std::ostream& out) const;
+};
+
+/**
+ * \brief hot-path timers, histograms and counters. Each thread writes only its own values, so recording
+ * is a few plain stores; values are summed when the report is collected.
+ * Recording is disabled until setEnabled(true) or THEMATIC_ANALYSIS_PROFILE environment variable is set
+ * to the report path (".json" extension - JSON report, otherwise text), then the report is written at exit
+ */
+class Profiler
+{
+public:
+	enum class Kind { Timer, Histogram, Counter };
+
+	static bool isEnabled()
+	{
+		return _isEnabled.load(std::memory_order_relaxed);
+	}
+	static void setEnabled(bool isEnabled);
+
+	// ids of the same name and kind are the same, throw std::logic_error when there are too many names
+	static size_t registerName(std::string const& name, Kind kind);
+	static void addValue(size_t id, uint64_t value);
+	static void addToCounter(size_t id, uint64_t value);
+	// name of a timer or a histogram, throw std::logic_error when the id isn't registered
+	static std::string getName(size_t id);
+
+	/**
+	 * \brief timer of the innermost started ScopedTimer of the calling thread, NO_SCOPE outside of them.
+	 * Tasks of ThreadPool are run in the scope of the thread which has added them
+	 */
+	static size_t currentScope();
+	// returns the previous scope
+	static size_t setCurrentScope(size_t timerId);
+
+	static ProfileReport collect();
+	// must be called when profiled code isn't running
+	static void reset();
+	// JSON report when the file extension is ".json", otherwise text; throw std::runtime_error when it can't be written
+	static void dump(std::string const& filePath);
+
+	static const size_t MAX_HISTOGRAMS = 128;
+	static const size_t MAX_COUNTERS = 256;
+	static const size_t NO_SCOPE = MAX_HISTOGRAMS;
+
+private:
+	static std::atomic<bool> _isEnabled;
+	static thread_local size_t _currentScope;
+};
+
+/**
+ * \brief adds the lifetime of the scope to the timer, which is the current scope meanwhile
+ */
+class ScopedTimer
+{
+public:
+	explicit ScopedTimer(size_t timerId) : _timerId(timerId), _isStarted(Profiler::isEnabled())
+	{
+		if (_isStarted)
+		{
+			_previousScope = Profiler::setCurrentScope(_timerId);
+			_start = std::chrono::steady_clock::now();
+		}
+	}
+	ScopedTimer(ScopedTimer const&) = delete;
+	ScopedTimer& operator=(ScopedTimer const&) = delete;
+	~ScopedTimer()
+	{
+		if (!_isStarted) return;
+		Profiler::addValue(_timerId, static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - _start).count()));
+		Profiler::setCurrentScope(_previousScope);
+	}
+
+private:
+	size_t _timerId;
+	bool _isStarted;
+	size_t _previousScope = Profiler::NO_SCOPE;
+	std::chrono::steady_clock::time_point _start;
+};
+
+// THEMATIC_ANALYSIS_NO_PROFILER removes instrumentation from the build
+#ifdef THEMATIC_ANALYSIS_NO_PROFILER
+#define PROFILE_SCOPE(name)
+#define PROFILE_VALUE(name, value)
+#define PROFILE_COUNT(name, value)
+#else
+#define PROFILE_CONCAT_IMPL(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_IMPL(a, b)
+#define PROFILE_SCOPE(name) \
+	static const size_t PROFILE_CONCAT(profileTimerId, __LINE__) = Profiler::registerName(name, Profiler::Kind::Timer); \
+	ScopedTimer PROFILE_CONCAT(profileTimer, __LINE__)(PROFILE_CONCAT(profileTimerId, __LINE__))
+#define PROFILE_VALUE(name, value) \
+	do { \
+		if (Profiler::isEnabled()) { \
+			static const size_t profileHistogramId = Profiler::registerName(name, Profiler::Kind::Histogram); \
+			Profiler::addValue(profileHistogramId, static_cast<uint64_t>(value)); \
+		} \
+	} while (false)
+#define PROFILE_COUNT(name, value) \
+	do { \
+		if (Profiler::isEnabled()) { \
+			static const size_t profileCounterId = Profiler::registerName(name, Profiler::Kind::Counter); \
+			Profiler::addToCounter(profileCounterId, static_cast<uint64_t>(value)); \
+		} \
+	} while (false)
+#endif
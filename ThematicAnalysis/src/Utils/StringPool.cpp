@@ -0,0 +1,98 @@
+﻿#include "StringPool.h"
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+
+#include "BinaryUtils.h"
+
+const StringPool::Id StringPool::NO_ID = std::numeric_limits<StringPool::Id>::max();
+
+const size_t MIN_SLOTS_COUNT = 16;
+
+/**
+ * \brief slot of the equal string or the empty slot where it should be; slots count is a power of two
+ * and the table is at most half full, so the search stops
+ */
+size_t StringPool::findSlot(std::string_view str) const
+{
+	auto mask = _slots.size() - 1;
+	for (auto slot = std::hash<std::string_view>()(str) & mask;; slot = (slot + 1) & mask)
+		if (_slots[slot] == NO_ID || get(_slots[slot]) == str)
+			return slot;
+}
+
+void StringPool::rehash(size_t slotsCount)
+{
+	auto slots = std::move(_slots);
+	_slots.assign(slotsCount, NO_ID);
+	for (auto id : slots)
+		if (id != NO_ID)
+			_slots[findSlot(get(id))] = id;
+}
+
+StringPool::Id StringPool::add(std::string_view str)
+{
+	if (str.find('\0') != std::string_view::npos)
+		throw std::invalid_argument("String pool can't keep strings with '\\0'");
+	if ((_stringsCount + 1) * 2 > _slots.size())
+		rehash(std::max(MIN_SLOTS_COUNT, _slots.size() * 2));
+	auto slot = findSlot(str);
+	if (_slots[slot] != NO_ID)
+		return _slots[slot];
+	if (_buffer.size() + str.size() + 1 > NO_ID)
+		throw std::length_error("String pool is full");
+
+	auto id = static_cast<Id>(_buffer.size());
+	_buffer.append(str);
+	_buffer.push_back('\0');
+	_slots[slot] = id;
+	_stringsCount++;
+	return id;
+}
+
+StringPool::Id StringPool::find(std::string_view str) const
+{
+	return _slots.empty() ? NO_ID : _slots[findSlot(str)];
+}
+
+std::string_view StringPool::get(Id id) const
+{
+	return std::string_view(_buffer.data() + id);
+}
+
+size_t StringPool::stringsCount() const
+{
+	return _stringsCount;
+}
+
+size_t StringPool::getMemoryUsage() const
+{
+	return _buffer.capacity() + _slots.capacity() * sizeof(Id);
+}
+
+void StringPool::saveToStream(std::ostream& out) const
+{
+	BinaryUtils::writeString(out, _buffer);
+	BinaryUtils::writeVector(out, _slots);
+	BinaryUtils::write<uint64_t>(out, _stringsCount);
+}
+
+/**
+ * \brief the table must be at most half full as after add, otherwise findSlot of a missing string wouldn't stop,
+ * and each id must be the offset of a string in the buffer
+ */
+void StringPool::loadFromStream(std::istream& in)
+{
+	auto buffer = BinaryUtils::readString(in);
+	auto slots = BinaryUtils::readVector<Id>(in);
+	auto stringsCount = BinaryUtils::read<uint64_t>(in);
+	auto isSlotValid = [&buffer](Id id) {return id == NO_ID || (id < buffer.size() && (id == 0 || buffer[id - 1] == '\0')); };
+	auto occupiedCount = static_cast<uint64_t>(std::count_if(slots.begin(), slots.end(), [](Id id) {return id != NO_ID; }));
+	if ((!buffer.empty() && buffer.back() != '\0') || (slots.size() & (slots.size() - 1)) != 0
+		|| occupiedCount != stringsCount || stringsCount * 2 > slots.size() || !std::all_of(slots.begin(), slots.end(), isSlotValid))
+		throw std::runtime_error("Broken string pool data");
+	_buffer = std::move(buffer);
+	_slots = std::move(slots);
+	_stringsCount = static_cast<size_t>(stringsCount);
+}
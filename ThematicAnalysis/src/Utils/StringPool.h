@@ -0,0 +1,42 @@
+﻿#pragma once
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * \brief strings stored once in one buffer, each one is followed by '\0'. Id of a string is its offset,
+ * so ids stay valid while strings are added. Equal strings are found by an open addressing table of ids
+ */
+class StringPool
+{
+public:
+	using Id = uint32_t;
+	static const Id NO_ID;
+
+	// id of the equal string when it's already added, throw std::invalid_argument for strings with '\0'
+	// and std::length_error when the buffer can't be addressed by ids
+	Id add(std::string_view str);
+	// NO_ID when the string isn't added
+	Id find(std::string_view str) const;
+	std::string_view get(Id id) const;
+
+	size_t stringsCount() const;
+	// bytes of the buffer and the table
+	size_t getMemoryUsage() const;
+
+	// binary form with the table, so loaded pool isn't rehashed
+	void saveToStream(std::ostream& out) const;
+	// throw std::runtime_error when the data is broken
+	void loadFromStream(std::istream& in);
+
+private:
+	size_t findSlot(std::string_view str) const;
+	void rehash(size_t slotsCount);
+
+	std::string _buffer;
+	std::vector<Id> _slots;
+	size_t _stringsCount = 0;
+};
@@ -1,7 +1,6 @@
 ﻿#include "StringUtils.h"
 
 #include <algorithm>
-#include <execution>
 #include <iostream>
 #include <numeric>
 #include <sstream>
@@ -31,9 +30,7 @@ std::vector<std::string> StringUtils::split(std::string const& text, std::string
 
 size_t getSumSize(std::vector<std::string> const& vec)
 {
-	return std::transform_reduce(std::execution::par, vec.begin(), vec.end(), 0ull, 
-		[](size_t a, size_t b){return a+b;},
-		[](std::string const& str){return str.size();});
+	return std::accumulate(vec.begin(), vec.end(), 0ull, [](size_t sum, std::string const& str) {return sum + str.size(); });
 }
 
 
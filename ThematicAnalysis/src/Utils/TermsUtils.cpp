@@ -1,58 +1,89 @@
 ﻿#include "TermsUtils.h"
+#include <algorithm>
 #include <cmath>
-#include <list>
 
+#include "FrozenSemanticGraph.h"
 #include "Hasher.h"
+#include "Profiler.h"
 
-double TermsUtils::calcTfIdf(size_t termFreq, size_t termCount, size_t countOfArticlesUsedTerm, size_t articlesCount)
+double TermsUtils::calcTf(size_t termFreq, size_t termCount)
+{
+	return static_cast<double>(termFreq) / static_cast<double>(termCount);
+}
+
+double TermsUtils::calcIdf(size_t countOfArticlesUsedTerm, size_t articlesCount)
 {
-	auto tf = static_cast<double>(termFreq) / static_cast<double>(termCount);
-	double idf;
 	if (articlesCount == 0 || countOfArticlesUsedTerm == 0)
-		idf = std::log10(static_cast<double>(articlesCount + 1) / static_cast<double>(countOfArticlesUsedTerm + 1));
-	else
-		idf = std::log10(static_cast<double>(articlesCount) / static_cast<double>(countOfArticlesUsedTerm));
-	return tf*idf;
+		return std::log10(static_cast<double>(articlesCount + 1) / static_cast<double>(countOfArticlesUsedTerm + 1));
+	return std::log10(static_cast<double>(articlesCount) / static_cast<double>(countOfArticlesUsedTerm));
+}
+
+double TermsUtils::calcTfIdf(size_t termFreq, size_t termCount, size_t countOfArticlesUsedTerm, size_t articlesCount)
+{
+	return calcTf(termFreq, termCount) * calcIdf(countOfArticlesUsedTerm, articlesCount);
 }
 /**
  * \brief extract and calculate terms in text
  * \return pairs vector of term hash and count term in text
  */
-std::map<size_t, size_t> TermsUtils::extractTermsCounts(SemanticGraph const& graph, std::vector<std::string> const& allWords)
+template <typename Graph>
+std::map<size_t, size_t> TermsUtils::extractTermsCounts(Graph const& graph, std::vector<std::string> const& allWords)
+{
+	auto termsCounts = selectTermsCounts(findTermsOccurrences(graph, allWords), allWords.size());
+	return std::map<size_t, size_t>(termsCounts.begin(), termsCounts.end());
+}
+
+template <typename Graph>
+std::vector<TermsUtils::TermOccurrence> TermsUtils::findTermsOccurrences(Graph const& graph, std::vector<std::string> const& allWords)
 {
-	std::map<size_t, size_t> termsCounts;
-	std::list<std::pair<size_t, size_t>> termsPlaces;
+	std::vector<TermOccurrence> occurrences;
+	size_t probesCount = 0;
 	for (size_t n = std::min(graph.getNForNgram(), allWords.size()); n > 0; n--)
 	{
-		for (size_t pos = 0; pos < allWords.size() - n + 1; pos++)
+		for (size_t pos = 0; pos < allWords.size() - n + 1; pos++, probesCount++)
 		{
 			auto ngramHash = Hasher::sortAndCalcHash(allWords, pos, n);
-			auto term = termsCounts.find(ngramHash);
-			if (term != termsCounts.end() || graph.isTermExist(ngramHash))
-			{
-				auto isIntersect = [pos, n](auto& a)
-				{
-					auto [start, end] = a;
-					auto endPos = pos + n - 1;
-					return start <= pos && pos <= end || start <= endPos && endPos <= end;
-				};
-				auto intersectionIt = std::find_if(termsPlaces.begin(), termsPlaces.end(), isIntersect);
-				if (intersectionIt == termsPlaces.end())
-				{
-					auto it = std::find_if(termsPlaces.begin(), termsPlaces.end(),
-						[pos](auto& a) {return a.first > pos; });
-					termsPlaces.insert(it, { pos, pos + n - 1 });
-					if (term != termsCounts.end())
-					{
-						term->second++;
-					}
-					else
-					{
-						termsCounts.emplace(ngramHash, 1ull);
-					}
-				}
-			}
+			if (graph.isTermExist(ngramHash))
+				occurrences.push_back({ ngramHash, pos, n });
 		}
 	}
+	PROFILE_COUNT("ngramProbes", probesCount);
+	return occurrences;
+}
+
+/**
+ * \brief an occurrence is counted when none of its words is taken by a counted one. Longer occurrences go first,
+ * so a shorter one can't contain a counted occurrence, only overlap it
+ */
+std::vector<std::pair<size_t, size_t>> TermsUtils::selectTermsCounts(std::vector<TermOccurrence> const& occurrences, size_t wordsCount)
+{
+	std::vector<char> isWordTaken(wordsCount);
+	std::vector<size_t> selected;
+	for (auto const& occurrence : occurrences)
+	{
+		auto begin = isWordTaken.begin() + static_cast<ptrdiff_t>(occurrence.position);
+		auto end = begin + static_cast<ptrdiff_t>(occurrence.wordsCount);
+		if (std::find(begin, end, 1) == end)
+		{
+			std::fill(begin, end, 1);
+			selected.push_back(occurrence.hash);
+		}
+	}
+	std::sort(selected.begin(), selected.end());
+	std::vector<std::pair<size_t, size_t>> termsCounts;
+	for (auto hash : selected)
+		if (termsCounts.empty() || termsCounts.back().first != hash)
+			termsCounts.emplace_back(hash, 1);
+		else
+			termsCounts.back().second++;
 	return termsCounts;
 }
+
+template std::map<size_t, size_t> TermsUtils::extractTermsCounts(SemanticGraph const&, std::vector<std::string> const&);
+template std::map<size_t, size_t> TermsUtils::extractTermsCounts(FrozenSemanticGraph<double> const&, std::vector<std::string> const&);
+template std::map<size_t, size_t> TermsUtils::extractTermsCounts(FrozenSemanticGraph<float> const&, std::vector<std::string> const&);
+template std::map<size_t, size_t> TermsUtils::extractTermsCounts(FrozenSemanticGraph<Quantized16> const&, std::vector<std::string> const&);
+template std::vector<TermsUtils::TermOccurrence> TermsUtils::findTermsOccurrences(SemanticGraph const&, std::vector<std::string> const&);
+template std::vector<TermsUtils::TermOccurrence> TermsUtils::findTermsOccurrences(FrozenSemanticGraph<double> const&, std::vector<std::string> const&);
+template std::vector<TermsUtils::TermOccurrence> TermsUtils::findTermsOccurrences(FrozenSemanticGraph<float> const&, std::vector<std::string> const&);
+template std::vector<TermsUtils::TermOccurrence> TermsUtils::findTermsOccurrences(FrozenSemanticGraph<Quantized16> const&, std::vector<std::string> const&);
@@ -1,12 +1,32 @@
 ﻿#pragma once
 #include <map>
+#include <utility>
+#include <vector>
 
 #include "SemanticGraph.h"
 
 class TermsUtils
 {
 public:
+	static double calcTf(size_t termFreq, size_t termCount);
+	static double calcIdf(size_t countOfArticlesUsedTerm, size_t articlesCount);
 	static double calcTfIdf(size_t termFreq, size_t termCount, size_t countOfArticlesUsedTerm, size_t articlesCount);
-	static std::map<size_t, size_t> extractTermsCounts(SemanticGraph const& graph, std::vector<std::string> const& allWords);
+
+	// n-gram of the text which is a term of the graph
+	struct TermOccurrence
+	{
+		size_t hash;
+		size_t position;
+		size_t wordsCount;
+	};
+
+	// Graph is SemanticGraph or FrozenSemanticGraph
+	template <typename Graph>
+	static std::map<size_t, size_t> extractTermsCounts(Graph const& graph, std::vector<std::string> const& allWords);
+	// each n-gram of 1 to getNForNgram() words is looked up once, longer n-grams first, then by position
+	template <typename Graph>
+	static std::vector<TermOccurrence> findTermsOccurrences(Graph const& graph, std::vector<std::string> const& allWords);
+	// counts of not overlapping occurrences as extractTermsCounts selects them, sorted by hash
+	static std::vector<std::pair<size_t, size_t>> selectTermsCounts(std::vector<TermOccurrence> const& occurrences, size_t wordsCount);
 
 };
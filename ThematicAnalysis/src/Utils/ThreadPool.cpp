@@ -0,0 +1,302 @@
+﻿#include "ThreadPool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <exception>
+#include <string>
+
+#include "Profiler.h"
+
+class ThreadPool::Task
+{
+public:
+	std::function<void()> function;
+	std::vector<TaskHandle> dependencies;
+	// profiler scope of the thread which has added the task
+	size_t scope = Profiler::NO_SCOPE;
+	// unfinished dependencies and one more until the task is added
+	std::atomic<size_t> pendingCount = 0;
+
+	std::mutex mutex;
+	std::condition_variable finished;
+	bool isFinished = false;
+	std::exception_ptr exception;
+	std::vector<TaskHandle> dependents;
+};
+
+const size_t ThreadPool::CHUNKS_PER_WORKER = 4;
+
+std::atomic<size_t> defaultWorkersCount = 0;
+thread_local ThreadPool const* currentPool = nullptr;
+thread_local size_t currentWorkerIndex = 0;
+
+size_t readWorkersCountVariable()
+{
+	std::string value;
+#ifdef _WIN32
+	char* buffer = nullptr;
+	size_t size = 0;
+	if (_dupenv_s(&buffer, &size, "THEMATIC_ANALYSIS_THREADS") == 0 && buffer != nullptr)
+	{
+		value = buffer;
+		free(buffer);
+	}
+#else
+	if (auto buffer = std::getenv("THEMATIC_ANALYSIS_THREADS"))
+		value = buffer;
+#endif
+	try
+	{
+		return value.empty() ? 0 : std::stoul(value);
+	}
+	catch (std::exception const&)
+	{
+		return 0;
+	}
+}
+
+ThreadPool::ThreadPool(size_t workersCount) :
+	_workersCount(workersCount > 0 ? workersCount : std::max(1u, std::thread::hardware_concurrency()))
+{
+	for (size_t i = 0; i <= _workersCount; i++)
+		_queues.push_back(std::make_unique<Queue>());
+	_workers.reserve(_workersCount);
+	for (size_t i = 0; i < _workersCount; i++)
+		_workers.emplace_back(&ThreadPool::work, this, i);
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard lock(_mutex);
+		_isStopped = true;
+	}
+	_hasTasks.notify_all();
+	for (auto& worker : _workers)
+		worker.join();
+}
+
+ThreadPool& ThreadPool::instance()
+{
+	static ThreadPool pool(defaultWorkersCount > 0 ? defaultWorkersCount.load() : readWorkersCountVariable());
+	return pool;
+}
+
+void ThreadPool::setDefaultWorkersCount(size_t workersCount)
+{
+	defaultWorkersCount = workersCount;
+}
+
+size_t ThreadPool::workersCount() const
+{
+	return _workersCount;
+}
+
+size_t ThreadPool::currentQueueIndex() const
+{
+	return currentPool == this ? currentWorkerIndex : _workersCount;
+}
+
+ThreadPool::TaskHandle ThreadPool::run(std::function<void()> task, std::vector<TaskHandle> const& dependencies)
+{
+	auto handle = std::make_shared<Task>();
+	handle->function = std::move(task);
+	handle->dependencies = dependencies;
+	handle->scope = Profiler::currentScope();
+	handle->pendingCount = dependencies.size() + 1;
+	for (auto const& dependency : dependencies)
+	{
+		std::lock_guard lock(dependency->mutex);
+		if (dependency->isFinished)
+			handle->pendingCount--;
+		else
+			dependency->dependents.push_back(handle);
+	}
+	if (--handle->pendingCount == 0)
+		schedule(handle);
+	return handle;
+}
+
+void ThreadPool::schedule(TaskHandle task)
+{
+	// the count is increased first, so it never gets less than count of tasks in queues
+	{
+		std::lock_guard lock(_mutex);
+		_queuedCount++;
+	}
+	auto& queue = *_queues[currentQueueIndex()];
+	{
+		std::lock_guard lock(queue.mutex);
+		queue.tasks.push_back(std::move(task));
+	}
+	_hasTasks.notify_one();
+}
+
+/**
+ * \brief the newest task of own queue is taken first, then the oldest tasks of other queues
+ */
+bool ThreadPool::tryRunTask()
+{
+	auto ownIndex = currentQueueIndex();
+	TaskHandle task;
+	if (ownIndex < _workersCount)
+	{
+		auto& queue = *_queues[ownIndex];
+		std::lock_guard lock(queue.mutex);
+		if (!queue.tasks.empty())
+		{
+			task = std::move(queue.tasks.back());
+			queue.tasks.pop_back();
+		}
+	}
+	for (size_t i = 1; task == nullptr && i <= _queues.size(); i++)
+	{
+		auto& queue = *_queues[(ownIndex + i) % _queues.size()];
+		std::lock_guard lock(queue.mutex);
+		if (!queue.tasks.empty())
+		{
+			task = std::move(queue.tasks.front());
+			queue.tasks.pop_front();
+		}
+	}
+	if (task == nullptr)
+		return false;
+	_queuedCount--;
+	execute(task);
+	return true;
+}
+
+void ThreadPool::execute(TaskHandle const& task)
+{
+	for (auto const& dependency : task->dependencies)
+		if (dependency->exception != nullptr)
+		{
+			task->exception = dependency->exception;
+			break;
+		}
+	if (task->exception == nullptr)
+	{
+		auto previousScope = Profiler::setCurrentScope(task->scope);
+		try
+		{
+			task->function();
+		}
+		catch (...)
+		{
+			task->exception = std::current_exception();
+		}
+		Profiler::setCurrentScope(previousScope);
+	}
+	task->function = nullptr;
+	task->dependencies.clear();
+
+	std::vector<TaskHandle> dependents;
+	{
+		std::lock_guard lock(task->mutex);
+		task->isFinished = true;
+		dependents.swap(task->dependents);
+	}
+	task->finished.notify_all();
+	for (auto& dependent : dependents)
+		if (--dependent->pendingCount == 0)
+			schedule(std::move(dependent));
+}
+
+void ThreadPool::work(size_t workerIndex)
+{
+	currentPool = this;
+	currentWorkerIndex = workerIndex;
+	while (true)
+	{
+		if (tryRunTask())
+			continue;
+		std::unique_lock lock(_mutex);
+		_hasTasks.wait(lock, [this] {return _isStopped || _queuedCount > 0; });
+		if (_isStopped && _queuedCount == 0)
+			return;
+	}
+}
+
+/**
+ * \brief the waiting thread runs other tasks, it sleeps only when there are no pending tasks
+ */
+void ThreadPool::wait(TaskHandle const& task)
+{
+	while (true)
+	{
+		{
+			std::lock_guard lock(task->mutex);
+			if (task->isFinished)
+				break;
+		}
+		if (!tryRunTask())
+		{
+			std::unique_lock lock(task->mutex);
+			task->finished.wait_for(lock, std::chrono::milliseconds(1), [&task] {return task->isFinished; });
+		}
+	}
+	if (task->exception != nullptr)
+		std::rethrow_exception(task->exception);
+}
+
+void ThreadPool::wait(std::vector<TaskHandle> const& tasks)
+{
+	std::exception_ptr exception;
+	for (auto const& task : tasks)
+	{
+		try
+		{
+			wait(task);
+		}
+		catch (...)
+		{
+			if (exception == nullptr)
+				exception = std::current_exception();
+		}
+	}
+	if (exception != nullptr)
+		std::rethrow_exception(exception);
+}
+
+size_t ThreadPool::calcGrainSize(size_t count, size_t grainSize) const
+{
+	if (grainSize == 0)
+		grainSize = (count + workersCount() * CHUNKS_PER_WORKER - 1) / (workersCount() * CHUNKS_PER_WORKER);
+	return std::max<size_t>(grainSize, 1);
+}
+
+/**
+ * \brief the first subrange is handled by the calling thread
+ */
+void ThreadPool::parallelFor(size_t begin, size_t end, std::function<void(size_t begin, size_t end)> const& body, size_t grainSize)
+{
+	if (begin >= end)
+		return;
+	grainSize = calcGrainSize(end - begin, grainSize);
+	auto firstEnd = std::min(end, begin + grainSize);
+	if (firstEnd == end)
+	{
+		body(begin, end);
+		return;
+	}
+	std::vector<TaskHandle> tasks;
+	tasks.reserve((end - firstEnd + grainSize - 1) / grainSize);
+	for (auto rangeBegin = firstEnd; rangeBegin < end; rangeBegin += grainSize)
+	{
+		auto rangeEnd = std::min(end, rangeBegin + grainSize);
+		tasks.push_back(run([&body, rangeBegin, rangeEnd] {body(rangeBegin, rangeEnd); }));
+	}
+	std::exception_ptr exception;
+	try
+	{
+		body(begin, firstEnd);
+	}
+	catch (...)
+	{
+		exception = std::current_exception();
+	}
+	wait(tasks);
+	if (exception != nullptr)
+		std::rethrow_exception(exception);
+}
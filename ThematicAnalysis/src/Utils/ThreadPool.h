@@ -0,0 +1,87 @@
+﻿#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+/**
+ * \brief work-stealing pool: each worker takes tasks from the back of its own queue and steals them from the front
+ * of other queues. Threads which wait for tasks run pending tasks meanwhile, so tasks may wait for their subtasks
+ */
+class ThreadPool
+{
+public:
+	class Task;
+	using TaskHandle = std::shared_ptr<Task>;
+
+	// 0 - count of hardware threads
+	explicit ThreadPool(size_t workersCount = 0);
+	ThreadPool(ThreadPool const&) = delete;
+	ThreadPool& operator=(ThreadPool const&) = delete;
+	// pending tasks are finished before workers stop
+	~ThreadPool();
+
+	// pool shared by the process, count of its workers is set by setDefaultWorkersCount
+	// or THEMATIC_ANALYSIS_THREADS environment variable before the first call
+	static ThreadPool& instance();
+	static void setDefaultWorkersCount(size_t workersCount);
+	size_t workersCount() const;
+
+	// task is started when all dependencies are finished, it isn't run when one of them has thrown
+	TaskHandle run(std::function<void()> task, std::vector<TaskHandle> const& dependencies = {});
+	// rethrow exception of the task
+	void wait(TaskHandle const& task);
+	// wait all tasks, then rethrow the first exception
+	void wait(std::vector<TaskHandle> const& tasks);
+
+	// body is called for consecutive subranges of grainSize elements, 0 - a few subranges per worker
+	void parallelFor(size_t begin, size_t end, std::function<void(size_t begin, size_t end)> const& body, size_t grainSize = 0);
+	// results of subranges are reduced in their order, so the result doesn't depend on scheduling
+	template<typename T, typename RangeReducer, typename Reducer>
+	T parallelReduce(size_t begin, size_t end, T init, RangeReducer const& reduceRange, Reducer const& reduce, size_t grainSize = 0);
+
+private:
+	struct Queue
+	{
+		std::mutex mutex;
+		std::deque<TaskHandle> tasks;
+	};
+
+	size_t calcGrainSize(size_t count, size_t grainSize) const;
+	size_t currentQueueIndex() const;
+	void schedule(TaskHandle task);
+	bool tryRunTask();
+	void execute(TaskHandle const& task);
+	void work(size_t workerIndex);
+
+	static const size_t CHUNKS_PER_WORKER;
+	size_t const _workersCount;
+	// queue of each worker and the last one for tasks from other threads
+	std::vector<std::unique_ptr<Queue>> _queues;
+	std::vector<std::thread> _workers;
+	std::atomic<size_t> _queuedCount = 0;
+	std::mutex _mutex;
+	std::condition_variable _hasTasks;
+	bool _isStopped = false;
+};
+
+template<typename T, typename RangeReducer, typename Reducer>
+T ThreadPool::parallelReduce(size_t begin, size_t end, T init, RangeReducer const& reduceRange, Reducer const& reduce, size_t grainSize)
+{
+	if (begin >= end)
+		return init;
+	grainSize = calcGrainSize(end - begin, grainSize);
+	std::vector<std::optional<T>> results((end - begin + grainSize - 1) / grainSize);
+	parallelFor(begin, end, [&](size_t rangeBegin, size_t rangeEnd)
+		{
+			results[(rangeBegin - begin) / grainSize] = reduceRange(rangeBegin, rangeEnd);
+		}, grainSize);
+	for (auto& result : results)
+		init = reduce(std::move(init), std::move(*result));
+	return init;
+}
@@ -0,0 +1,123 @@
+﻿#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include "Utils/BinaryUtils.h"
+
+/**
+ * \brief weight type of 16-bit values which are multiplied by the scale of their array
+ */
+struct Quantized16
+{
+};
+
+/**
+ * \brief weights of a frozen graph stored as Weight and read as double
+ */
+template <typename Weight>
+class WeightArray
+{
+	static_assert(std::is_same_v<Weight, double> || std::is_same_v<Weight, float>);
+
+public:
+	static constexpr char const* NAME = std::is_same_v<Weight, double> ? "double" : "float";
+
+	WeightArray() = default;
+	explicit WeightArray(std::vector<double> const& weights) : _values(weights.begin(), weights.end())
+	{
+	}
+
+	double operator[](size_t index) const
+	{
+		return static_cast<double>(_values[index]);
+	}
+
+	size_t size() const
+	{
+		return _values.size();
+	}
+
+	size_t getMemoryUsage() const
+	{
+		return _values.capacity() * sizeof(Weight);
+	}
+
+	void saveToStream(std::ostream& out) const
+	{
+		BinaryUtils::writeVector(out, _values);
+	}
+
+	void loadFromStream(std::istream& in)
+	{
+		_values = BinaryUtils::readVector<Weight>(in);
+	}
+
+private:
+	std::vector<Weight> _values;
+};
+
+/**
+ * \brief the scale is the max weight divided by the max value, so the absolute error of a weight
+ * is at most a half of the scale. Weights must be finite and not negative
+ */
+template <>
+class WeightArray<Quantized16>
+{
+public:
+	static constexpr char const* NAME = "quantized16";
+
+	WeightArray() = default;
+	explicit WeightArray(std::vector<double> const& weights)
+	{
+		if (std::any_of(weights.begin(), weights.end(), [](double weight) {return !(weight >= 0) || std::isinf(weight); }))
+			throw std::invalid_argument("Quantized weights must be finite and not negative");
+		auto maxWeight = weights.empty() ? 0. : *std::max_element(weights.begin(), weights.end());
+		_scale = maxWeight > 0 ? maxWeight / UINT16_MAX : 1.;
+		_values.reserve(weights.size());
+		for (auto weight : weights)
+			_values.push_back(static_cast<uint16_t>(std::lround(weight / _scale)));
+	}
+
+	double operator[](size_t index) const
+	{
+		return _values[index] * _scale;
+	}
+
+	size_t size() const
+	{
+		return _values.size();
+	}
+
+	double scale() const
+	{
+		return _scale;
+	}
+
+	size_t getMemoryUsage() const
+	{
+		return _values.capacity() * sizeof(uint16_t);
+	}
+
+	void saveToStream(std::ostream& out) const
+	{
+		BinaryUtils::write(out, _scale);
+		BinaryUtils::writeVector(out, _values);
+	}
+
+	void loadFromStream(std::istream& in)
+	{
+		auto scale = BinaryUtils::read<double>(in);
+		if (!std::isfinite(scale) || !(scale > 0))
+			throw std::runtime_error("Broken scale of quantized weights");
+		_values = BinaryUtils::readVector<uint16_t>(in);
+		_scale = scale;
+	}
+
+private:
+	double _scale = 1.;
+	std::vector<uint16_t> _values;
+};
@@ -0,0 +1,107 @@
+﻿#include "WeightPrecisionValidator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+
+#include "Utils/ThreadPool.h"
+
+WeightPrecisionValidator::WeightPrecisionValidator(SemanticGraph const& graph, std::vector<std::vector<std::string>> normalizedSamples, size_t tagsCount) :
+	_graph(graph),
+	_normalizedSamples(std::move(normalizedSamples)),
+	_tagsCount(tagsCount),
+	_sourceTags(_normalizedSamples.size())
+{
+	ThreadPool::instance().parallelFor(0, _normalizedSamples.size(), [this](size_t begin, size_t end)
+		{
+			TagsAnalyzer analyzer;
+			for (auto i = begin; i < end; i++)
+			{
+				analyzer.analyze(_normalizedSamples[i], _graph);
+				_sourceTags[i] = analyzer.getRelevantTags(_tagsCount);
+			}
+		}, 1);
+}
+
+std::vector<WeightPrecisionReport> WeightPrecisionValidator::validate() const
+{
+	return {
+		validate(FrozenSemanticGraph<double>(_graph)),
+		validate(FrozenSemanticGraph<float>(_graph)),
+		validate(FrozenSemanticGraph<Quantized16>(_graph)),
+	};
+}
+
+/**
+ * \brief rank of a tag is the count of heavier tags, so the order of equal weights doesn't matter
+ */
+std::map<std::string, std::pair<size_t, double>> getRanks(std::vector<Tag> const& tags)
+{
+	std::map<std::string, std::pair<size_t, double>> ranks;
+	for (size_t i = 0; i < tags.size(); i++)
+	{
+		auto rank = i > 0 && tags[i].weight == tags[i - 1].weight ? ranks[tags[i - 1].termView].first : i;
+		ranks.emplace(tags[i].termView, std::pair{ rank, tags[i].weight });
+	}
+	return ranks;
+}
+
+struct SampleDifference
+{
+	size_t sameCount = 0;
+	size_t rankShiftsSum = 0;
+	size_t maxRankShift = 0;
+	double maxWeightError = 0;
+};
+
+template <typename Weight>
+WeightPrecisionReport WeightPrecisionValidator::validate(FrozenSemanticGraph<Weight> const& frozen) const
+{
+	WeightPrecisionReport report;
+	report.weightType = WeightArray<Weight>::NAME;
+	report.memoryUsage = frozen.getMemoryUsage();
+
+	std::vector<SampleDifference> differences(_normalizedSamples.size());
+	ThreadPool::instance().parallelFor(0, _normalizedSamples.size(), [&](size_t begin, size_t end)
+		{
+			for (auto i = begin; i < end; i++)
+			{
+				auto frozenRanks = getRanks(TagsAnalyzer::getRelevantTags(_normalizedSamples[i], frozen, _tagsCount));
+				auto& difference = differences[i];
+				for (auto&& [view, rankAndWeight] : getRanks(_sourceTags[i]))
+				{
+					auto it = frozenRanks.find(view);
+					if (it == frozenRanks.end())
+						continue;
+					auto [rank, weight] = rankAndWeight;
+					auto [frozenRank, frozenWeight] = it->second;
+					auto rankShift = rank > frozenRank ? rank - frozenRank : frozenRank - rank;
+					difference.sameCount++;
+					difference.rankShiftsSum += rankShift;
+					difference.maxRankShift = std::max(difference.maxRankShift, rankShift);
+					if (weight != 0)
+						difference.maxWeightError = std::max(difference.maxWeightError, std::abs(frozenWeight - weight) / std::abs(weight));
+				}
+			}
+		}, 1);
+
+	double overlapSum = 0;
+	size_t sameCount = 0, rankShiftsSum = 0;
+	for (size_t i = 0; i < differences.size(); i++)
+	{
+		overlapSum += _sourceTags[i].empty() ? 1. : static_cast<double>(differences[i].sameCount) / static_cast<double>(_sourceTags[i].size());
+		sameCount += differences[i].sameCount;
+		rankShiftsSum += differences[i].rankShiftsSum;
+		report.maxRankShift = std::max(report.maxRankShift, differences[i].maxRankShift);
+		report.maxWeightError = std::max(report.maxWeightError, differences[i].maxWeightError);
+	}
+	if (!differences.empty())
+		report.tagsOverlap = overlapSum / static_cast<double>(differences.size());
+	if (sameCount > 0)
+		report.averageRankShift = static_cast<double>(rankShiftsSum) / static_cast<double>(sameCount);
+	return report;
+}
+
+template WeightPrecisionReport WeightPrecisionValidator::validate(FrozenSemanticGraph<double> const&) const;
+template WeightPrecisionReport WeightPrecisionValidator::validate(FrozenSemanticGraph<float> const&) const;
+template WeightPrecisionReport WeightPrecisionValidator::validate(FrozenSemanticGraph<Quantized16> const&) const;
@@ -0,0 +1,36 @@
+﻿#pragma once
+#include <string>
+#include <vector>
+
+#include "FrozenSemanticGraph.h"
+#include "TagsAnalyzer.h"
+
+struct WeightPrecisionReport
+{
+	std::string weightType;
+	size_t memoryUsage = 0;	// bytes of the frozen graph
+	double tagsOverlap = 1.;	// average share of the top tags over the semantic graph which are among the frozen graph tags
+	double averageRankShift = 0.;	// average change of the ranks of the same tags, equal weights have equal ranks
+	size_t maxRankShift = 0;
+	double maxWeightError = 0.;	// max relative change of the same tag weight
+};
+
+/**
+ * \brief compare the top tags of sample texts over a semantic graph and over its frozen forms,
+ * so the loss of each weight type is known before it's used
+ */
+class WeightPrecisionValidator
+{
+public:
+	WeightPrecisionValidator(SemanticGraph const& graph, std::vector<std::vector<std::string>> normalizedSamples, size_t tagsCount = 10);
+	// reports of double, float and quantized weights
+	std::vector<WeightPrecisionReport> validate() const;
+	template <typename Weight>
+	WeightPrecisionReport validate(FrozenSemanticGraph<Weight> const& frozen) const;
+
+private:
+	SemanticGraph const& _graph;
+	std::vector<std::vector<std::string>> _normalizedSamples;
+	size_t _tagsCount;
+	std::vector<std::vector<Tag>> _sourceTags;
+};
@@ -12,11 +12,24 @@
 #include "Utils/TermsUtils.h"
 #include "TagsAnalyzer.h"
 #include "ArticlesReader/MathArticlesReader.h"
+#include "GraphCompactor.h"
+#include "GraphStatistics.h"
+#include "WeightPrecisionValidator.h"
 
 
 void create() {
 	auto builder = SemanticGraphBuilder();
-	auto graph = builder.build(FileUtils::readAllFile("resources/math/math.txt"), MathArticlesReader());
+	auto graph = builder.buildFromFile("resources/math/math.txt", MathArticlesReader());
+	graph.exportToFile("resources/coolAllMath.gr");
+}
+
+void createFromCorpus()
+{
+	auto builder = SemanticGraphBuilder();
+	IngestionReport report;
+	auto graph = builder.buildFromCorpus("resources/math", CorpusIngestor(4), report);
+	std::cout << "files: " << report.filesCount << ", articles: " << report.articlesCount
+		<< ", " << std::fixed << std::setprecision(2) << report.megabytesPerSecond() << " MB/s" << std::endl;
 	graph.exportToFile("resources/coolAllMath.gr");
 }
 
@@ -67,27 +80,45 @@ void terms()
 void calcTerms()
 {
 	auto graph = getMathGraph();
-	auto count = std::map<size_t, size_t>();
-	for (int i = 0; i < 3500; i++)
-		count[i] = 0;
-	for (auto [hash, node] : graph.nodes)
-	{
-		count[node.neighbors.size()]++;
-		if (node.neighbors.size() > 200)
-			std::cout << node.term.view << std::endl;
-	}
-	std::ofstream out = std::ofstream("statres.txt");
-	for (auto value : count)
-	{
-		out << value.second << std::endl;
+	auto statistics = GraphStatistics::calculate(graph, 200);
+	for (auto& hub : statistics.hubs)
+		std::cout << hub.termView << std::endl;
+	std::ofstream out = std::ofstream("statres.json");
+	statistics.exportToJson(out);
+}
 
-	}
+void compact()
+{
+	auto graph = getMathGraph();
+	TextNormalizer normalizer;
+	auto sample = normalizer.normalize(FileUtils::readAllUTF8File("resources/temp.txt"));
+	auto report = GraphCompactor(50, 0.001).compact(graph, { sample }, 100);
+	std::cout << "nodes: " << report.nodesBefore << " -> " << report.nodesAfter << '\n'
+		<< "links: " << report.linksBefore << " -> " << report.linksAfter << '\n'
+		<< "same tags: " << std::fixed << std::setprecision(2) << report.tagsOverlap * 100 << "%" << std::endl;
+	graph.exportToFile("resources/compactAllMath.gr");
+}
+
+void validateWeights()
+{
+	auto graph = getMathGraph();
+	TextNormalizer normalizer;
+	std::vector<std::vector<std::string>> samples;
+	for (auto path : { "resources/temp.txt", "resources/integral.txt" })
+		samples.push_back(normalizer.normalize(FileUtils::readAllUTF8File(path)));
+	for (auto& report : WeightPrecisionValidator(graph, samples, 100).validate())
+		std::cout << report.weightType << ": " << report.memoryUsage << " bytes, same tags: " << std::fixed << std::setprecision(2)
+			<< report.tagsOverlap * 100 << "%, rank shift: " << report.averageRankShift << " (max " << report.maxRankShift
+			<< "), max weight error: " << std::scientific << report.maxWeightError << std::endl;
 }
 
 int main() {
 	setlocale(LC_ALL, "rus");
 	//create();
+	//createFromCorpus();
 	//calcTerms();
+	//compact();
+	//validateWeights();
 	tags();
 	return 0;
 }
@@ -0,0 +1,188 @@
+﻿#include "AllocationTracker.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+#include "Utils/Profiler.h"
+
+/**
+ * \brief values are changed by all threads, so they are atomic; all of them are constant initialized,
+ * because operator new is called before dynamic initialization
+ */
+struct StageValues
+{
+	std::atomic<uint64_t> count = 0;
+	std::atomic<uint64_t> bytes = 0;
+	std::atomic<int64_t> liveBytes = 0;
+	std::atomic<int64_t> resetLiveBytes = 0;
+	std::atomic<int64_t> peakLiveBytes = 0;
+
+	void allocate(size_t size)
+	{
+		count.fetch_add(1, std::memory_order_relaxed);
+		bytes.fetch_add(size, std::memory_order_relaxed);
+		auto live = liveBytes.fetch_add(static_cast<int64_t>(size), std::memory_order_relaxed) + static_cast<int64_t>(size);
+		auto peak = peakLiveBytes.load(std::memory_order_relaxed);
+		while (live > peak && !peakLiveBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed))
+		{
+		}
+	}
+
+	void free(size_t size)
+	{
+		liveBytes.fetch_sub(static_cast<int64_t>(size), std::memory_order_relaxed);
+	}
+
+	void reset()
+	{
+		count = 0, bytes = 0;
+		resetLiveBytes = liveBytes.load();
+		peakLiveBytes = liveBytes.load();
+	}
+
+	AllocationStats getStats() const
+	{
+		AllocationStats stats;
+		stats.count = count;
+		stats.bytes = bytes;
+		stats.peakBytes = static_cast<uint64_t>(std::max<int64_t>(0, peakLiveBytes - resetLiveBytes));
+		return stats;
+	}
+};
+
+// stages are profiler timers and Profiler::NO_SCOPE, the last values are the total
+const size_t TOTAL_STAGE = Profiler::NO_SCOPE + 1;
+// stage of allocations made while the tracker is disabled
+const size_t UNTRACKED_STAGE = TOTAL_STAGE + 1;
+
+std::array<StageValues, TOTAL_STAGE + 1> stagesValues;
+std::atomic<bool> isTrackerEnabled = false;
+
+// keeps the alignment of malloc
+struct alignas(std::max_align_t) AllocationHeader
+{
+	size_t size;
+	size_t stage;
+};
+
+void* allocate(size_t size)
+{
+	auto header = static_cast<AllocationHeader*>(std::malloc(sizeof(AllocationHeader) + size));
+	if (header == nullptr)
+		return nullptr;
+	header->size = size;
+	header->stage = UNTRACKED_STAGE;
+	if (isTrackerEnabled.load(std::memory_order_relaxed))
+	{
+		header->stage = Profiler::currentScope();
+		stagesValues[header->stage].allocate(size);
+		stagesValues[TOTAL_STAGE].allocate(size);
+	}
+	return header + 1;
+}
+
+void deallocate(void* pointer)
+{
+	if (pointer == nullptr)
+		return;
+	auto header = static_cast<AllocationHeader*>(pointer) - 1;
+	if (header->stage != UNTRACKED_STAGE)
+	{
+		stagesValues[header->stage].free(header->size);
+		stagesValues[TOTAL_STAGE].free(header->size);
+	}
+	std::free(header);
+}
+
+void* operator new(size_t size)
+{
+	if (auto pointer = allocate(size))
+		return pointer;
+	throw std::bad_alloc();
+}
+
+void* operator new[](size_t size)
+{
+	if (auto pointer = allocate(size))
+		return pointer;
+	throw std::bad_alloc();
+}
+
+void* operator new(size_t size, std::nothrow_t const&) noexcept
+{
+	return allocate(size);
+}
+
+void* operator new[](size_t size, std::nothrow_t const&) noexcept
+{
+	return allocate(size);
+}
+
+void operator delete(void* pointer) noexcept
+{
+	deallocate(pointer);
+}
+
+void operator delete[](void* pointer) noexcept
+{
+	deallocate(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept
+{
+	deallocate(pointer);
+}
+
+void operator delete[](void* pointer, size_t) noexcept
+{
+	deallocate(pointer);
+}
+
+void operator delete(void* pointer, std::nothrow_t const&) noexcept
+{
+	deallocate(pointer);
+}
+
+void operator delete[](void* pointer, std::nothrow_t const&) noexcept
+{
+	deallocate(pointer);
+}
+
+bool AllocationTracker::isEnabled()
+{
+	return isTrackerEnabled.load(std::memory_order_relaxed);
+}
+
+void AllocationTracker::setEnabled(bool isEnabled)
+{
+	isTrackerEnabled.store(isEnabled, std::memory_order_relaxed);
+}
+
+void AllocationTracker::reset()
+{
+	for (auto& values : stagesValues)
+		values.reset();
+}
+
+AllocationReport AllocationTracker::collect()
+{
+	// values are read before the report allocates
+	std::array<AllocationStats, TOTAL_STAGE + 1> stats;
+	for (size_t i = 0; i < stagesValues.size(); i++)
+		stats[i] = stagesValues[i].getStats();
+
+	AllocationReport report;
+	report.total = stats[TOTAL_STAGE];
+	for (size_t i = 0; i < TOTAL_STAGE; i++)
+	{
+		if (stats[i].count == 0) continue;
+		report.stages.push_back(stats[i]);
+		if (i != Profiler::NO_SCOPE)
+			report.stages.back().stage = Profiler::getName(i);
+	}
+	std::sort(report.stages.begin(), report.stages.end(), [](auto const& first, auto const& second) {return first.bytes > second.bytes; });
+	return report;
+}
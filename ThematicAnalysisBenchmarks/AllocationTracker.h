@@ -0,0 +1,40 @@
+﻿#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct AllocationStats
+{
+	// profiler timer name, empty outside of timed scopes
+	std::string stage;
+	uint64_t count = 0;
+	uint64_t bytes = 0;
+	// maximum of live bytes allocated in the stage over its live bytes at reset
+	uint64_t peakBytes = 0;
+};
+
+/**
+ * \brief allocations since the last reset, stages are sorted by bytes
+ */
+struct AllocationReport
+{
+	AllocationStats total;
+	std::vector<AllocationStats> stages;
+};
+
+/**
+ * \brief counts allocations of the global operator new, which is replaced in the benchmarks executable.
+ * An allocation belongs to the stage of the current profiler scope (Profiler::currentScope), so stages
+ * are recorded only while the profiler is enabled; tasks of the thread pool belong to the stage which has added them.
+ * Each allocation keeps its size and stage in a header, so frees are subtracted from the stage which has allocated
+ */
+class AllocationTracker
+{
+public:
+	static bool isEnabled();
+	// allocations made while the tracker is disabled aren't counted when they are freed
+	static void setEnabled(bool isEnabled);
+	// must be called when tracked code isn't running
+	static void reset();
+	static AllocationReport collect();
+};
@@ -0,0 +1,249 @@
+﻿#include "BenchmarkRunner.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <numeric>
+#include <stdexcept>
+
+double BenchmarkResult::throughput() const
+{
+	return p50Seconds > 0 ? static_cast<double>(unitsPerIteration) / p50Seconds : 0;
+}
+
+double getPercentile(std::vector<double> const& sorted, double percentile)
+{
+	auto rank = static_cast<size_t>(std::ceil(percentile * static_cast<double>(sorted.size())));
+	return sorted[std::clamp<size_t>(rank, 1, sorted.size()) - 1];
+}
+
+double BenchmarkResult::getCounterPerUnit(size_t event) const
+{
+	auto unitsCount = static_cast<double>(unitsPerIteration) * static_cast<double>(iterationsSeconds.size());
+	return unitsCount > 0 ? counters.values[event] / unitsCount : 0;
+}
+
+double BenchmarkResult::getInstructionsPerCycle() const
+{
+	return counters.isMeasured[0] && counters.isMeasured[1] && counters.values[0] > 0 ? counters.values[1] / counters.values[0] : 0;
+}
+
+void BenchmarkResult::summarize()
+{
+	if (iterationsSeconds.empty()) return;
+	auto sorted = iterationsSeconds;
+	std::sort(sorted.begin(), sorted.end());
+	minSeconds = sorted.front();
+	maxSeconds = sorted.back();
+	meanSeconds = std::accumulate(sorted.begin(), sorted.end(), 0.) / static_cast<double>(sorted.size());
+	p50Seconds = getPercentile(sorted, 0.5);
+	p90Seconds = getPercentile(sorted, 0.9);
+	p99Seconds = getPercentile(sorted, 0.99);
+}
+
+double BenchmarkComparison::change() const
+{
+	return baselineSeconds > 0 ? currentSeconds / baselineSeconds - 1 : 0;
+}
+
+BenchmarkRunner::BenchmarkRunner(size_t iterationsCount, size_t warmupCount) :
+	_iterationsCount(std::max<size_t>(iterationsCount, 1)), _warmupCount(warmupCount)
+{
+}
+
+bool BenchmarkRunner::enableHardwareCounters()
+{
+	_hardwareCounters = std::make_unique<HardwareCounters>();
+	if (!_hardwareCounters->isAvailable())
+		_hardwareCounters.reset();
+	return _hardwareCounters != nullptr;
+}
+
+HardwareCounters const* BenchmarkRunner::hardwareCounters() const
+{
+	return _hardwareCounters.get();
+}
+
+void BenchmarkRunner::add(std::string name, std::string unit, Iteration iteration, Setup setup)
+{
+	_benchmarks.push_back({ std::move(name), std::move(unit), std::move(iteration), std::move(setup) });
+}
+
+BenchmarkResult BenchmarkRunner::runBenchmark(Benchmark const& benchmark) const
+{
+	BenchmarkResult result;
+	result.name = benchmark.name;
+	result.unit = benchmark.unit;
+	if (benchmark.setup)
+		benchmark.setup();
+	for (size_t i = 0; i < _warmupCount; i++)
+		benchmark.iteration();
+	if (AllocationTracker::isEnabled())
+		AllocationTracker::reset();
+	for (size_t i = 0; i < _iterationsCount; i++)
+	{
+		// counters are opened and read out of the timed region
+		auto countersRegion = _hardwareCounters ? _hardwareCounters->start() : HardwareCounters::Region();
+		auto start = std::chrono::steady_clock::now();
+		result.unitsPerIteration = benchmark.iteration();
+		result.iterationsSeconds.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+		result.counters += countersRegion.stop();
+	}
+	if (AllocationTracker::isEnabled())
+		result.allocations = AllocationTracker::collect();
+	result.summarize();
+	return result;
+}
+
+uint64_t getPerIteration(uint64_t value, BenchmarkResult const& result)
+{
+	return result.iterationsSeconds.empty() ? 0 : value / result.iterationsSeconds.size();
+}
+
+void printAllocations(BenchmarkResult const& result, std::ostream& log)
+{
+	auto const& total = result.allocations->total;
+	log << "    allocations per iteration: " << getPerIteration(total.count, result) << ", bytes " << getPerIteration(total.bytes, result)
+		<< ", peak bytes " << total.peakBytes << std::endl;
+	for (auto const& stage : result.allocations->stages)
+		log << "      " << std::left << std::setw(48) << (stage.stage.empty() ? "(no stage)" : stage.stage) << std::right
+			<< std::setw(10) << getPerIteration(stage.count, result) << std::setw(14) << getPerIteration(stage.bytes, result)
+			<< std::setw(14) << stage.peakBytes << std::endl;
+}
+
+std::vector<BenchmarkResult> BenchmarkRunner::run(std::string const& filter, std::ostream& log) const
+{
+	std::vector<BenchmarkResult> results;
+	log << std::left << std::setw(40) << "benchmark" << std::right << std::setw(12) << "p50, ms" << std::setw(12) << "p90, ms"
+		<< std::setw(12) << "p99, ms" << std::setw(12) << "max, ms" << "  throughput\n";
+	for (auto const& benchmark : _benchmarks)
+	{
+		if (benchmark.name.find(filter) == std::string::npos) continue;
+		auto result = runBenchmark(benchmark);
+		log << std::left << std::setw(40) << result.name << std::right << std::fixed << std::setprecision(3)
+			<< std::setw(12) << result.p50Seconds * 1e3 << std::setw(12) << result.p90Seconds * 1e3
+			<< std::setw(12) << result.p99Seconds * 1e3 << std::setw(12) << result.maxSeconds * 1e3
+			<< "  " << std::setprecision(0) << result.throughput() << ' ' << result.unit << "/s" << std::endl;
+		if (!result.counters.isEmpty())
+		{
+			log << "    per " << result.unit << ':' << std::setprecision(3);
+			for (size_t event = 0; event < HardwareCounters::EVENTS_COUNT; event++)
+				if (result.counters.isMeasured[event])
+					log << ' ' << HardwareCounters::EVENTS_NAMES[event] << ' ' << result.getCounterPerUnit(event);
+			if (result.getInstructionsPerCycle() > 0)
+				log << ", IPC " << result.getInstructionsPerCycle();
+			log << std::endl;
+		}
+		if (result.allocations)
+			printAllocations(result, log);
+		results.push_back(std::move(result));
+	}
+	return results;
+}
+
+/**
+ * \brief one benchmark per line, so the baseline is read without a JSON parser
+ */
+void BenchmarkRunner::exportToJson(std::vector<BenchmarkResult> const& results, std::ostream& out)
+{
+	out << std::setprecision(9) << "{\n  \"benchmarks\": [";
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		auto const& result = results[i];
+		out << (i == 0 ? "\n    " : ",\n    ") << "{\"name\": \"" << result.name << "\", \"unit\": \"" << result.unit
+			<< "\", \"unitsPerIteration\": " << result.unitsPerIteration << ", \"iterations\": " << result.iterationsSeconds.size()
+			<< ", \"minSeconds\": " << result.minSeconds << ", \"meanSeconds\": " << result.meanSeconds
+			<< ", \"p50Seconds\": " << result.p50Seconds << ", \"p90Seconds\": " << result.p90Seconds
+			<< ", \"p99Seconds\": " << result.p99Seconds << ", \"maxSeconds\": " << result.maxSeconds
+			<< ", \"throughput\": " << result.throughput();
+		if (!result.counters.isEmpty())
+		{
+			out << ", \"countersPerUnit\": {";
+			auto separator = "";
+			for (size_t event = 0; event < HardwareCounters::EVENTS_COUNT; event++)
+				if (result.counters.isMeasured[event])
+				{
+					out << separator << '"' << HardwareCounters::EVENTS_NAMES[event] << "\": " << result.getCounterPerUnit(event);
+					separator = ", ";
+				}
+			out << "}, \"instructionsPerCycle\": " << result.getInstructionsPerCycle();
+		}
+		if (result.allocations)
+		{
+			auto writeStats = [&out, &result](AllocationStats const& stats)
+			{
+				out << "\"count\": " << getPerIteration(stats.count, result) << ", \"bytes\": " << getPerIteration(stats.bytes, result)
+					<< ", \"peakBytes\": " << stats.peakBytes;
+			};
+			out << ", \"allocationsPerIteration\": {";
+			writeStats(result.allocations->total);
+			out << ", \"stages\": [";
+			for (size_t j = 0; j < result.allocations->stages.size(); j++)
+			{
+				auto const& stage = result.allocations->stages[j];
+				out << (j == 0 ? "" : ", ") << "{\"stage\": \"" << stage.stage << "\", ";
+				writeStats(stage);
+				out << '}';
+			}
+			out << "]}";
+		}
+		out << '}';
+	}
+	out << (results.empty() ? "]\n}\n" : "\n  ]\n}\n");
+}
+
+/**
+ * \brief value of "key": after the position, the string value is without escapes
+ */
+std::string findJsonValue(std::string const& line, std::string const& key)
+{
+	auto keyPos = line.find('"' + key + "\": ");
+	if (keyPos == std::string::npos) return {};
+	auto valueBegin = keyPos + key.size() + 4;
+	if (valueBegin < line.size() && line[valueBegin] == '"')
+		return line.substr(valueBegin + 1, line.find('"', valueBegin + 1) - valueBegin - 1);
+	return line.substr(valueBegin, line.find_first_of(",}", valueBegin) - valueBegin);
+}
+
+std::map<std::string, double> BenchmarkRunner::loadBaseline(std::string const& filePath)
+{
+	std::ifstream in(filePath);
+	if (!in)
+		throw std::runtime_error("Can't open baseline " + filePath);
+	std::map<std::string, double> baseline;
+	std::string line;
+	while (std::getline(in, line))
+	{
+		auto name = findJsonValue(line, "name");
+		auto seconds = findJsonValue(line, "p50Seconds");
+		if (name.empty() || seconds.empty()) continue;
+		try
+		{
+			baseline[name] = std::stod(seconds);
+		}
+		catch (std::exception const&)
+		{
+			throw std::runtime_error("Damaged baseline " + filePath);
+		}
+	}
+	return baseline;
+}
+
+std::vector<BenchmarkComparison> BenchmarkRunner::compare(std::vector<BenchmarkResult> const& results,
+	std::map<std::string, double> const& baseline, double tolerance)
+{
+	std::vector<BenchmarkComparison> comparisons;
+	for (auto const& result : results)
+	{
+		auto it = baseline.find(result.name);
+		if (it == baseline.end()) continue;
+		BenchmarkComparison comparison;
+		comparison.name = result.name;
+		comparison.baselineSeconds = it->second;
+		comparison.currentSeconds = result.p50Seconds;
+		comparison.isRegression = comparison.change() > tolerance;
+		comparisons.push_back(comparison);
+	}
+	return comparisons;
+}
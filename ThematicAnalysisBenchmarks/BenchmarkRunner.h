@@ -0,0 +1,95 @@
+﻿#pragma once
+#include <functional>
+#include <map>
+#include <memory>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "AllocationTracker.h"
+#include "HardwareCounters.h"
+
+/**
+ * \brief timings of one benchmark, percentiles are nearest-rank values of the iterations
+ */
+struct BenchmarkResult
+{
+	std::string name;
+	// what is processed by an iteration: bytes, words, calls...
+	std::string unit;
+	size_t unitsPerIteration = 0;
+	std::vector<double> iterationsSeconds;
+	double minSeconds = 0;
+	double meanSeconds = 0;
+	double p50Seconds = 0;
+	double p90Seconds = 0;
+	double p99Seconds = 0;
+	double maxSeconds = 0;
+	// sum of the measured iterations
+	HardwareCounters::Counts counters;
+	// allocations of the measured iterations when AllocationTracker is enabled
+	std::optional<AllocationReport> allocations;
+
+	// units per second of the median iteration
+	double throughput() const;
+	double getCounterPerUnit(size_t event) const;
+	// instructions per cycle, 0 when they aren't measured
+	double getInstructionsPerCycle() const;
+	void summarize();
+};
+
+struct BenchmarkComparison
+{
+	std::string name;
+	double baselineSeconds = 0;
+	double currentSeconds = 0;
+	bool isRegression = false;
+
+	double change() const;
+};
+
+/**
+ * \brief runs registered benchmarks by name filter, each one after its setup and warmup iterations which aren't measured
+ */
+class BenchmarkRunner
+{
+public:
+	// iteration returns count of processed units
+	using Iteration = std::function<size_t()>;
+	// prepares data of the iterations, it's called only when the benchmark is run
+	using Setup = std::function<void()>;
+
+	BenchmarkRunner(size_t iterationsCount, size_t warmupCount);
+
+	// hardware counters are read around each measured iteration, false when none of them are available
+	bool enableHardwareCounters();
+	HardwareCounters const* hardwareCounters() const;
+
+	void add(std::string name, std::string unit, Iteration iteration, Setup setup = {});
+	// benchmarks with the filter in the name, all when it's empty; results are printed while running
+	std::vector<BenchmarkResult> run(std::string const& filter, std::ostream& log) const;
+
+	static void exportToJson(std::vector<BenchmarkResult> const& results, std::ostream& out);
+	// median seconds by benchmark names of the file written by exportToJson, throw std::runtime_error when it can't be read
+	static std::map<std::string, double> loadBaseline(std::string const& filePath);
+	// regression - the median is slower than the baseline by more than tolerance (0.1 - 10%)
+	static std::vector<BenchmarkComparison> compare(std::vector<BenchmarkResult> const& results,
+		std::map<std::string, double> const& baseline, double tolerance);
+
+private:
+	struct Benchmark
+	{
+		std::string name;
+		std::string unit;
+		Iteration iteration;
+		Setup setup;
+	};
+
+	BenchmarkResult runBenchmark(Benchmark const& benchmark) const;
+
+	size_t _iterationsCount;
+	size_t _warmupCount;
+	std::unique_ptr<HardwareCounters> _hardwareCounters;
+	std::vector<Benchmark> _benchmarks;
+};
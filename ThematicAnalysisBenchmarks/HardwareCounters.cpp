@@ -0,0 +1,176 @@
+﻿#include "HardwareCounters.h"
+#include <algorithm>
+#include <utility>
+
+#ifdef __linux__
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+const std::array<std::string_view, HardwareCounters::EVENTS_COUNT> HardwareCounters::EVENTS_NAMES = {
+	"cycles", "instructions", "l1dMisses", "llcMisses", "branchMisses"
+};
+
+HardwareCounters::Counts& HardwareCounters::Counts::operator+=(Counts const& other)
+{
+	for (size_t i = 0; i < EVENTS_COUNT; i++)
+	{
+		values[i] += other.values[i];
+		isMeasured[i] = isMeasured[i] || other.isMeasured[i];
+	}
+	return *this;
+}
+
+bool HardwareCounters::Counts::isEmpty() const
+{
+	return std::none_of(isMeasured.begin(), isMeasured.end(), [](bool isEventMeasured) {return isEventMeasured; });
+}
+
+HardwareCounters::Region::Region(Region&& other) noexcept : _counters(std::move(other._counters))
+{
+	other._counters.clear();
+}
+
+HardwareCounters::Region& HardwareCounters::Region::operator=(Region&& other) noexcept
+{
+	if (this != &other)
+	{
+		close();
+		_counters = std::move(other._counters);
+		other._counters.clear();
+	}
+	return *this;
+}
+
+HardwareCounters::Region::~Region()
+{
+	close();
+}
+
+bool HardwareCounters::isAvailable() const
+{
+	return std::any_of(_isEventAvailable.begin(), _isEventAvailable.end(), [](bool isEventAvailable) {return isEventAvailable; });
+}
+
+std::string const& HardwareCounters::unavailableReason() const
+{
+	return _unavailableReason;
+}
+
+#ifdef __linux__
+/**
+ * \brief only user space is counted, so perf_event_paranoid 2 is enough. Counters are disabled until the region starts,
+ * inherited ones sum counts of threads which are started later
+ */
+int openEvent(size_t event, pid_t threadId)
+{
+	static const std::array<std::pair<uint32_t, uint64_t>, HardwareCounters::EVENTS_COUNT> configs = { {
+		{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+		{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+		{ PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) },
+		{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+		{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+	} };
+	perf_event_attr attributes;
+	std::memset(&attributes, 0, sizeof(attributes));
+	attributes.size = sizeof(attributes);
+	attributes.type = configs[event].first;
+	attributes.config = configs[event].second;
+	attributes.disabled = 1;
+	attributes.inherit = 1;
+	attributes.exclude_kernel = 1;
+	attributes.exclude_hv = 1;
+	attributes.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+	return static_cast<int>(syscall(__NR_perf_event_open, &attributes, threadId, -1, -1, 0));
+}
+
+std::vector<pid_t> getThreadsIds()
+{
+	std::vector<pid_t> threadsIds;
+	std::error_code error;
+	for (auto const& entry : std::filesystem::directory_iterator("/proc/self/task", error))
+		threadsIds.push_back(static_cast<pid_t>(std::stol(entry.path().filename().string())));
+	if (threadsIds.empty())
+		threadsIds.push_back(0);
+	return threadsIds;
+}
+
+HardwareCounters::HardwareCounters()
+{
+	for (size_t event = 0; event < EVENTS_COUNT; event++)
+	{
+		auto descriptor = openEvent(event, 0);
+		_isEventAvailable[event] = descriptor >= 0;
+		if (descriptor >= 0)
+			::close(descriptor);
+		else if (_unavailableReason.empty())
+			_unavailableReason = std::string(EVENTS_NAMES[event]) + ": " + std::strerror(errno);
+	}
+}
+
+HardwareCounters::Region HardwareCounters::start() const
+{
+	Region region;
+	for (auto threadId : getThreadsIds())
+		for (size_t event = 0; event < EVENTS_COUNT; event++)
+		{
+			if (!_isEventAvailable[event]) continue;
+			// the thread may have finished
+			auto descriptor = openEvent(event, threadId);
+			if (descriptor >= 0)
+				region._counters.push_back({ descriptor, event });
+		}
+	for (auto const& counter : region._counters)
+		ioctl(counter.descriptor, PERF_EVENT_IOC_ENABLE, 0);
+	return region;
+}
+
+HardwareCounters::Counts HardwareCounters::Region::stop()
+{
+	for (auto const& counter : _counters)
+		ioctl(counter.descriptor, PERF_EVENT_IOC_DISABLE, 0);
+	Counts counts;
+	for (auto const& counter : _counters)
+	{
+		// value, time enabled, time running
+		uint64_t values[3] = {};
+		if (read(counter.descriptor, values, sizeof(values)) != static_cast<ssize_t>(sizeof(values)))
+			continue;
+		if (values[2] > 0)
+			counts.values[counter.event] += static_cast<double>(values[0]) * static_cast<double>(values[1]) / static_cast<double>(values[2]);
+		counts.isMeasured[counter.event] = true;
+	}
+	close();
+	return counts;
+}
+
+void HardwareCounters::Region::close()
+{
+	for (auto const& counter : _counters)
+		::close(counter.descriptor);
+	_counters.clear();
+}
+#else
+HardwareCounters::HardwareCounters() : _unavailableReason("hardware counters are read on Linux only")
+{
+}
+
+HardwareCounters::Region HardwareCounters::start() const
+{
+	return Region();
+}
+
+HardwareCounters::Counts HardwareCounters::Region::stop()
+{
+	return Counts();
+}
+
+void HardwareCounters::Region::close()
+{
+}
+#endif
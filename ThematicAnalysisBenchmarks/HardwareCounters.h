@@ -0,0 +1,65 @@
+﻿#pragma once
+#include <array>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * \brief CPU counters of the process threads read by perf_event_open on Linux. Events which can't be opened
+ * (other systems, perf_event_paranoid, virtual machines without PMU) aren't measured, timings don't depend on them
+ */
+class HardwareCounters
+{
+public:
+	static const size_t EVENTS_COUNT = 5;
+	static const std::array<std::string_view, EVENTS_COUNT> EVENTS_NAMES;
+
+	struct Counts
+	{
+		// scaled by enabled / running time when events are multiplexed
+		std::array<double, EVENTS_COUNT> values = {};
+		std::array<bool, EVENTS_COUNT> isMeasured = {};
+
+		Counts& operator+=(Counts const& other);
+		bool isEmpty() const;
+	};
+
+	/**
+	 * \brief counters of all threads which exist at the start, threads started later are counted when they finish
+	 */
+	class Region
+	{
+	public:
+		Region() = default;
+		Region(Region&& other) noexcept;
+		Region& operator=(Region&& other) noexcept;
+		Region(Region const&) = delete;
+		Region& operator=(Region const&) = delete;
+		~Region();
+
+		Counts stop();
+
+	private:
+		friend class HardwareCounters;
+		struct Counter
+		{
+			int descriptor;
+			size_t event;
+		};
+
+		void close();
+
+		std::vector<Counter> _counters;
+	};
+
+	// checks which events can be opened
+	HardwareCounters();
+	bool isAvailable() const;
+	// why some events aren't measured, empty when all of them are
+	std::string const& unavailableReason() const;
+	Region start() const;
+
+private:
+	std::array<bool, EVENTS_COUNT> _isEventAvailable = {};
+	std::string _unavailableReason;
+};
@@ -0,0 +1,345 @@
+﻿#include "SyntheticData.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <sstream>
+#include <stdexcept>
+
+#include "ArticlesReader/XmlArticlesReader.h"
+
+// in [0, 1) from the high 53 bits
+double getUniform(uint64_t random)
+{
+	return static_cast<double>(random >> 11) * 0x1.0p-53;
+}
+
+/**
+ * \brief splitmix64, its sequence is defined by the seed only
+ */
+class SyntheticRandom
+{
+public:
+	explicit SyntheticRandom(uint64_t seed) : _state(seed)
+	{
+	}
+
+	uint64_t next()
+	{
+		auto z = (_state += 0x9E3779B97F4A7C15ull);
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+		return z ^ (z >> 31);
+	}
+
+	// in [0, 1)
+	double nextDouble()
+	{
+		return getUniform(next());
+	}
+
+	// in [0, count)
+	size_t nextIndex(size_t count)
+	{
+		return static_cast<size_t>(next() % count);
+	}
+
+private:
+	uint64_t _state;
+};
+
+// random numbers of each article or term start from their own seed
+uint64_t combineSeed(uint64_t seed, size_t index)
+{
+	return SyntheticRandom(seed ^ (static_cast<uint64_t>(index) * 0xD1B54A32D192ED03ull)).next();
+}
+
+ZipfDistribution::ZipfDistribution(size_t count, double exponent)
+{
+	if (count == 0)
+		throw std::logic_error("Zipf distribution of no ranks");
+	_cumulative.reserve(count);
+	double sum = 0;
+	for (size_t rank = 1; rank <= count; rank++)
+		_cumulative.push_back(sum += 1 / std::pow(static_cast<double>(rank), exponent));
+	for (auto& value : _cumulative)
+		value /= sum;
+}
+
+size_t ZipfDistribution::operator()(uint64_t random) const
+{
+	auto it = std::upper_bound(_cumulative.begin(), _cumulative.end(), getUniform(random));
+	return std::min(static_cast<size_t>(it - _cumulative.begin()), _cumulative.size() - 1);
+}
+
+// cp1251 letters: syllables are a consonant and a vowel, words end with a consonant which isn't an inflection
+constexpr std::array<unsigned char, 20> CONSONANTS = { 0xE1, 0xE2, 0xE3, 0xE4, 0xE6, 0xE7, 0xEA, 0xEB, 0xEC, 0xED, 0xEF, 0xF0, 0xF1, 0xF2, 0xF4, 0xF5, 0xF6, 0xF7, 0xF8, 0xF9 };
+constexpr std::array<unsigned char, 6> VOWELS = { 0xE0, 0xE5, 0xE8, 0xEE, 0xF3, 0xFB };
+constexpr std::array<unsigned char, 6> FINALS = { 0xF2, 0xED, 0xF0, 0xF1, 0xEA, 0xEB };
+const char DASH = static_cast<char>(0x97);
+
+void appendSyllable(std::string& word, size_t syllable)
+{
+	word += static_cast<char>(CONSONANTS[syllable / VOWELS.size()]);
+	word += static_cast<char>(VOWELS[syllable % VOWELS.size()]);
+}
+
+/**
+ * \brief the first syllable is index % syllables count, the next ones are digits of the rest of index, so words are unique
+ */
+std::string SyntheticCorpusGenerator::getWord(size_t index)
+{
+	const size_t syllablesCount = CONSONANTS.size() * VOWELS.size();
+	std::string word;
+	appendSyllable(word, index % syllablesCount);
+	auto rest = index / syllablesCount;
+	do
+	{
+		appendSyllable(word, rest % syllablesCount);
+		rest /= syllablesCount;
+	} while (rest > 0);
+	word += static_cast<char>(FINALS[index % FINALS.size()]);
+	return word;
+}
+
+std::string SyntheticCorpusGenerator::toUpper(std::string text)
+{
+	for (auto& c : text)
+		if (static_cast<unsigned char>(c) >= 0xE0)
+			c = static_cast<char>(static_cast<unsigned char>(c) - 0x20);
+	return text;
+}
+
+std::string joinWords(std::vector<std::string> const& words)
+{
+	std::string text;
+	for (auto const& word : words)
+	{
+		if (!text.empty()) text += ' ';
+		text += word;
+	}
+	return text;
+}
+
+SyntheticCorpusOptions SyntheticCorpusOptions::scaledToMathCorpus(double scale, uint64_t seed)
+{
+	SyntheticCorpusOptions options;
+	options.seed = seed;
+	options.articlesCount = std::max<size_t>(1, static_cast<size_t>(std::llround(1035 * scale)));
+	options.vocabularySize = std::max<size_t>(100, static_cast<size_t>(std::llround(30000 * std::pow(scale, 0.6))));
+	return options;
+}
+
+SyntheticCorpusGenerator::SyntheticCorpusGenerator(SyntheticCorpusOptions options) :
+	_options(options),
+	_words(options.vocabularySize, options.wordsExponent),
+	_mentions(options.articlesCount, options.mentionsExponent)
+{
+	if (_options.minArticleWords > _options.maxArticleWords || _options.maxTitleWords == 0)
+		throw std::logic_error("Wrong synthetic corpus options");
+}
+
+std::vector<std::string> SyntheticCorpusGenerator::getTitleWords(size_t articleIndex) const
+{
+	SyntheticRandom random(combineSeed(_options.seed, articleIndex));
+	std::vector<std::string> words = { getWord(_options.vocabularySize + articleIndex) };
+	auto wordsCount = 1 + random.nextIndex(_options.maxTitleWords);
+	while (words.size() < wordsCount)
+		words.push_back(getWord(_words(random.next())));
+	return words;
+}
+
+std::string SyntheticCorpusGenerator::getContent(size_t articleIndex) const
+{
+	SyntheticRandom random(combineSeed(~_options.seed, articleIndex));
+	auto wordsCount = _options.minArticleWords + random.nextIndex(_options.maxArticleWords - _options.minArticleWords + 1);
+	std::string content;
+	for (size_t i = 0; i < wordsCount; i++)
+	{
+		if (i > 0)
+			content += i % 16 == 0 ? ". " : random.nextIndex(12) == 0 ? ", " : " ";
+		if (random.nextDouble() < _options.mentionRate)
+			content += joinWords(getTitleWords(_mentions(random.next())));
+		else
+			content += getWord(_words(random.next()));
+	}
+	return content + '.';
+}
+
+void SyntheticCorpusGenerator::generate(IArticlesReader::ArticleHandler const& onArticle) const
+{
+	for (size_t i = 0; i < _options.articlesCount; i++)
+		onArticle(toUpper(joinWords(getTitleWords(i))), getContent(i));
+}
+
+/**
+ * \brief headings are upper case titles after a blank line followed by a dash and lower case content
+ */
+void SyntheticCorpusGenerator::writeMathArticles(std::ostream& out) const
+{
+	generate([&out](std::string_view title, std::string_view content)
+		{
+			out << "\n\n" << title << ' ' << DASH << ' ' << content;
+		});
+	out << '\n';
+}
+
+void SyntheticCorpusGenerator::writeXmlArticles(std::ostream& out) const
+{
+	generate([&out](std::string_view title, std::string_view content)
+		{
+			out << "<paper>\n<paperName>\n<name>\n" << title << "\n</name>\n</paperName>\n<content>\n" << content << "\n</content>\n</paper>\n";
+		});
+}
+
+SyntheticGraphOptions SyntheticGraphOptions::scaledToMathGraph(double scale, uint64_t seed)
+{
+	SyntheticGraphOptions options;
+	options.seed = seed;
+	options.termsCount = std::max<size_t>(2, static_cast<size_t>(std::llround(4838 * scale)));
+	options.vocabularySize = std::max<size_t>(100, static_cast<size_t>(std::llround(8000 * std::pow(scale, 0.6))));
+	return options;
+}
+
+SyntheticGraphGenerator::SyntheticGraphGenerator(SyntheticGraphOptions options) :
+	_options(options),
+	_words(options.vocabularySize, 1.0),
+	_targets(options.termsCount, options.targetsExponent)
+{
+	if (_options.termsCount < 2 || _options.maxTermWords == 0 || _options.degreeExponent <= 1)
+		throw std::logic_error("Wrong synthetic graph options");
+}
+
+/**
+ * \brief the first word is out of the vocabulary and unique for each term, so terms hashes differ
+ */
+std::vector<std::string> SyntheticGraphGenerator::getTermWords(size_t termIndex) const
+{
+	SyntheticRandom random(combineSeed(_options.seed, termIndex));
+	std::vector<std::string> words = { SyntheticCorpusGenerator::getWord(_options.vocabularySize + termIndex) };
+	auto wordsCount = 1 + random.nextIndex(_options.maxTermWords);
+	while (words.size() < wordsCount)
+		words.push_back(SyntheticCorpusGenerator::getWord(_words(random.next())));
+	return words;
+}
+
+/**
+ * \brief count of links has Pareto distribution with the average degree mean, targets are distinct
+ */
+std::vector<size_t> SyntheticGraphGenerator::getTargets(size_t termIndex) const
+{
+	SyntheticRandom random(combineSeed(~_options.seed, termIndex));
+	auto const exponent = _options.degreeExponent;
+	auto minDegree = _options.averageDegree * (exponent - 1) / exponent;
+	auto degree = minDegree / std::pow(1 - random.nextDouble(), 1 / exponent);
+	auto targetsCount = std::min(_options.termsCount - 1, static_cast<size_t>(degree));
+
+	std::vector<size_t> targets;
+	targets.reserve(targetsCount);
+	for (size_t attempt = 0; targets.size() < targetsCount && attempt < 4 * targetsCount; attempt++)
+	{
+		auto target = _targets(random.next());
+		if (target != termIndex && std::find(targets.begin(), targets.end(), target) == targets.end())
+			targets.push_back(target);
+	}
+	return targets;
+}
+
+void SyntheticGraphGenerator::write(std::ostream& out) const
+{
+	out << _options.termsCount << '\n';
+	for (size_t i = 0; i < _options.termsCount; i++)
+	{
+		auto words = getTermWords(i);
+		auto articlesCount = 1 + static_cast<size_t>(static_cast<double>(_options.termsCount) / 100 / std::pow(static_cast<double>(i + 1), _options.targetsExponent));
+		out << SyntheticCorpusGenerator::toUpper(joinWords(words)) << '\n' << 0 << ' ' << articlesCount << ' ' << words.size() << ' ';
+		for (auto const& word : words)
+			out << word << ' ';
+		out << '\n';
+	}
+
+	size_t linksCount = 0;
+	for (size_t i = 0; i < _options.termsCount; i++)
+		linksCount += getTargets(i).size();
+	out << linksCount << '\n';
+	for (size_t i = 0; i < _options.termsCount; i++)
+	{
+		SyntheticRandom random(combineSeed(_options.seed + 1, i));
+		for (auto target : getTargets(i))
+			out << i << ' ' << target << ' ' << random.nextDouble() * 0.1 << '\n';
+	}
+}
+
+/**
+ * \brief words of terms which are likely linked, mixed with vocabulary words
+ */
+std::vector<std::string> SyntheticGraphGenerator::generateText(size_t wordsCount, uint64_t seed) const
+{
+	SyntheticRandom random(seed);
+	std::vector<std::string> words;
+	while (words.size() < wordsCount)
+	{
+		if (random.nextIndex(4) == 0)
+		{
+			auto termWords = getTermWords(_targets(random.next()));
+			words.insert(words.end(), termWords.begin(), termWords.end());
+		}
+		else
+			words.push_back(SyntheticCorpusGenerator::getWord(_words(random.next())));
+	}
+	words.resize(wordsCount);
+	return words;
+}
+
+std::vector<std::string> collectArticles(SyntheticCorpusGenerator const& generator)
+{
+	std::vector<std::string> articles;
+	generator.generate([&articles](std::string_view title, std::string_view content)
+		{
+			articles.emplace_back(title);
+			articles.emplace_back(content);
+		});
+	return articles;
+}
+
+std::string writeGraph(SyntheticGraphOptions const& options)
+{
+	std::ostringstream out;
+	SyntheticGraphGenerator(options).write(out);
+	return out.str();
+}
+
+/**
+ * \brief small corpus and graph are generated, so the check is cheap enough to run before the benchmarks
+ */
+void checkSyntheticGenerators()
+{
+	auto corpusOptions = SyntheticCorpusOptions::scaledToMathCorpus(0.05, 7);
+	auto articles = collectArticles(SyntheticCorpusGenerator(corpusOptions));
+	if (articles != collectArticles(SyntheticCorpusGenerator(corpusOptions)))
+		throw std::logic_error("Synthetic corpus differs for the same seed");
+	auto otherCorpusOptions = corpusOptions;
+	otherCorpusOptions.seed++;
+	if (articles == collectArticles(SyntheticCorpusGenerator(otherCorpusOptions)))
+		throw std::logic_error("Synthetic corpus doesn't depend on the seed");
+
+	std::ostringstream xml;
+	SyntheticCorpusGenerator(corpusOptions).writeXmlArticles(xml);
+	std::vector<std::string> xmlArticles;
+	XmlArticlesReader().read(xml.str(), [&xmlArticles](std::string_view title, std::string_view content)
+		{
+			xmlArticles.emplace_back(title);
+			xmlArticles.emplace_back(content);
+		});
+	if (articles != xmlArticles)
+		throw std::logic_error("Synthetic XML corpus isn't read as generated");
+
+	auto graphOptions = SyntheticGraphOptions::scaledToMathGraph(0.05, 7);
+	auto graph = writeGraph(graphOptions);
+	auto otherGraphOptions = graphOptions;
+	otherGraphOptions.seed++;
+	if (graph != writeGraph(graphOptions) || graph == writeGraph(otherGraphOptions))
+		throw std::logic_error("Synthetic graph doesn't depend on the seed only");
+	SyntheticGraphGenerator generator(graphOptions);
+	if (generator.generateText(100, 7) != generator.generateText(100, 7) || generator.generateText(100, 7) == generator.generateText(100, 8))
+		throw std::logic_error("Synthetic text doesn't depend on the seed only");
+}
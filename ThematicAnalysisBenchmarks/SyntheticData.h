@@ -0,0 +1,111 @@
+﻿#pragma once
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "ArticlesReader/IArticlesReader.h"
+
+/**
+ * \brief ranks with probabilities proportional to 1 / (rank + 1)^exponent. Ranks are computed from raw
+ * random numbers, so the results don't depend on the standard library
+ */
+class ZipfDistribution
+{
+public:
+	ZipfDistribution(size_t count, double exponent);
+	size_t operator()(uint64_t random) const;
+
+private:
+	std::vector<double> _cumulative;
+};
+
+struct SyntheticCorpusOptions
+{
+	uint64_t seed = 1;
+	size_t articlesCount = 1000;
+	size_t vocabularySize = 30000;
+	// of the content words frequencies
+	double wordsExponent = 1.0;
+	size_t minArticleWords = 20;
+	size_t maxArticleWords = 660;
+	size_t maxTitleWords = 3;
+	// part of content positions where a title of some article is mentioned
+	double mentionRate = 0.05;
+	// of the mentioned titles frequencies, the first articles are mentioned most
+	double mentionsExponent = 1.1;
+
+	// about scale sizes of math/adobe1.txt, the vocabulary grows slower than the corpus
+	static SyntheticCorpusOptions scaledToMathCorpus(double scale, uint64_t seed = 1);
+};
+
+/**
+ * \brief seeded generator of articles in cp1251, the same options give the same articles.
+ * Articles are generated one by one, so corpora larger than memory can be written
+ */
+class SyntheticCorpusGenerator
+{
+public:
+	explicit SyntheticCorpusGenerator(SyntheticCorpusOptions options);
+
+	void generate(IArticlesReader::ArticleHandler const& onArticle) const;
+	// format of MathArticlesReader
+	void writeMathArticles(std::ostream& out) const;
+	// format of XmlArticlesReader
+	void writeXmlArticles(std::ostream& out) const;
+
+	// lower case word, words of different indexes differ
+	static std::string getWord(size_t index);
+	static std::string toUpper(std::string text);
+
+private:
+	// the first word is unique for each article, so titles differ
+	std::vector<std::string> getTitleWords(size_t articleIndex) const;
+	std::string getContent(size_t articleIndex) const;
+
+	SyntheticCorpusOptions _options;
+	ZipfDistribution _words;
+	ZipfDistribution _mentions;
+};
+
+struct SyntheticGraphOptions
+{
+	uint64_t seed = 1;
+	size_t termsCount = 5000;
+	size_t vocabularySize = 8000;
+	size_t maxTermWords = 3;
+	double averageDegree = 27;
+	// Pareto exponent of outgoing links counts, greater than 1
+	double degreeExponent = 2;
+	// of the linked terms, the first terms get the most incoming links
+	double targetsExponent = 1.0;
+
+	// about scale sizes of resources/coolAllMath.gr
+	static SyntheticGraphOptions scaledToMathGraph(double scale, uint64_t seed = 1);
+};
+
+/**
+ * \brief seeded generator of graphs in the SemanticGraph export format. Links of a term are generated
+ * from its own seed, so they are generated twice (to count and to write) instead of being kept in memory
+ */
+class SyntheticGraphGenerator
+{
+public:
+	explicit SyntheticGraphGenerator(SyntheticGraphOptions options);
+
+	void write(std::ostream& out) const;
+	// normalized words of the graph terms and vocabulary, for tagging without lemmatization
+	std::vector<std::string> generateText(size_t wordsCount, uint64_t seed) const;
+
+private:
+	std::vector<std::string> getTermWords(size_t termIndex) const;
+	std::vector<size_t> getTargets(size_t termIndex) const;
+
+	SyntheticGraphOptions _options;
+	ZipfDistribution _words;
+	ZipfDistribution _targets;
+};
+
+// generators give the same data for the same seed and other data for another seed, the XML corpus is read
+// by XmlArticlesReader as generated, throw std::logic_error otherwise
+void checkSyntheticGenerators();
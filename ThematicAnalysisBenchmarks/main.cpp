@@ -0,0 +1,602 @@
+﻿#include <algorithm>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <optional>
+#include <sstream>
+
+#include "BenchmarkRunner.h"
+#include "SyntheticData.h"
+#include "ArticlesNormalizer.h"
+#include "FrozenSemanticGraph.h"
+#include "SemanticGraphBuilder.h"
+#include "TagsAnalyzer.h"
+#include "TextNormalizer.h"
+#include "ArticlesReader/MathArticlesReader.h"
+#include "ArticlesReader/XmlArticlesReader.h"
+#include "Lemmatizer/StubLemmatizer.h"
+#include "Utils/FileUtils.h"
+#include "Utils/MappedFile.h"
+#include "Utils/Profiler.h"
+#include "Utils/StringUtils.h"
+#include "Utils/TermsUtils.h"
+#include "Utils/ThreadPool.h"
+
+struct Options
+{
+	size_t iterationsCount = 10;
+	size_t warmupCount = 1;
+	size_t threadsCount = 0;
+	double tolerance = 0.1;
+	uint64_t seed = 1;
+	std::string filter;
+	std::string resourcesDirectory = "../ThematicAnalysis/resources";
+	std::string outputPath;
+	std::string baselinePath;
+	// scales of synthetic data relative to the math corpus
+	std::vector<std::string> scales;
+	std::string syntheticDirectory = "synthetic";
+	bool isCountersEnabled = false;
+	bool isAllocationsEnabled = false;
+};
+
+void printUsage()
+{
+	std::cerr << "usage: ThematicAnalysisBenchmarks [--filter text] [--iterations 10] [--warmup 1] [--threads 0]\n"
+		"  [--resources ../ThematicAnalysis/resources] [--output results.json] [--baseline baseline.json] [--tolerance 0.1]\n"
+		"  [--scales 10,100] [--synthetic synthetic] [--seed 1] [--counters] [--allocations]\n"
+		"--counters adds per unit hardware counters (Linux perf_event_open) when they are available\n"
+		"--allocations adds allocations per iteration by profiler stages, timings are slower meanwhile\n"
+		"synthetic data of each scale is generated into the synthetic directory once\n"
+		"exit code is 1 when a median is slower than the baseline by more than the tolerance\n";
+}
+
+std::optional<Options> parseOptions(int argc, char* argv[])
+{
+	Options options;
+	for (int i = 1; i < argc; i++)
+	{
+		std::string name = argv[i];
+		if (name == "--counters")
+		{
+			options.isCountersEnabled = true;
+			continue;
+		}
+		if (name == "--allocations")
+		{
+			options.isAllocationsEnabled = true;
+			continue;
+		}
+		if (i + 1 == argc)
+			return std::nullopt;
+		std::string value = argv[++i];
+		try
+		{
+			if (name == "--filter") options.filter = value;
+			else if (name == "--iterations") options.iterationsCount = std::stoul(value);
+			else if (name == "--warmup") options.warmupCount = std::stoul(value);
+			else if (name == "--threads") options.threadsCount = std::stoul(value);
+			else if (name == "--tolerance") options.tolerance = std::stod(value);
+			else if (name == "--resources") options.resourcesDirectory = value;
+			else if (name == "--output") options.outputPath = value;
+			else if (name == "--baseline") options.baselinePath = value;
+			else if (name == "--scales") options.scales = StringUtils::split(value, ",", true);
+			else if (name == "--synthetic") options.syntheticDirectory = value;
+			else if (name == "--seed") options.seed = std::stoull(value);
+			else return std::nullopt;
+		}
+		catch (std::exception const&)
+		{
+			return std::nullopt;
+		}
+	}
+	return options;
+}
+
+const size_t HUBS_COUNT = 16;
+
+/**
+ * \brief bundled files, the graphs are imported or built only when a benchmark needs them. Texts are lemmatized by the stub
+ * lemmatizer, so results don't depend on mystem and its process start
+ */
+class BenchmarkData
+{
+public:
+	explicit BenchmarkData(std::string resourcesDirectory) :
+		_resourcesDirectory(std::move(resourcesDirectory)),
+		_lemmatizer(std::make_shared<StubLemmatizer>(StubLemmatizer::Mode::SuffixStripping))
+	{
+	}
+
+	std::string getPath(std::string const& fileName) const
+	{
+		return _resourcesDirectory + "/" + fileName;
+	}
+
+	std::shared_ptr<ILemmatizer const> lemmatizer() const
+	{
+		return _lemmatizer;
+	}
+
+	// export isn't const
+	SemanticGraph& graph()
+	{
+		if (!_graph)
+		{
+			_graph.emplace();
+			_graph->importFromFile(getPath("coolAllMath.gr"));
+		}
+		return *_graph;
+	}
+
+	// coolAllMath.gr is built with mystem, so texts normalized by the stub would miss most of its terms.
+	// Texts are looked up in a graph built from the math articles with the same lemmatizer
+	SemanticGraph const& textsGraph()
+	{
+		if (!_textsGraph)
+			_textsGraph.emplace(SemanticGraphBuilder(_lemmatizer).buildFromFile(getPath("math/adobe1.txt"), MathArticlesReader()));
+		return *_textsGraph;
+	}
+
+	// terms with the most neighbors, the centers of the largest neighborhoods
+	std::vector<size_t> const& hubs()
+	{
+		if (_hubs.empty())
+		{
+			std::vector<std::pair<size_t, size_t>> degrees;
+			for (auto const& [hash, node] : graph().nodes)
+				degrees.emplace_back(node.neighbors.size(), hash);
+			auto hubsCount = std::min<size_t>(HUBS_COUNT, degrees.size());
+			std::partial_sort(degrees.begin(), degrees.begin() + hubsCount, degrees.end(), std::greater<>());
+			for (size_t i = 0; i < hubsCount; i++)
+				_hubs.push_back(degrees[i].second);
+		}
+		return _hubs;
+	}
+
+private:
+	std::string _resourcesDirectory;
+	std::shared_ptr<ILemmatizer const> _lemmatizer;
+	std::optional<SemanticGraph> _graph;
+	std::optional<SemanticGraph> _textsGraph;
+	std::vector<size_t> _hubs;
+};
+
+struct TextFile
+{
+	std::string name;
+	bool isUTF8;
+};
+
+std::string readText(BenchmarkData const& data, TextFile const& file)
+{
+	auto path = data.getPath(file.name);
+	return file.isUTF8 ? FileUtils::readAllUTF8File(path) : FileUtils::readAllFile(path);
+}
+
+void addGraphBenchmarks(BenchmarkRunner& runner, BenchmarkData& data)
+{
+	auto const graphPath = data.getPath("coolAllMath.gr");
+	auto const graphSize = static_cast<size_t>(std::filesystem::file_size(graphPath));
+	runner.add("graph/import", "bytes", [graphPath, graphSize]
+		{
+			SemanticGraph graph;
+			graph.importFromFile(graphPath);
+			return graphSize;
+		});
+	runner.add("graph/export", "bytes", [&data]
+		{
+			std::ostringstream out;
+			data.graph().exportToStream(out);
+			return out.str().size();
+		}, [&data] {data.graph(); });
+	runner.add("graph/neighborhood/radius1", "calls", [&data]
+		{
+			for (auto hash : data.hubs())
+				data.graph().getNeighborhood(hash, 1);
+			return data.hubs().size();
+		}, [&data] {data.hubs(); });
+	runner.add("graph/neighborhood/radius2", "calls", [&data]
+		{
+			for (auto hash : data.hubs())
+				data.graph().getNeighborhood(hash, 2, 0.05);
+			return data.hubs().size();
+		}, [&data] {data.hubs(); });
+}
+
+void addArticlesBenchmarks(BenchmarkRunner& runner, BenchmarkData& data)
+{
+	auto const articlesPath = data.getPath("math/adobe1.txt");
+	runner.add("articles/read", "bytes", [articlesPath]
+		{
+			MappedFile file(articlesPath);
+			size_t articlesCount = 0;
+			MathArticlesReader().read(file.view(), [&articlesCount](std::string_view, std::string_view) {articlesCount++; });
+			return file.size();
+		});
+	runner.add("articles/readParallel", "bytes", [articlesPath]
+		{
+			MappedFile file(articlesPath);
+			size_t articlesCount = 0;
+			MathArticlesReader().readParallel(file.view(), [&articlesCount](std::string_view, std::string_view) {articlesCount++; });
+			return file.size();
+		});
+	runner.add("articles/normalize", "bytes", [articlesPath, &data]
+		{
+			MappedFile file(articlesPath);
+			size_t wordsCount = 0;
+			ArticlesNormalizer(data.lemmatizer()).readAndNormalizeArticles(file.view(), MathArticlesReader(),
+				[&wordsCount](NormalizedArticle&& article) {wordsCount += article.text.size(); });
+			return file.size();
+		});
+	auto const articlesSize = static_cast<size_t>(std::filesystem::file_size(articlesPath));
+	runner.add("build/adobe1", "bytes", [articlesPath, articlesSize, &data]
+		{
+			SemanticGraphBuilder builder(data.lemmatizer());
+			builder.buildFromFile(articlesPath, MathArticlesReader());
+			return articlesSize;
+		});
+}
+
+// tags are taken as the application does
+const size_t TAGS_COUNT = 100;
+
+void addTextsBenchmarks(BenchmarkRunner& runner, BenchmarkData& data)
+{
+	std::vector<TextFile> const files = { {"integral.txt", true}, {"temp.txt", true}, {"giperbola.txt", false}, {"voevoda.txt", false} };
+	for (auto const& file : files)
+	{
+		auto text = std::make_shared<std::string>(readText(data, file));
+		auto words = std::make_shared<std::vector<std::string>>(TextNormalizer(data.lemmatizer()).normalize(*text));
+		runner.add("terms/extract/" + file.name, "words", [words, &data]
+			{
+				TermsUtils::extractTermsCounts(data.textsGraph(), *words);
+				return words->size();
+			}, [&data] {data.textsGraph(); });
+		runner.add("tags/analyze/" + file.name, "bytes", [text, &data]
+			{
+				TagsAnalyzer analyzer(data.lemmatizer());
+				analyzer.analyze(*text, data.textsGraph());
+				analyzer.getRelevantTags(TAGS_COUNT);
+				return text->size();
+			}, [&data] {data.textsGraph(); });
+	}
+}
+
+/**
+ * \brief frozen graph in a nodes order, it's frozen when a benchmark needs it first
+ */
+class FrozenData
+{
+public:
+	FrozenData(std::function<SemanticGraph const& ()> getGraph, NodesOrdering::Order order) : _getGraph(std::move(getGraph)), _order(order)
+	{
+	}
+
+	SemanticGraph const& source() const
+	{
+		return _getGraph();
+	}
+
+	FrozenSemanticGraph<float> const& graph()
+	{
+		if (!_graph)
+			_graph.emplace(source(), _order);
+		return *_graph;
+	}
+
+	// nodes with the most outgoing links, the same in each order
+	std::vector<size_t> const& hubs()
+	{
+		if (_hubs.empty())
+		{
+			auto& frozen = graph();
+			std::vector<std::pair<size_t, size_t>> degrees;
+			for (FrozenSemanticGraph<float>::Index i = 0; i < frozen.nodesCount(); i++)
+				degrees.emplace_back(frozen.getLinksEnd(i) - frozen.getLinksBegin(i), frozen.terms().getHash(i));
+			auto hubsCount = std::min<size_t>(HUBS_COUNT, degrees.size());
+			std::partial_sort(degrees.begin(), degrees.begin() + hubsCount, degrees.end(), std::greater<>());
+			for (size_t i = 0; i < hubsCount; i++)
+				_hubs.push_back(degrees[i].second);
+		}
+		return _hubs;
+	}
+
+	// each term is in the text once
+	std::vector<double> const& termsWeights()
+	{
+		if (_termsWeights.empty())
+			_termsWeights.assign(graph().nodesCount(), 1.);
+		return _termsWeights;
+	}
+
+	std::vector<FrozenSemanticGraph<float>::Index> const& terms()
+	{
+		if (_terms.empty())
+		{
+			_terms.resize(graph().nodesCount());
+			std::iota(_terms.begin(), _terms.end(), 0);
+		}
+		return _terms;
+	}
+
+	std::vector<size_t> const& termsCounts()
+	{
+		if (_termsCounts.empty())
+			_termsCounts.assign(graph().nodesCount(), 1);
+		return _termsCounts;
+	}
+
+private:
+	std::function<SemanticGraph const& ()> _getGraph;
+	NodesOrdering::Order _order;
+	std::optional<FrozenSemanticGraph<float>> _graph;
+	std::vector<size_t> _hubs;
+	std::vector<double> _termsWeights;
+	std::vector<FrozenSemanticGraph<float>::Index> _terms;
+	std::vector<size_t> _termsCounts;
+};
+
+/**
+ * \brief freezing, tf-idf and propagation of weights of all terms and neighborhoods of hubs over the graph frozen in each nodes order
+ */
+void addFrozenBenchmarks(BenchmarkRunner& runner, std::string const& prefix, std::function<SemanticGraph const& ()> const& getGraph)
+{
+	for (auto order : NodesOrdering::ORDERS)
+	{
+		auto frozen = std::make_shared<FrozenData>(getGraph, order);
+		auto const orderPrefix = prefix + "frozen/" + NodesOrdering::getName(order) + "/";
+		runner.add(orderPrefix + "freeze", "links", [frozen, order]
+			{
+				return FrozenSemanticGraph<float>(frozen->source(), order).getLinksCount();
+			}, [frozen] {frozen->source(); });
+		runner.add(orderPrefix + "tfidf", "terms", [frozen]
+			{
+				std::vector<double> weights(frozen->graph().nodesCount());
+				frozen->graph().idf().addTfIdf(frozen->terms(), frozen->termsCounts(), weights);
+				return weights.size();
+			}, [frozen] {frozen->terms(); frozen->termsCounts(); });
+		runner.add(orderPrefix + "propagation", "links", [frozen]
+			{
+				TagsAnalyzer::distributeTermsWeights(frozen->graph(), frozen->termsWeights());
+				return frozen->graph().getLinksCount();
+			}, [frozen] {frozen->termsWeights(); });
+		runner.add(orderPrefix + "neighborhood/radius1", "calls", [frozen]
+			{
+				for (auto hash : frozen->hubs())
+					frozen->graph().getNeighborhood(hash, 1);
+				return frozen->hubs().size();
+			}, [frozen] {frozen->hubs(); });
+		runner.add(orderPrefix + "neighborhood/radius2", "calls", [frozen]
+			{
+				for (auto hash : frozen->hubs())
+					frozen->graph().getNeighborhood(hash, 2, 0.05);
+				return frozen->hubs().size();
+			}, [frozen] {frozen->hubs(); });
+	}
+}
+
+const size_t TAGGED_WORDS_COUNT = 1000;
+
+/**
+ * \brief synthetic corpus and graph of a scale, files are generated when they are needed first and reused by the next runs
+ */
+class ScaledData
+{
+public:
+	ScaledData(std::string const& directory, std::string scale, uint64_t seed) :
+		_scale(std::stod(scale)), _seed(seed),
+		_corpusPath(directory + "/math-x" + scale + "-seed" + std::to_string(seed) + ".txt"),
+		_xmlCorpusPath(directory + "/math-x" + scale + "-seed" + std::to_string(seed) + ".xml"),
+		_graphPath(directory + "/graph-x" + scale + "-seed" + std::to_string(seed) + ".gr"),
+		_directory(directory)
+	{
+	}
+
+	std::string const& corpusPath() const
+	{
+		if (!std::filesystem::exists(_corpusPath))
+			generate(_corpusPath, [this](std::ostream& out)
+				{
+					SyntheticCorpusGenerator(SyntheticCorpusOptions::scaledToMathCorpus(_scale, _seed)).writeMathArticles(out);
+				});
+		return _corpusPath;
+	}
+
+	// the same articles in the format of XmlArticlesReader
+	std::string const& xmlCorpusPath() const
+	{
+		if (!std::filesystem::exists(_xmlCorpusPath))
+			generate(_xmlCorpusPath, [this](std::ostream& out)
+				{
+					SyntheticCorpusGenerator(SyntheticCorpusOptions::scaledToMathCorpus(_scale, _seed)).writeXmlArticles(out);
+				});
+		return _xmlCorpusPath;
+	}
+
+	std::string const& graphPath() const
+	{
+		if (!std::filesystem::exists(_graphPath))
+			generate(_graphPath, [this](std::ostream& out)
+				{
+					SyntheticGraphGenerator(SyntheticGraphOptions::scaledToMathGraph(_scale, _seed)).write(out);
+				});
+		return _graphPath;
+	}
+
+	// sizes of the files are taken once, so iterations don't map the files for them
+	size_t corpusSize()
+	{
+		if (_corpusSize == 0)
+			_corpusSize = static_cast<size_t>(std::filesystem::file_size(corpusPath()));
+		return _corpusSize;
+	}
+
+	size_t xmlCorpusSize()
+	{
+		if (_xmlCorpusSize == 0)
+			_xmlCorpusSize = static_cast<size_t>(std::filesystem::file_size(xmlCorpusPath()));
+		return _xmlCorpusSize;
+	}
+
+	size_t graphSize()
+	{
+		if (_graphSize == 0)
+			_graphSize = static_cast<size_t>(std::filesystem::file_size(graphPath()));
+		return _graphSize;
+	}
+
+	SemanticGraph const& graph()
+	{
+		if (!_graph)
+		{
+			_graph.emplace();
+			_graph->importFromFile(graphPath());
+		}
+		return *_graph;
+	}
+
+	// normalized words of a text to tag
+	std::vector<std::string> const& text()
+	{
+		if (_text.empty())
+			_text = SyntheticGraphGenerator(SyntheticGraphOptions::scaledToMathGraph(_scale, _seed)).generateText(TAGGED_WORDS_COUNT, _seed);
+		return _text;
+	}
+
+private:
+	void generate(std::string const& path, std::function<void(std::ostream&)> const& write) const
+	{
+		std::cout << "generating " << path << std::endl;
+		std::filesystem::create_directories(_directory);
+		auto temporaryPath = path + ".tmp";
+		{
+			std::ofstream out(temporaryPath, std::ios::binary);
+			write(out);
+			if (!out)
+				throw std::runtime_error("Can't write " + temporaryPath);
+		}
+		std::filesystem::rename(temporaryPath, path);
+	}
+
+	double _scale;
+	uint64_t _seed;
+	std::string _corpusPath;
+	std::string _xmlCorpusPath;
+	std::string _graphPath;
+	std::string _directory;
+	size_t _corpusSize = 0;
+	size_t _xmlCorpusSize = 0;
+	size_t _graphSize = 0;
+	std::optional<SemanticGraph> _graph;
+	std::vector<std::string> _text;
+};
+
+/**
+ * \brief build, load and tagging on synthetic data of the given scales show how they grow with data size
+ */
+void addScalingBenchmarks(BenchmarkRunner& runner, std::deque<ScaledData>& scaledData, BenchmarkData const& data, Options const& options)
+{
+	if (!options.scales.empty())
+		checkSyntheticGenerators();
+	for (auto const& scale : options.scales)
+	{
+		auto& scaled = scaledData.emplace_back(options.syntheticDirectory, scale, options.seed);
+		auto const prefix = "scaling/x" + scale + "/";
+		runner.add(prefix + "build", "bytes", [&scaled, &data]
+			{
+				SemanticGraphBuilder builder(data.lemmatizer());
+				builder.buildFromFile(scaled.corpusPath(), MathArticlesReader());
+				return scaled.corpusSize();
+			}, [&scaled] {scaled.corpusSize(); });
+		runner.add(prefix + "buildXml", "bytes", [&scaled, &data]
+			{
+				SemanticGraphBuilder builder(data.lemmatizer());
+				builder.buildFromFile(scaled.xmlCorpusPath(), XmlArticlesReader());
+				return scaled.xmlCorpusSize();
+			}, [&scaled] {scaled.xmlCorpusSize(); });
+		runner.add(prefix + "import", "bytes", [&scaled]
+			{
+				SemanticGraph graph;
+				graph.importFromFile(scaled.graphPath());
+				return scaled.graphSize();
+			}, [&scaled] {scaled.graphSize(); });
+		runner.add(prefix + "tags", "words", [&scaled, &data]
+			{
+				TagsAnalyzer analyzer(data.lemmatizer());
+				analyzer.analyze(scaled.text(), scaled.graph());
+				analyzer.getRelevantTags(TAGS_COUNT);
+				return scaled.text().size();
+			}, [&scaled] {scaled.text(); scaled.graph(); });
+		addFrozenBenchmarks(runner, prefix, [&scaled]() -> SemanticGraph const& {return scaled.graph(); });
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	auto options = parseOptions(argc, argv);
+	if (!options)
+	{
+		printUsage();
+		return 2;
+	}
+	try
+	{
+		if (options->threadsCount != 0)
+			ThreadPool::setDefaultWorkersCount(options->threadsCount);
+		BenchmarkData data(options->resourcesDirectory);
+		BenchmarkRunner runner(options->iterationsCount, options->warmupCount);
+		addGraphBenchmarks(runner, data);
+		addFrozenBenchmarks(runner, "", [&data]() -> SemanticGraph const& {return data.graph(); });
+		addArticlesBenchmarks(runner, data);
+		addTextsBenchmarks(runner, data);
+		std::deque<ScaledData> scaledData;
+		addScalingBenchmarks(runner, scaledData, data, *options);
+
+		std::cout << "lemmatizer: " << data.lemmatizer()->name() << ", threads: " << ThreadPool::instance().workersCount()
+			<< ", iterations: " << options->iterationsCount << std::endl;
+		if (options->isCountersEnabled)
+		{
+			auto isEnabled = runner.enableHardwareCounters();
+			auto counters = runner.hardwareCounters();
+			if (!isEnabled)
+				std::cout << "hardware counters are unavailable: " << HardwareCounters().unavailableReason() << std::endl;
+			else if (!counters->unavailableReason().empty())
+				std::cout << "some hardware counters are unavailable: " << counters->unavailableReason() << std::endl;
+		}
+		if (options->isAllocationsEnabled)
+		{
+			// stages are the profiler scopes
+			Profiler::setEnabled(true);
+			AllocationTracker::setEnabled(true);
+		}
+		auto results = runner.run(options->filter, std::cout);
+		if (!options->outputPath.empty())
+		{
+			std::ofstream out(options->outputPath);
+			BenchmarkRunner::exportToJson(results, out);
+		}
+		if (options->baselinePath.empty())
+			return 0;
+
+		auto comparisons = BenchmarkRunner::compare(results, BenchmarkRunner::loadBaseline(options->baselinePath), options->tolerance);
+		bool hasRegressions = false;
+		std::cout << "\nchanges of medians against " << options->baselinePath << ":\n";
+		for (auto const& comparison : comparisons)
+		{
+			std::cout << std::left << std::setw(40) << comparison.name << std::right << std::showpos << std::fixed << std::setprecision(1)
+				<< std::setw(8) << comparison.change() * 100 << '%' << std::noshowpos << (comparison.isRegression ? "  REGRESSION" : "") << '\n';
+			hasRegressions = hasRegressions || comparison.isRegression;
+		}
+		return hasRegressions ? 1 : 0;
+	}
+	catch (std::exception const& e)
+	{
+		std::cerr << e.what() << std::endl;
+		return 2;
+	}
+}
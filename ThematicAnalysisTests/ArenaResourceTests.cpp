@@ -0,0 +1,47 @@
+﻿#include "pch.h"
+#include "CppUnitTest.h"
+#include "Utils/ArenaResource.h"
+
+#include <map>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace ThematicAnalysisTests
+{
+	TEST_CLASS(ArenaResourceTests)
+	{
+	public:
+		TEST_METHOD(FreedBlocksAreReused)
+		{
+			ArenaResource arena;
+			auto first = arena.allocate(40);
+			auto second = arena.allocate(48);
+			Assert::IsTrue(first != second);
+			Assert::IsTrue(reinterpret_cast<uintptr_t>(second) % 16 == 0);
+			arena.deallocate(first, 40);
+			// the same size class
+			Assert::IsTrue(first == arena.allocate(33));
+			Assert::IsTrue(first != arena.allocate(40));
+			Assert::AreEqual(ArenaResource::MIN_CHUNK_SIZE, arena.chunksBytes());
+		}
+
+		TEST_METHOD(LargeBlocksAndChunksGrowth)
+		{
+			ArenaResource arena;
+			auto large = arena.allocate(ArenaResource::MAX_BLOCK_SIZE + 1);
+			Assert::AreEqual(0ull, arena.chunksBytes());
+			arena.deallocate(large, ArenaResource::MAX_BLOCK_SIZE + 1);
+
+			std::pmr::map<size_t, double> map(&arena);
+			for (size_t i = 0; i < 10000; i++)
+				map.emplace(i, static_cast<double>(i));
+			Assert::AreEqual(9999., map.at(9999));
+			Assert::IsTrue(arena.chunksBytes() > ArenaResource::MIN_CHUNK_SIZE);
+			auto chunksBytes = arena.chunksBytes();
+			map.clear();
+			for (size_t i = 0; i < 10000; i++)
+				map.emplace(i, 0.);
+			Assert::AreEqual(chunksBytes, arena.chunksBytes());
+		}
+	};
+}
@@ -0,0 +1,49 @@
+﻿#include "pch.h"
+#include "CppUnitTest.h"
+#include "Utils/BoundedQueue.h"
+
+#include <future>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace ThematicAnalysisTests
+{
+	TEST_CLASS(BoundedQueueTests)
+	{
+	public:
+		TEST_METHOD(ProducerConsumer)
+		{
+			BoundedQueue<size_t> queue(3);
+			auto producer = std::async(std::launch::async, [&queue]
+				{
+					for (size_t i = 0; i < 1000; i++)
+						queue.push(i);
+					queue.close();
+				});
+			size_t expected = 0, item;
+			while (queue.pop(item))
+				Assert::AreEqual(expected++, item);
+			producer.get();
+			Assert::AreEqual(1000ull, expected);
+			Assert::IsTrue(queue.maxSize() <= queue.capacity());
+			Assert::IsTrue(queue.averageSize() >= 1.);
+		}
+
+		TEST_METHOD(CloseAndCancel)
+		{
+			BoundedQueue<std::string> queue(2);
+			Assert::IsTrue(queue.push("first"));
+			queue.close();
+			std::string item;
+			Assert::IsTrue(queue.pop(item));
+			Assert::AreEqual(std::string("first"), item);
+			Assert::IsFalse(queue.pop(item));
+
+			BoundedQueue<int> fullQueue(1);
+			fullQueue.push(1);
+			auto producer = std::async(std::launch::async, [&fullQueue] {return fullQueue.push(2); });
+			fullQueue.cancel();
+			Assert::IsFalse(producer.get());
+		}
+	};
+}
@@ -0,0 +1,81 @@
+﻿#include "pch.h"
+#include <filesystem>
+#include <fstream>
+#include "CppUnitTest.h"
+#include "CorpusIngestor.h"
+#include "ArticlesReader/MathArticlesReader.h"
+#include "ArticlesReader/XmlArticlesReader.h"
+#include "Utils/FileUtils.h"
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace ThematicAnalysisTests
+{
+	TEST_CLASS(CorpusIngestorTests)
+	{
+	public:
+		TEST_METHOD(DetectEncoding)
+		{
+			Assert::IsTrue(CorpusIngestor::Encoding::UTF8 == CorpusIngestor::detectEncoding(FileUtils::readAllFile("resources/FileUtils/utf8.txt")));
+			Assert::IsTrue(CorpusIngestor::Encoding::Cp1251 == CorpusIngestor::detectEncoding(FileUtils::readAllFile("resources/FileUtils/1251.txt")));
+			Assert::IsTrue(CorpusIngestor::Encoding::Cp1251 == CorpusIngestor::detectEncoding("plain text"));
+		}
+		TEST_METHOD(SelectReader)
+		{
+			auto text = FileUtils::readAllFile("resources/XmlSourceParser/TwoPaper.txt");
+			Assert::IsNotNull(dynamic_cast<XmlArticlesReader const*>(&CorpusIngestor::selectReader("TwoPaper.txt", text)));
+			Assert::IsNotNull(dynamic_cast<XmlArticlesReader const*>(&CorpusIngestor::selectReader("corpus.xml", "")));
+			Assert::IsNotNull(dynamic_cast<MathArticlesReader const*>(&CorpusIngestor::selectReader("math.txt", "\r\n\r\nTERM - text")));
+		}
+		TEST_METHOD(IngestManifest)
+		{
+			std::ofstream("corpus.lst") << "resources/XmlSourceParser/OnePaper.txt\n# comment\n\nresources/XmlSourceParser/TwoPaper.txt\n";
+			Assert::AreEqual(2ull, CorpusIngestor::listFiles("corpus.lst").size());
+			std::vector<std::string> expectedTitles;
+			for (auto const& filePath : CorpusIngestor::listFiles("corpus.lst"))
+				XmlArticlesReader().read(FileUtils::readAllFile(filePath), [&expectedTitles](std::string_view title, std::string_view content)
+					{
+						expectedTitles.emplace_back(title);
+					});
+
+			std::vector<std::string> titles;
+			auto report = CorpusIngestor(2).ingest("corpus.lst", [&titles](std::string_view title, std::string_view content)
+				{
+					titles.emplace_back(title);
+				});
+			Assert::AreEqual(2ull, report.filesCount);
+			Assert::AreEqual(3ull, report.articlesCount);
+			Assert::IsTrue(expectedTitles == titles);
+			Assert::IsTrue(report.bytesCount > 0);
+			std::filesystem::remove("corpus.lst");
+		}
+		TEST_METHOD(ArticlesComeInFilesOrder)
+		{
+			std::vector<std::string> filePaths;
+			std::vector<std::string> expectedTitles;
+			for (size_t i = 0; i < 16; i++)
+			{
+				filePaths.push_back(i % 2 == 0 ? "resources/XmlSourceParser/TwoPaper.txt" : "resources/XmlSourceParser/OnePaper.txt");
+				XmlArticlesReader().read(FileUtils::readAllFile(filePaths.back()), [&expectedTitles](std::string_view title, std::string_view content)
+					{
+						expectedTitles.emplace_back(title);
+					});
+			}
+			for (size_t ioThreadsCount : { 1, 3, 8 })
+			{
+				std::vector<std::string> titles;
+				CorpusIngestor(ioThreadsCount).ingest(filePaths, [&titles](std::string_view title, std::string_view content)
+					{
+						titles.emplace_back(title);
+					});
+				Assert::IsTrue(expectedTitles == titles);
+			}
+		}
+		TEST_METHOD(MissingFile)
+		{
+			Assert::ExpectException<std::runtime_error>([]()
+				{
+					CorpusIngestor().ingest(std::vector<std::string>{ "resources/missing.txt" }, [](std::string_view, std::string_view) {});
+				});
+		}
+	};
+}
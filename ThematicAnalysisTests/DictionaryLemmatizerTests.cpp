@@ -0,0 +1,34 @@
+﻿#include "pch.h"
+#include "CppUnitTest.h"
+#include "Lemmatizer/DictionaryLemmatizer.h"
+
+#include <filesystem>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace ThematicAnalysisTests
+{
+	TEST_CLASS(DictionaryLemmatizerTests)
+	{
+		TEST_METHOD(WordsTest)
+		{
+			DictionaryLemmatizer lemmatizer({ {"сижу", "сидеть"}, {"интегралов", "интеграл"} });
+			std::vector<std::string> normWords = { "сидеть", "на", "интеграл" };
+			auto res = lemmatizer.lemmatizeText("Сижу на интегралов");
+			Assert::IsTrue(normWords == res);
+		}
+
+		TEST_METHOD(SaveAndLoadTest)
+		{
+			DictionaryLemmatizer lemmatizer;
+			lemmatizer.add("работы", "работа");
+			lemmatizer.add("гречневые", "гречневый");
+			lemmatizer.saveToFile("dictionary.txt");
+			auto loaded = DictionaryLemmatizer::loadFromFile("dictionary.txt");
+			std::filesystem::remove("dictionary.txt");
+
+			Assert::AreEqual(lemmatizer.size(), loaded.size());
+			Assert::IsTrue(lemmatizer.lemmatizeText("работы гречневые") == loaded.lemmatizeText("работы гречневые"));
+		}
+	};
+}
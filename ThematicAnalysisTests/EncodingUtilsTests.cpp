@@ -0,0 +1,51 @@
+﻿#include "pch.h"
+#include "CppUnitTest.h"
+#include "Utils/EncodingUtils.h"
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace ThematicAnalysisTests
+{
+	TEST_CLASS(EncodingUtilsTests)
+	{
+		// "Привет, Ёжик!" in both encodings
+		const std::string cp1251Text = "\xCF\xF0\xE8\xE2\xE5\xF2, \xA8\xE6\xE8\xEA!";
+		const std::string utf8Text = "\xD0\x9F\xD1\x80\xD0\xB8\xD0\xB2\xD0\xB5\xD1\x82, \xD0\x81\xD0\xB6\xD0\xB8\xD0\xBA!";
+	public:
+		TEST_METHOD(Cp1251ToUTF8)
+		{
+			Assert::AreEqual(utf8Text, EncodingUtils::cp1251ToUTF8(cp1251Text));
+		}
+		TEST_METHOD(UTF8ToCp1251)
+		{
+			Assert::AreEqual(cp1251Text, EncodingUtils::UTF8ToCp1251(utf8Text));
+			auto text = utf8Text;
+			EncodingUtils::UTF8ToCp1251InPlace(text);
+			Assert::AreEqual(cp1251Text, text);
+		}
+		TEST_METHOD(AllCharsRoundTrip)
+		{
+			std::string chars;
+			for (int c = 0; c < 256; c++)
+				chars += static_cast<char>(c);
+			Assert::AreEqual(chars, EncodingUtils::UTF8ToCp1251(EncodingUtils::cp1251ToUTF8(chars)));
+		}
+		TEST_METHOD(UnknownChars)
+		{
+			// "é", invalid byte and truncated sequence
+			Assert::AreEqual(std::string("?x??"), EncodingUtils::UTF8ToCp1251("\xC3\xA9x\xFF\xE2"));
+		}
+		TEST_METHOD(Classification)
+		{
+			Assert::IsTrue(EncodingUtils::isLetter('\xC0'));
+			Assert::IsTrue(EncodingUtils::isLetter('\xB8'));
+			Assert::IsTrue(EncodingUtils::isLetter('z'));
+			Assert::IsFalse(EncodingUtils::isLetter('7'));
+			Assert::IsFalse(EncodingUtils::isLetter('\xAB'));
+			Assert::IsTrue(EncodingUtils::isLetterOrDigit('7'));
+			Assert::AreEqual('\xE0', EncodingUtils::toLower('\xC0'));
+			Assert::AreEqual('\xB8', EncodingUtils::toLower('\xA8'));
+			Assert::AreEqual('a', EncodingUtils::toLower('A'));
+			Assert::AreEqual('-', EncodingUtils::toLower('-'));
+		}
+	};
+}
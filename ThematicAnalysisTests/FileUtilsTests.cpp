@@ -21,6 +21,15 @@ namespace ThematicAnalysisTests
 			Assert::AreEqual({ "You give me resources\\FileUtils\\Test.exe arg1 arg2" }, output);
 		}
 
+		TEST_METHOD(executeFileWithHandler)
+		{
+			std::string output;
+			auto res = FileUtils::executeExeWithParams("resources\\FileUtils\\Test.exe", std::vector<std::string>{ "arg1", "arg2" },
+				[&output](std::string_view chunk) {output.append(chunk); });
+			Assert::AreEqual(true, res);
+			Assert::AreEqual({ "You give me resources\\FileUtils\\Test.exe arg1 arg2" }, output);
+		}
+
 		TEST_METHOD(canNotExecuteFile)
 		{
 			std::string output;
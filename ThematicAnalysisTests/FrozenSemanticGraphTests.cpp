@@ -0,0 +1,246 @@
+﻿#include "pch.h"
+#include "CppUnitTest.h"
+#include "FrozenSemanticGraph.h"
+#include "Hasher.h"
+#include "TagsAnalyzer.h"
+#include "WeightArray.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <sstream>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace ThematicAnalysisTests
+{
+	TEST_CLASS(FrozenSemanticGraphTests)
+	{
+	public:
+
+		TEST_METHOD_INITIALIZE(createGraph)
+		{
+			for (std::string view : { "АБАК", "ГРУППА", "СТЕПЕНЬ", "КОЛЬЦО", "ПОЛЕ" })
+			{
+				std::vector<std::string> words = { view };
+				hashes.push_back(Hasher::sortAndCalcHash(words));
+				Term term(words, view, hashes.back());
+				term.numberOfArticlesThatUseIt = hashes.size();
+				graph.addTerm(term);
+			}
+			graph.createLink(hashes[0], hashes[1], 0.5);
+			graph.createLink(hashes[0], hashes[2], 0.1);
+			graph.createLink(hashes[0], hashes[3], 0.3);
+			graph.createLink(hashes[3], hashes[4], 0.01);
+			graph.createLink(hashes[4], hashes[0], 0.2);
+			graph.addTermWeight(hashes[2], 1.5);
+		}
+
+		std::vector<size_t> hashes;
+		SemanticGraph graph;
+
+		std::string exportToString(SemanticGraph& semanticGraph)
+		{
+			std::ostringstream out;
+			semanticGraph.exportToStream(out);
+			return out.str();
+		}
+
+		template <typename Weight>
+		std::string exportToString(FrozenSemanticGraph<Weight> const& frozen)
+		{
+			std::ostringstream out;
+			frozen.exportToStream(out);
+			return out.str();
+		}
+
+		TEST_METHOD(linksOfNodes)
+		{
+			FrozenSemanticGraph<double> frozen(graph);
+			Assert::AreEqual(5ull, frozen.nodesCount());
+			Assert::AreEqual(5ull, frozen.getLinksCount());
+			Assert::IsTrue(frozen.isTermExist(hashes[3]));
+			Assert::AreEqual(0.3, frozen.getLinkWeight(hashes[0], hashes[3]));
+			Assert::AreEqual(0.2, frozen.getLinkWeight(hashes[4], hashes[0]));
+			Assert::ExpectException<std::out_of_range>([&] { frozen.getLinkWeight(hashes[3], hashes[0]); });
+			auto node = frozen.find(hashes[0]);
+			Assert::AreEqual(3ull, frozen.getLinksEnd(node) - frozen.getLinksBegin(node));
+			Assert::AreEqual(0.9, frozen.sumLinksWeight(node), 1e-12);
+			Assert::AreEqual(1.5, frozen.getWeight(frozen.find(hashes[2])));
+			Assert::AreEqual(3u, frozen.terms().getDocumentsCount(frozen.find(hashes[2])));
+		}
+
+		TEST_METHOD(exportIsTheSameAsGraphExport)
+		{
+			FrozenSemanticGraph<double> frozen(graph);
+			Assert::AreEqual(exportToString(graph), exportToString(frozen));
+			auto thawed = frozen.toSemanticGraph();
+			Assert::AreEqual(exportToString(graph), exportToString(thawed));
+		}
+
+		TEST_METHOD(reducedWeightsError)
+		{
+			FrozenSemanticGraph<float> floatGraph(graph);
+			FrozenSemanticGraph<Quantized16> quantizedGraph(graph);
+			auto scale = 0.5 / UINT16_MAX;
+			for (size_t i = 0; i < hashes.size(); i++)
+				for (size_t j = 0; j < hashes.size(); j++)
+					if (graph.isLinkExist(hashes[i], hashes[j]))
+					{
+						auto weight = graph.getLinkWeight(hashes[i], hashes[j]);
+						Assert::AreEqual(weight, floatGraph.getLinkWeight(hashes[i], hashes[j]), weight * 1e-7);
+						Assert::AreEqual(weight, quantizedGraph.getLinkWeight(hashes[i], hashes[j]), scale / 2);
+					}
+			Assert::AreEqual(0.5, quantizedGraph.getLinkWeight(hashes[0], hashes[1]), 1e-12);
+			Assert::IsTrue(quantizedGraph.getMemoryUsage() < floatGraph.getMemoryUsage());
+		}
+
+		TEST_METHOD(snapshotSaveAndLoad)
+		{
+			FrozenSemanticGraph<Quantized16> frozen(graph);
+			std::stringstream snapshot;
+			frozen.saveToStream(snapshot);
+
+			FrozenSemanticGraph<Quantized16> loaded;
+			loaded.loadFromStream(snapshot);
+			Assert::AreEqual(exportToString(frozen), exportToString(loaded));
+			Assert::AreEqual(graph.getNForNgram(), loaded.getNForNgram());
+			Assert::AreEqual(6ull, loaded.getArticlesCount());
+			Assert::AreEqual(frozen.idf()[1], loaded.idf()[1]);
+
+			snapshot.clear();
+			snapshot.seekg(0);
+			FrozenSemanticGraph<float> otherType;
+			Assert::ExpectException<std::runtime_error>([&] { otherType.loadFromStream(snapshot); });
+			std::istringstream truncated(snapshot.str().substr(0, snapshot.str().size() - 3));
+			Assert::ExpectException<std::runtime_error>([&] { loaded.loadFromStream(truncated); });
+			Assert::AreEqual(5ull, loaded.getLinksCount());
+
+			for (auto scale : { std::numeric_limits<double>::quiet_NaN(), std::numeric_limits<double>::infinity(), -1., 0. })
+			{
+				std::stringstream weights;
+				BinaryUtils::write(weights, scale);
+				BinaryUtils::writeVector(weights, std::vector<uint16_t>{ 1 });
+				WeightArray<Quantized16> broken;
+				Assert::ExpectException<std::runtime_error>([&] { broken.loadFromStream(weights); });
+			}
+		}
+
+		TEST_METHOD(statisticsUpdates)
+		{
+			graph.setArticlesCount(20);
+			FrozenSemanticGraph<float> frozen(graph);
+			auto node = frozen.find(hashes[2]);
+			Assert::AreEqual(20ull, frozen.getArticlesCount());
+			Assert::AreEqual(std::log10(20. / 3.), frozen.idf()[node], 1e-12);
+			frozen.setDocumentsCount(node, 4);
+			Assert::AreEqual(4u, frozen.terms().getDocumentsCount(node));
+			Assert::AreEqual(std::log10(20. / 4.), frozen.idf()[node], 1e-12);
+			frozen.setArticlesCount(40);
+			Assert::AreEqual(std::log10(40. / 4.), frozen.idf()[node], 1e-12);
+			Assert::AreEqual(std::log10(40. / 1.), frozen.idf()[frozen.find(hashes[0])], 1e-12);
+		}
+
+		TEST_METHOD(reorderedNodes)
+		{
+			std::vector<std::string> text = { "АБАК", "ПОЛЕ", "КОЛЬЦО", "ПОЛЕ" };
+			FrozenSemanticGraph<double> hashOrdered(graph);
+			auto expectedTags = TagsAnalyzer::getRelevantTags(text, hashOrdered, 5);
+			for (auto order : NodesOrdering::ORDERS)
+			{
+				FrozenSemanticGraph<double> frozen(graph, order);
+				Assert::IsTrue(order == frozen.nodesOrder());
+				Assert::AreEqual(5ull, frozen.getLinksCount());
+				for (size_t i = 0; i < hashes.size(); i++)
+					for (size_t j = 0; j < hashes.size(); j++)
+						if (graph.isLinkExist(hashes[i], hashes[j]))
+							Assert::AreEqual(graph.getLinkWeight(hashes[i], hashes[j]), frozen.getLinkWeight(hashes[i], hashes[j]));
+				auto node = frozen.find(hashes[0]);
+				std::vector<FrozenSemanticGraph<double>::Index> targets;
+				for (auto link = frozen.getLinksBegin(node); link < frozen.getLinksEnd(node); link++)
+					targets.push_back(frozen.getLinkTarget(link));
+				Assert::IsTrue(std::is_sorted(targets.begin(), targets.end()));
+				// weights are summed in other order
+				auto tags = TagsAnalyzer::getRelevantTags(text, frozen, 5);
+				for (size_t i = 0; i < tags.size(); i++)
+					Assert::AreEqual(expectedTags[i].weight, tags[i].weight, 1e-12);
+
+				std::stringstream snapshot;
+				frozen.saveToStream(snapshot);
+				FrozenSemanticGraph<double> loaded;
+				loaded.loadFromStream(snapshot);
+				Assert::IsTrue(order == loaded.nodesOrder());
+				Assert::AreEqual(exportToString(frozen), exportToString(loaded));
+			}
+			// the hub is the first
+			Assert::AreEqual(0u, FrozenSemanticGraph<double>(graph, NodesOrdering::Order::DegreeDescending).find(hashes[0]));
+		}
+
+		TEST_METHOD(tiedTagsAreOrderedByHash)
+		{
+			SemanticGraph tiedGraph;
+			std::vector<std::string> text;
+			for (std::string view : { "АБАК", "ГРУППА", "СТЕПЕНЬ", "КОЛЬЦО" })
+			{
+				tiedGraph.addTerm(Term({ view }, view, Hasher::sortAndCalcHash({ view })));
+				text.push_back(view);
+			}
+			tiedGraph.createLink(Hasher::sortAndCalcHash({ "КОЛЬЦО" }), Hasher::sortAndCalcHash({ "АБАК" }), 1);
+			for (auto order : NodesOrdering::ORDERS)
+			{
+				FrozenSemanticGraph<double> frozen(tiedGraph, order);
+				auto tags = TagsAnalyzer::getRelevantTags(text, frozen, 4);
+				for (size_t i = 1; i < tags.size(); i++)
+					Assert::IsTrue(tags[i - 1].weight > tags[i].weight || (tags[i - 1].weight == tags[i].weight
+						&& Hasher::sortAndCalcHash({ tags[i - 1].termView }) < Hasher::sortAndCalcHash({ tags[i].termView })));
+			}
+		}
+
+		TEST_METHOD(neighborhood)
+		{
+			FrozenSemanticGraph<float> frozen(graph, NodesOrdering::Order::BreadthFirst);
+			auto toHashes = [&frozen](std::vector<FrozenSemanticGraph<float>::Index> const& nodes)
+			{
+				std::vector<size_t> nodesHashes;
+				for (auto node : nodes)
+					nodesHashes.push_back(frozen.terms().getHash(node));
+				std::sort(nodesHashes.begin() + 1, nodesHashes.end());
+				return nodesHashes;
+			};
+			std::vector<size_t> expected = { hashes[0], hashes[1], hashes[2], hashes[3] };
+			std::sort(expected.begin() + 1, expected.end());
+			Assert::IsTrue(expected == toHashes(frozen.getNeighborhood(hashes[0], 1)));
+			Assert::AreEqual(5ull, frozen.getNeighborhood(hashes[0], 2).size());
+			expected = { hashes[0], hashes[1], hashes[3] };
+			std::sort(expected.begin() + 1, expected.end());
+			Assert::IsTrue(expected == toHashes(frozen.getNeighborhood(hashes[0], 2, 0.25)));
+			Assert::AreEqual(1ull, frozen.getNeighborhood(hashes[2], 3).size());
+			Assert::IsTrue(frozen.getNeighborhood(12345, 1).empty());
+		}
+
+		TEST_METHOD(tagsAsOverSemanticGraph)
+		{
+			std::vector<std::string> text = { "АБАК", "ПОЛЕ", "КОЛЬЦО", "ПОЛЕ" };
+			TagsAnalyzer analyzer;
+			analyzer.analyze(text, graph);
+			auto expected = analyzer.getRelevantTags(5);
+			auto tags = TagsAnalyzer::getRelevantTags(text, FrozenSemanticGraph<double>(graph), 5);
+			Assert::AreEqual(expected.size(), tags.size());
+			for (size_t i = 0; i < expected.size(); i++)
+			{
+				Assert::AreEqual(expected[i].termView, tags[i].termView);
+				Assert::AreEqual(expected[i].weight, tags[i].weight);
+			}
+
+			graph.setArticlesCount(20);
+			analyzer.analyze(text, graph);
+			expected = analyzer.getRelevantTags(5);
+			tags = TagsAnalyzer::getRelevantTags(text, FrozenSemanticGraph<double>(graph), 5);
+			for (size_t i = 0; i < expected.size(); i++)
+			{
+				Assert::AreEqual(expected[i].termView, tags[i].termView);
+				Assert::AreEqual(expected[i].weight, tags[i].weight);
+			}
+		}
+	};
+}
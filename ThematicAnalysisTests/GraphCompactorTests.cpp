@@ -0,0 +1,64 @@
+﻿#include "pch.h"
+#include "CppUnitTest.h"
+#include "GraphCompactor.h"
+#include "Hasher.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace ThematicAnalysisTests
+{
+	TEST_CLASS(GraphCompactorTests)
+	{
+	public:
+
+		TEST_METHOD_INITIALIZE(createGraph)
+		{
+			for (std::string view : { "АБАК", "ГРУППА", "СТЕПЕНЬ", "КОЛЬЦО", "ПОЛЕ" })
+			{
+				std::vector<std::string> words = { view };
+				hashes.push_back(Hasher::sortAndCalcHash(words));
+				graph.addTerm(Term(words, view, hashes.back()));
+			}
+			graph.createLink(hashes[0], hashes[1], 0.5);
+			graph.createLink(hashes[0], hashes[2], 0.1);
+			graph.createLink(hashes[0], hashes[3], 0.3);
+			graph.createLink(hashes[3], hashes[4], 0.01);
+		}
+
+		std::vector<size_t> hashes;
+		SemanticGraph graph;
+
+		TEST_METHOD(keepTopLinks)
+		{
+			auto report = GraphCompactor(2).compact(graph);
+			Assert::AreEqual(4ull, report.linksBefore);
+			Assert::AreEqual(3ull, report.linksAfter);
+			Assert::IsTrue(graph.isLinkExist(hashes[0], hashes[1]));
+			Assert::IsTrue(graph.isLinkExist(hashes[0], hashes[3]));
+			Assert::IsFalse(graph.isLinkExist(hashes[0], hashes[2]));
+			Assert::IsTrue(graph.isLinkExist(hashes[3], hashes[4]));
+		}
+
+		TEST_METHOD(removeLightLinksAndOrphans)
+		{
+			auto report = GraphCompactor(0, 0.05).compact(graph);
+			Assert::AreEqual(5ull, report.nodesBefore);
+			Assert::AreEqual(4ull, report.nodesAfter);
+			Assert::AreEqual(3ull, report.linksAfter);
+			Assert::IsTrue(graph.isTermExist(hashes[3]));
+			Assert::IsFalse(graph.isTermExist(hashes[4]));
+			// the articles count is taken before orphans are removed
+			Assert::AreEqual(6ull, graph.getArticlesCount());
+		}
+
+		TEST_METHOD(keepTermsWithoutLinks)
+		{
+			std::vector<std::string> words = { "ТОР" };
+			graph.addTerm(Term(words, "ТОР", Hasher::sortAndCalcHash(words)));
+			GraphCompactor(1, 0.2).compact(graph);
+			Assert::IsTrue(graph.isTermExist(Hasher::sortAndCalcHash(words)));
+			Assert::IsFalse(graph.isTermExist(hashes[2]));
+			Assert::AreEqual(1ull, graph.getLinksCount());
+		}
+	};
+}
@@ -0,0 +1,68 @@
+﻿#include "pch.h"
+#include <sstream>
+#include "CppUnitTest.h"
+#include "GraphStatistics.h"
+#include "Hasher.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace ThematicAnalysisTests
+{
+	TEST_CLASS(GraphStatisticsTests)
+	{
+	public:
+
+		TEST_METHOD_INITIALIZE(createGraph)
+		{
+			for (std::string view : { "АБАК", "ГРУППА", "СТЕПЕНЬ", "КОЛЬЦО", "ПОЛЕ" })
+			{
+				std::vector<std::string> words = { view };
+				hashes.push_back(Hasher::sortAndCalcHash(words));
+				graph.addTerm(Term(words, view, hashes.back()));
+			}
+			graph.createLink(hashes[0], hashes[1], 1);
+			graph.createLink(hashes[0], hashes[2], 2);
+			graph.createLink(hashes[1], hashes[2], 3);
+			graph.createLink(hashes[3], hashes[0], 4);
+		}
+
+		std::vector<size_t> hashes;
+		SemanticGraph graph;
+
+		TEST_METHOD(degrees)
+		{
+			auto statistics = GraphStatistics::calculate(graph, 2);
+			Assert::AreEqual(5ull, statistics.nodesCount);
+			Assert::AreEqual(4ull, statistics.linksCount);
+			Assert::AreEqual(2ull, statistics.outDegreeDistribution[0]);
+			Assert::AreEqual(2ull, statistics.outDegreeDistribution[1]);
+			Assert::AreEqual(1ull, statistics.outDegreeDistribution[2]);
+			Assert::AreEqual(2ull, statistics.inDegreeDistribution[0]);
+			Assert::AreEqual(1ull, statistics.hubs.size());
+			Assert::AreEqual(std::string("АБАК"), statistics.hubs[0].termView);
+		}
+
+		TEST_METHOD(weightQuantiles)
+		{
+			auto statistics = GraphStatistics::calculate(graph);
+			Assert::AreEqual(GraphStatistics::QUANTILES.size(), statistics.weightQuantiles.size());
+			Assert::AreEqual(1., statistics.weightQuantiles.front());
+			Assert::AreEqual(4., statistics.weightQuantiles.back());
+		}
+
+		TEST_METHOD(components)
+		{
+			auto statistics = GraphStatistics::calculate(graph);
+			Assert::AreEqual(2ull, statistics.componentsCount);
+			Assert::AreEqual(4ull, statistics.largestComponentSize);
+			Assert::AreEqual(1ull, statistics.isolatedNodesCount);
+		}
+
+		TEST_METHOD(exportToJson)
+		{
+			std::stringstream ss;
+			GraphStatistics::calculate(graph).exportToJson(ss);
+			Assert::IsTrue(ss.str().find("\"linksCount\": 4") != std::string::npos);
+		}
+	};
+}
@@ -0,0 +1,70 @@
+﻿#include "pch.h"
+#include "CppUnitTest.h"
+#include "IdfTable.h"
+#include "Utils/TermsUtils.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace ThematicAnalysisTests
+{
+	TEST_CLASS(IdfTableTests)
+	{
+	public:
+		TEST_METHOD(IdfOfTermsIsUpdated)
+		{
+			TermTable terms;
+			for (size_t i = 0; i < 3; i++)
+			{
+				Term term({ "слово" + std::to_string(i) }, "слово" + std::to_string(i), i + 1);
+				term.numberOfArticlesThatUseIt = i;
+				terms.add(term);
+			}
+			IdfTable idf(terms, 10);
+			Assert::AreEqual(3ull, idf.size());
+			for (TermTable::Index i = 0; i < 3; i++)
+				Assert::AreEqual(TermsUtils::calcIdf(i, 10), idf[i]);
+
+			terms.setDocumentsCount(0, 5);
+			idf.update(terms, 0);
+			Assert::AreEqual(TermsUtils::calcIdf(5, 10), idf[0]);
+			auto added = terms.add(Term({ "ранг" }, "ранг", 7));
+			idf.update(terms, added);
+			Assert::AreEqual(4ull, idf.size());
+			Assert::AreEqual(TermsUtils::calcIdf(0, 10), idf[added]);
+			Assert::ExpectException<std::out_of_range>([&] { idf.update(terms, 5); });
+
+			idf.setArticlesCount(terms, 100);
+			Assert::AreEqual(100ull, idf.getArticlesCount());
+			Assert::AreEqual(TermsUtils::calcIdf(2, 100), idf[2]);
+		}
+
+		TEST_METHOD(FusedTfIdfIsTheSameAsTfIdf)
+		{
+			TermTable terms;
+			for (size_t i = 0; i < 37; i++)
+			{
+				Term term({ "слово" + std::to_string(i) }, "слово" + std::to_string(i), i + 1);
+				term.numberOfArticlesThatUseIt = i % 5;
+				terms.add(term);
+			}
+			IdfTable idf(terms, 50);
+			std::vector<TermTable::Index> textTerms;
+			std::vector<size_t> counts;
+			for (TermTable::Index i = 0; i < terms.size(); i += 3)
+			{
+				textTerms.push_back(i);
+				counts.push_back(i % 4 + 1);
+			}
+			std::vector<double> weights(terms.size(), 0.);
+			weights[3] = 1.5;
+			idf.addTfIdf(textTerms, counts, weights);
+			for (TermTable::Index i = 0; i < weights.size(); i++)
+				if (i % 3 == 0)
+					Assert::AreEqual((i == 3 ? 1.5 : 0.) + TermsUtils::calcTfIdf(i % 4 + 1, textTerms.size(), i % 5, 50), weights[i]);
+				else
+					Assert::AreEqual(0., weights[i]);
+			weights.pop_back();
+			Assert::ExpectException<std::invalid_argument>([&] { idf.addTfIdf(textTerms, counts, weights); });
+		}
+	};
+}
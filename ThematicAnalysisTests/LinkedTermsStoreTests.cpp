@@ -0,0 +1,53 @@
+﻿#include "pch.h"
+#include "CppUnitTest.h"
+#include "LinkedTermsStore.h"
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace ThematicAnalysisTests
+{
+	TEST_CLASS(LinkedTermsStoreTests)
+	{
+		std::vector<std::pair<uint32_t, std::vector<LinkedTermsStore::TermCount>>> records = {
+			{ 2, { {0, 3}, {1, 1}, {4, 2} } },
+			{ 0, {} },
+			{ 4, { {2, 5} } },
+		};
+
+		void checkRecords(LinkedTermsStore const& store)
+		{
+			Assert::AreEqual(records.size(), store.size());
+			size_t i = 0;
+			store.forEach([this, &i](uint32_t titleIndex, LinkedTermsStore::TermCount const* begin, LinkedTermsStore::TermCount const* end)
+				{
+					Assert::AreEqual(records[i].first, titleIndex);
+					auto const& termsCounts = records[i].second;
+					Assert::AreEqual(termsCounts.size(), static_cast<size_t>(end - begin));
+					for (size_t j = 0; j < termsCounts.size(); j++)
+					{
+						Assert::AreEqual(termsCounts[j].termIndex, begin[j].termIndex);
+						Assert::AreEqual(termsCounts[j].count, begin[j].count);
+					}
+					i++;
+				});
+			Assert::AreEqual(records.size(), i);
+		}
+	public:
+		TEST_METHOD(InMemory)
+		{
+			LinkedTermsStore store(1024);
+			for (auto const& [titleIndex, termsCounts] : records)
+				store.add(titleIndex, termsCounts);
+			Assert::AreEqual(0ull, store.spilledCount());
+			checkRecords(store);
+		}
+		TEST_METHOD(Spilled)
+		{
+			LinkedTermsStore store(1);
+			for (auto const& [titleIndex, termsCounts] : records)
+				store.add(titleIndex, termsCounts);
+			Assert::AreEqual(records.size(), store.spilledCount());
+			checkRecords(store);
+			checkRecords(store);
+		}
+	};
+}
@@ -0,0 +1,37 @@
+﻿#include "pch.h"
+#include "CppUnitTest.h"
+#include "ArticlesReader/MathArticlesReader.h"
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace ThematicAnalysisTests
+{
+	TEST_CLASS(MathArticlesReaderTests)
+	{
+		const std::string text = "\n\nАБАК — счетная доска.\n\nАБЕЛЕВА <ГРУППА/> — коммутативная группа.\nпродолжение\n\nКОЛЬЦО — множество с операциями.";
+	public:
+		TEST_METHOD(ReadHeadings)
+		{
+			auto [titles, contents] = MathArticlesReader().read(text);
+			Assert::AreEqual(3ull, titles.size());
+			Assert::AreEqual(std::string("АБАК"), titles[0]);
+			Assert::AreEqual(std::string("АБЕЛЕВА ГРУППА"), titles[1]);
+			Assert::AreEqual(std::string(" — коммутативная группа.\nпродолжение\n\n"), contents[1]);
+			Assert::AreEqual(std::string("КОЛЬЦО"), titles[2]);
+		}
+		TEST_METHOD(ParallelRead)
+		{
+			auto [titles, contents] = MathArticlesReader().read(text);
+			for (size_t threadsCount : { 1, 2, 5 })
+			{
+				std::vector<std::string> parallelTitles, parallelContents;
+				MathArticlesReader().readParallel(text, [&parallelTitles, &parallelContents](std::string_view title, std::string_view content)
+					{
+						parallelTitles.emplace_back(title);
+						parallelContents.emplace_back(content);
+					}, threadsCount);
+				Assert::IsTrue(titles == parallelTitles);
+				Assert::IsTrue(contents == parallelContents);
+			}
+		}
+	};
+}
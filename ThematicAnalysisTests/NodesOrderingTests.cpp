@@ -0,0 +1,55 @@
+﻿#include "pch.h"
+#include "CppUnitTest.h"
+#include "NodesOrdering.h"
+
+#include <algorithm>
+#include <numeric>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace ThematicAnalysisTests
+{
+	TEST_CLASS(NodesOrderingTests)
+	{
+	public:
+		// 0 -> 3, 3 -> 1, 1 -> 4, 4 -> 2, 5 -> 4: a path 0-3-1-4-2 with 5 attached to 4
+		std::vector<uint32_t> offsets = { 0, 1, 2, 2, 3, 4, 5 };
+		std::vector<uint32_t> targets = { 3, 4, 1, 2, 4 };
+
+		TEST_METHOD(ordersArePermutations)
+		{
+			for (auto order : NodesOrdering::ORDERS)
+			{
+				auto nodes = NodesOrdering::calculate(order, offsets, targets);
+				std::sort(nodes.begin(), nodes.end());
+				std::vector<uint32_t> expected(offsets.size() - 1);
+				std::iota(expected.begin(), expected.end(), 0);
+				Assert::IsTrue(expected == nodes);
+				Assert::IsTrue(order == NodesOrdering::parse(NodesOrdering::getName(order)));
+			}
+			Assert::IsTrue(std::vector<uint32_t>{ 0, 1, 2, 3, 4, 5 } == NodesOrdering::calculate(NodesOrdering::Order::Hash, offsets, targets));
+			Assert::ExpectException<std::invalid_argument>([] { NodesOrdering::parse("random"); });
+		}
+
+		TEST_METHOD(linkedNodesAreClose)
+		{
+			// from the hub 4 (degree 3) over links in both directions
+			std::vector<uint32_t> breadthFirst = { 4, 1, 2, 5, 3, 0 };
+			Assert::IsTrue(breadthFirst == NodesOrdering::calculate(NodesOrdering::Order::BreadthFirst, offsets, targets));
+			// from the leaf 0, then reversed
+			std::vector<uint32_t> reverseCuthillMcKee = { 5, 2, 4, 1, 3, 0 };
+			Assert::IsTrue(reverseCuthillMcKee == NodesOrdering::calculate(NodesOrdering::Order::ReverseCuthillMcKee, offsets, targets));
+			std::vector<uint32_t> degreeDescending = { 4, 1, 3, 0, 2, 5 };
+			Assert::IsTrue(degreeDescending == NodesOrdering::calculate(NodesOrdering::Order::DegreeDescending, offsets, targets));
+		}
+
+		TEST_METHOD(eachComponentIsTraversed)
+		{
+			std::vector<uint32_t> isolatedOffsets = { 0, 1, 1, 1 };
+			std::vector<uint32_t> isolatedTargets = { 1 };
+			std::vector<uint32_t> expected = { 0, 1, 2 };
+			Assert::IsTrue(expected == NodesOrdering::calculate(NodesOrdering::Order::BreadthFirst, isolatedOffsets, isolatedTargets));
+			Assert::AreEqual(3ull, NodesOrdering::calculate(NodesOrdering::Order::ReverseCuthillMcKee, isolatedOffsets, isolatedTargets).size());
+		}
+	};
+}
@@ -0,0 +1,50 @@
+﻿#include "pch.h"
+#include "CppUnitTest.h"
+#include "NormalizedArticlesStore.h"
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace ThematicAnalysisTests
+{
+	TEST_CLASS(NormalizedArticlesStoreTests)
+	{
+		std::vector<NormalizedArticle> articles = {
+			{ {"терм", "первый"}, "первый терм", {"второй", "третий", "терм"}},
+			{ {"второй"}, "второй", {"первый", "терм"} },
+			{ {"третий"}, "третий", {} },
+		};
+
+		void checkArticles(NormalizedArticlesStore const& store)
+		{
+			Assert::AreEqual(articles.size(), store.size());
+			size_t i = 0;
+			store.forEach([this, &i](NormalizedArticle const& article)
+				{
+					Assert::IsTrue(articles[i].titleWords == article.titleWords);
+					Assert::AreEqual(articles[i].titleView, article.titleView);
+					Assert::IsTrue(articles[i].text == article.text);
+					i++;
+				});
+			Assert::AreEqual(articles.size(), i);
+		}
+	public:
+		TEST_METHOD(InMemory)
+		{
+			NormalizedArticlesStore store;
+			for (auto const& article : articles)
+				store.add(article);
+			Assert::AreEqual(0ull, store.spilledCount());
+			Assert::IsTrue(store.memorySize() > 0);
+			checkArticles(store);
+		}
+		TEST_METHOD(Spilled)
+		{
+			NormalizedArticlesStore store(1);
+			for (auto const& article : articles)
+				store.add(article);
+			Assert::AreEqual(articles.size(), store.spilledCount());
+			Assert::AreEqual(0ull, store.memorySize());
+			checkArticles(store);
+			checkArticles(store);
+		}
+	};
+}
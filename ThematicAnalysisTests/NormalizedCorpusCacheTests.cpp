@@ -0,0 +1,90 @@
+﻿#include "pch.h"
+#include "CppUnitTest.h"
+#include "NormalizedCorpusCache.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace ThematicAnalysisTests
+{
+	TEST_CLASS(NormalizedCorpusCacheTests)
+	{
+		std::vector<NormalizedArticle> articles = {
+			{ {"терм", "первый"}, "первый терм", {"второй", "третий", "терм"}},
+			{ {"второй"}, "второй", {"первый", "терм"} },
+			{ {"третий"}, "третий", {} },
+		};
+
+		void checkArticles(NormalizedCorpusCache const& cache)
+		{
+			Assert::AreEqual(articles.size(), cache.size());
+			size_t i = 0;
+			cache.forEach([this, &i](NormalizedArticle const& article)
+				{
+					Assert::IsTrue(articles[i].titleWords == article.titleWords);
+					Assert::AreEqual(articles[i].titleView, article.titleView);
+					Assert::IsTrue(articles[i].text == article.text);
+					i++;
+				});
+			Assert::AreEqual(articles.size(), i);
+		}
+	public:
+		TEST_METHOD(InternLemmas)
+		{
+			NormalizedCorpusCache cache;
+			for (auto const& article : articles)
+				cache.add(article);
+			Assert::AreEqual(4ull, cache.lemmasCount());
+			checkArticles(cache);
+		}
+		TEST_METHOD(SaveAndLoad)
+		{
+			NormalizedCorpusCache cache;
+			for (auto const& article : articles)
+				cache.add(article);
+			auto key = NormalizedCorpusCache::calcKey("corpus text", "reader");
+			Assert::AreNotEqual(key, NormalizedCorpusCache::calcKey("corpus text", "other reader"));
+			auto filePath = NormalizedCorpusCache::getFilePath(".", key);
+			cache.save(filePath, key);
+
+			NormalizedCorpusCache loaded;
+			Assert::IsFalse(loaded.load(filePath, key + 1));
+			Assert::IsTrue(loaded.load(filePath, key));
+			std::filesystem::remove(filePath);
+			Assert::AreEqual(cache.lemmasCount(), loaded.lemmasCount());
+			checkArticles(loaded);
+			Assert::IsFalse(loaded.load(filePath, key));
+			Assert::IsFalse(std::filesystem::exists(filePath + ".tmp"));
+		}
+		TEST_METHOD(DamagedFileIsRejected)
+		{
+			NormalizedCorpusCache cache;
+			for (auto const& article : articles)
+				cache.add(article);
+			auto key = NormalizedCorpusCache::calcKey("corpus text");
+			auto filePath = NormalizedCorpusCache::getFilePath(".", key);
+			cache.save(filePath, key);
+			std::ostringstream file;
+			file << std::ifstream(filePath, std::ios::binary).rdbuf();
+			auto data = file.str();
+
+			auto truncated = data.substr(0, data.size() - 2);
+			// count of lemmas follows magic, version and key
+			auto brokenCount = data;
+			uint64_t lemmasCount = 1ull << 60;
+			std::memcpy(brokenCount.data() + 16, &lemmasCount, sizeof(lemmasCount));
+			for (auto const& damaged : { truncated, brokenCount })
+			{
+				std::ofstream(filePath, std::ios::binary | std::ios::trunc) << damaged;
+				NormalizedCorpusCache loaded;
+				Assert::ExpectException<std::runtime_error>([&loaded, &filePath, key]() {loaded.load(filePath, key); });
+				Assert::AreEqual(0ull, loaded.size());
+			}
+			std::filesystem::remove(filePath);
+		}
+	};
+}
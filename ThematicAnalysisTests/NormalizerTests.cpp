@@ -1,6 +1,7 @@
 ﻿#include "pch.h"
 #include "CppUnitTest.h"
 #include "TextNormalizer.h"
+#include "Lemmatizer/StubLemmatizer.h"
 
 using namespace Microsoft::VisualStudio::CppUnitTestFramework;
 
@@ -26,6 +27,23 @@ namespace ThematicAnalysisTests
 				Assert::AreEqual(normWords[i], resWords[i]);
 			}
 		}
+		TEST_METHOD(SegmentsTest)
+		{
+			TextNormalizer normalizer;
+			std::vector<std::string_view> segments = { "Сижу x-", "", "и. <, *стою на \n дороге#", "contentendtag" };
+			auto res = normalizer.normalizeSegments(segments);
+			std::vector<size_t> offsets = { 0, 1, 1, 4, 5 };
+			std::vector<std::string> normWords = { "сидеть",  "стоять", "на" , "дорога", "contentendtag" };
+
+			Assert::IsTrue(offsets == res.offsets);
+			Assert::IsTrue(normWords == res.tokens);
+		}
+		TEST_METHOD(InjectedLemmatizerTest)
+		{
+			TextNormalizer normalizer(std::make_shared<StubLemmatizer>(StubLemmatizer::Mode::SuffixStripping));
+			std::vector<std::string> normWords = { "сиж", "сто", "на", "дорог" };
+			Assert::IsTrue(normWords == normalizer.normalize("Сижу x- и. <, *стою на \n дороге#"));
+		}
 	};
 }
 
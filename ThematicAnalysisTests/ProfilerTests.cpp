@@ -0,0 +1,111 @@
+﻿#include "pch.h"
+#include "CppUnitTest.h"
+#include "Utils/Profiler.h"
+#include "Utils/ThreadPool.h"
+
+#include <sstream>
+#include <thread>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace ThematicAnalysisTests
+{
+	TEST_CLASS(ProfilerTests)
+	{
+	public:
+		TEST_METHOD_INITIALIZE(Initialize)
+		{
+			Profiler::setEnabled(true);
+			Profiler::reset();
+		}
+
+		TEST_METHOD_CLEANUP(Cleanup)
+		{
+			Profiler::setEnabled(false);
+			Profiler::reset();
+		}
+
+		TEST_METHOD(CountersOfThreads)
+		{
+			std::vector<std::thread> threads;
+			for (int i = 0; i < 4; i++)
+				threads.emplace_back([] {
+						for (int j = 0; j < 1000; j++)
+							PROFILE_COUNT("testProbes", 2);
+					});
+			for (auto& thread : threads)
+				thread.join();
+			PROFILE_COUNT("testProbes", 1);
+			auto report = Profiler::collect();
+			Assert::AreEqual(8001ull, report.getCounter("testProbes"));
+			Assert::AreEqual(0ull, report.getCounter("unknown"));
+
+			Profiler::setEnabled(false);
+			PROFILE_COUNT("testProbes", 1);
+			Assert::AreEqual(8001ull, Profiler::collect().getCounter("testProbes"));
+		}
+
+		TEST_METHOD(Histogram)
+		{
+			for (uint64_t value = 1; value <= 100; value++)
+				PROFILE_VALUE("testValues", value);
+			auto report = Profiler::collect();
+			auto histogram = report.findHistogram("testValues");
+			Assert::IsNotNull(histogram);
+			Assert::AreEqual(100ull, histogram->count);
+			Assert::AreEqual(5050ull, histogram->sum);
+			Assert::AreEqual(1ull, histogram->min);
+			Assert::AreEqual(100ull, histogram->max);
+			Assert::AreEqual(50.5, histogram->mean());
+			// percentiles are upper bounds of power of two buckets
+			Assert::AreEqual(63ull, histogram->p50);
+			Assert::AreEqual(100ull, histogram->p99);
+			Assert::IsNull(report.findTimer("testValues"));
+		}
+
+		TEST_METHOD(ScopedTimerAndReport)
+		{
+			for (int i = 0; i < 3; i++)
+			{
+				PROFILE_SCOPE("testScope");
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			}
+			auto report = Profiler::collect();
+			auto timer = report.findTimer("testScope");
+			Assert::IsNotNull(timer);
+			Assert::AreEqual(3ull, timer->count);
+			Assert::IsTrue(timer->min >= 1000000ull);
+			Assert::IsTrue(timer->p50 <= timer->max);
+
+			std::stringstream json, text;
+			report.exportToJson(json);
+			report.exportToText(text);
+			Assert::IsTrue(json.str().find("{\"name\": \"testScope\", \"count\": 3") != std::string::npos);
+			Assert::IsTrue(text.str().find("testScope: count 3") != std::string::npos);
+		}
+
+		TEST_METHOD(CurrentScope)
+		{
+			Assert::AreEqual(Profiler::NO_SCOPE, Profiler::currentScope());
+			auto outerId = Profiler::registerName("testOuter", Profiler::Kind::Timer);
+			size_t taskScope = Profiler::NO_SCOPE;
+			{
+				PROFILE_SCOPE("testOuter");
+				Assert::AreEqual(outerId, Profiler::currentScope());
+				{
+					PROFILE_SCOPE("testInner");
+					Assert::AreEqual(std::string("testInner"), Profiler::getName(Profiler::currentScope()));
+				}
+				Assert::AreEqual(outerId, Profiler::currentScope());
+				ThreadPool pool(2);
+				pool.wait(pool.run([&taskScope] {taskScope = Profiler::currentScope(); }));
+			}
+			Assert::AreEqual(outerId, taskScope);
+			Assert::AreEqual(Profiler::NO_SCOPE, Profiler::currentScope());
+
+			Profiler::setEnabled(false);
+			PROFILE_SCOPE("testOuter");
+			Assert::AreEqual(Profiler::NO_SCOPE, Profiler::currentScope());
+		}
+	};
+}
@@ -2,11 +2,14 @@
 
 #include <algorithm>
 #include <CppUnitTest.h>
+#include <filesystem>
 #include <set>
 
 #include "Hasher.h"
 #include "Utils/TermsUtils.h"
 #include "SemanticGraphBuilder.h"
+#include "ArticlesReader/XmlArticlesReader.h"
+#include "Lemmatizer/StubLemmatizer.h"
 
 using namespace Microsoft::VisualStudio::CppUnitTestFramework;
 
@@ -48,6 +51,7 @@ namespace ThematicAnalysisTests
 			Assert::AreEqual(TermsUtils::calcTfIdf(1, 2, 1, 3), graph.getLinkWeight(articlesHashes[0], articlesHashes[2]), 0.0001);
 			Assert::AreEqual(TermsUtils::calcTfIdf(1, 1, 2, 3), graph.getLinkWeight(articlesHashes[1], articlesHashes[0]), 0.0001);
 			Assert::AreEqual(TermsUtils::calcTfIdf(1, 1, 2, 3), graph.getLinkWeight(articlesHashes[2], articlesHashes[0]), 0.0001);
+			Assert::AreEqual(3ull, graph.getArticlesCount());
 		}
 
 		TEST_METHOD(buildWithDuplicates)
@@ -69,6 +73,79 @@ namespace ThematicAnalysisTests
 
 			Assert::IsTrue(graph.isLinkExist(articlesHashes[0], articlesHashes[1]));
 			Assert::IsTrue(graph.isLinkExist(articlesHashes[1], articlesHashes[0]));
+			// merged articles are counted once
+			Assert::AreEqual(2ull, graph.getArticlesCount());
+		}
+		TEST_METHOD(buildFromSpilledStore)
+		{
+			std::vector<NormalizedArticle> articles = {
+				{ {"второй"}, "второй", {"третий", "терм"} },
+				{ {"третий"}, "третий", {"второй", "терм"} },
+				{ {"второй"}, "второй", {"второй", "третий"} },
+			};
+			NormalizedArticlesStore store(1);
+			for (auto const& article : articles)
+				store.add(article);
+
+			auto expected = SemanticGraphBuilder().build(articles);
+			auto graph = SemanticGraphBuilder().build(store);
+			Assert::AreEqual(expected.nodes.size(), graph.nodes.size());
+			for (auto const& [hash, node] : expected.nodes)
+				for (auto const& [neighborHash, link] : node.neighbors)
+					Assert::AreEqual(link.weight, graph.getLinkWeight(hash, neighborHash), 0.0001);
+			Assert::AreEqual(expected.getLinksCount(), graph.getLinksCount());
+		}
+
+		TEST_METHOD(buildWithCache)
+		{
+			std::string text =
+				"<paper><name>Второй</name><content>третий терм</content></paper>\n"
+				"<paper><name>Третий</name><content>второй терм</content></paper>\n";
+			SemanticGraphBuilder builder(std::make_shared<StubLemmatizer>());
+			auto expected = builder.build(text);
+			builder.setCacheDirectory("normalizedCache");
+			auto graph = builder.build(text);
+			Assert::AreEqual(4ull, builder.getPipelineMetrics().stages.size());
+			Assert::AreEqual(2ull, builder.getPipelineMetrics().stages.back().articlesCount);
+			auto cachedGraph = builder.build(text);
+			Assert::IsTrue(builder.getPipelineMetrics().stages.empty());
+			Assert::AreEqual(1ull, static_cast<size_t>(std::distance(std::filesystem::directory_iterator("normalizedCache"), {})));
+
+			// a damaged file is normalized again and replaced
+			auto cachePath = std::filesystem::directory_iterator("normalizedCache")->path();
+			std::filesystem::resize_file(cachePath, std::filesystem::file_size(cachePath) - 2);
+			auto rebuiltGraph = builder.build(text);
+			Assert::AreEqual(4ull, builder.getPipelineMetrics().stages.size());
+			auto recachedGraph = builder.build(text);
+			Assert::IsTrue(builder.getPipelineMetrics().stages.empty());
+			std::filesystem::remove_all("normalizedCache");
+
+			for (auto const* builtGraph : { &graph, &cachedGraph, &rebuiltGraph, &recachedGraph })
+			{
+				Assert::AreEqual(expected.nodes.size(), builtGraph->nodes.size());
+				Assert::AreEqual(expected.getLinksCount(), builtGraph->getLinksCount());
+				for (auto const& [hash, node] : expected.nodes)
+					for (auto const& [neighborHash, link] : node.neighbors)
+						Assert::AreEqual(link.weight, builtGraph->getLinkWeight(hash, neighborHash), 0.0001);
+			}
+		}
+
+		TEST_METHOD(buildWithSpilledLinks)
+		{
+			std::string text =
+				"<paper><name>Второй</name><content>третий терм второй</content></paper>\n"
+				"<paper><name>Третий</name><content>второй терм</content></paper>\n"
+				"<paper><name>Терм</name><content>третий второй третий</content></paper>\n";
+			SemanticGraphBuilder builder(std::make_shared<StubLemmatizer>());
+			auto expected = builder.build(text);
+			// articles and counts of linked terms are spilled after each article
+			auto graph = builder.build(text, XmlArticlesReader(), 1);
+			Assert::IsTrue(expected.getLinksCount() > 0);
+			Assert::AreEqual(expected.nodes.size(), graph.nodes.size());
+			Assert::AreEqual(expected.getLinksCount(), graph.getLinksCount());
+			for (auto const& [hash, node] : expected.nodes)
+				for (auto const& [neighborHash, link] : node.neighbors)
+					Assert::AreEqual(link.weight, graph.getLinkWeight(hash, neighborHash), 0.0001);
 		}
 	};
 }
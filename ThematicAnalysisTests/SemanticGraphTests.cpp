@@ -1,5 +1,6 @@
 ﻿#include "pch.h"
 #include <fstream>
+#include <memory>
 #include "CppUnitTest.h"
 #include "ArticlesNormalizer.h"
 #include "Utils/FileUtils.h"
@@ -186,6 +187,56 @@ namespace ThematicAnalysisTests
 			Assert::AreEqual(2., importedGraph.getLinkWeight(terms[2].getHashCode(), terms[1].getHashCode()));
 		}
 
+		TEST_METHOD(ArticlesCountIsExported)
+		{
+			std::istringstream oldFormat("2\nАБАК\n0 1 1 АБАК \nСТЕПЕНЬ\n0 2 1 СТЕПЕНЬ \n1\n0 1 0.5\n");
+			SemanticGraph graph;
+			graph.importFromStream(oldFormat);
+			Assert::IsFalse(oldFormat.fail());
+			Assert::IsFalse(graph.hasArticlesCount());
+			Assert::AreEqual(3ull, graph.getArticlesCount());
+			Assert::AreEqual(1ull, graph.getLinksCount());
+
+			graph.setArticlesCount(10);
+			std::stringstream exportSs;
+			graph.exportToStream(exportSs);
+			SemanticGraph importedGraph;
+			importedGraph.importFromStream(exportSs);
+			Assert::IsFalse(exportSs.fail());
+			Assert::IsTrue(importedGraph.hasArticlesCount());
+			Assert::AreEqual(10ull, importedGraph.getArticlesCount());
+			Assert::AreEqual(10ull, importedGraph.getNeighborhood(Hasher::sortAndCalcHash({ "АБАК" }), 1).getArticlesCount());
+		}
+
+		TEST_METHOD(CopiesAndMovesOfPooledGraph)
+		{
+			auto graph = std::make_unique<SemanticGraph>();
+			std::vector<std::vector<std::string>> normWords = { { "АБАК" },{ "АБЕЛЕВА", "ГРУППА" } };
+			std::vector<size_t> hashes;
+			for (auto const& words : normWords)
+			{
+				hashes.push_back(Hasher::sortAndCalcHash(words));
+				graph->addTerm(Term(words, words[0], hashes.back()));
+			}
+			graph->createLink(hashes[0], hashes[1], 3);
+
+			auto copy = *graph;
+			Assert::IsTrue(copy.nodes.get_allocator() != graph->nodes.get_allocator());
+			auto node = graph->nodes.at(hashes[0]);
+			SemanticGraph assigned;
+			assigned = *graph;
+			auto moved = std::move(*graph);
+			graph.reset();
+
+			Assert::AreEqual(3., copy.getLinkWeight(hashes[0], hashes[1]));
+			Assert::AreEqual(3., assigned.getLinkWeight(hashes[0], hashes[1]));
+			Assert::AreEqual(3., moved.getLinkWeight(hashes[0], hashes[1]));
+			Assert::AreEqual(3., node.neighbors.at(hashes[1]).weight);
+			moved = std::move(copy);
+			moved.createLink(hashes[1], hashes[0], 1);
+			Assert::AreEqual(2ull, moved.getLinksCount());
+		}
+
 		
 	};
 }
\ No newline at end of file
@@ -0,0 +1,84 @@
+﻿#include "pch.h"
+#include "CppUnitTest.h"
+#include "Utils/BinaryUtils.h"
+#include "Utils/StringPool.h"
+
+#include <sstream>
+#include <stdexcept>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace ThematicAnalysisTests
+{
+	TEST_CLASS(StringPoolTests)
+	{
+	public:
+		TEST_METHOD(EqualStringsAreStoredOnce)
+		{
+			StringPool pool;
+			auto first = pool.add("матрица");
+			auto second = pool.add("ранг");
+			Assert::IsTrue(first != second);
+			Assert::AreEqual(first, pool.add(std::string("матрица")));
+			Assert::AreEqual(2ull, pool.stringsCount());
+			Assert::AreEqual(std::string("матрица"), std::string(pool.get(first)));
+			Assert::AreEqual(std::string("ранг"), std::string(pool.get(second)));
+			Assert::AreEqual(second, pool.find("ранг"));
+			Assert::AreEqual(StringPool::NO_ID, pool.find("ран"));
+			Assert::AreEqual(std::string(""), std::string(pool.get(pool.add(""))));
+		}
+
+		TEST_METHOD(IdsStayValidWhileGrowing)
+		{
+			StringPool pool;
+			std::vector<StringPool::Id> ids;
+			for (size_t i = 0; i < 1000; i++)
+				ids.push_back(pool.add("word" + std::to_string(i)));
+			for (size_t i = 0; i < 1000; i++)
+			{
+				Assert::AreEqual("word" + std::to_string(i), std::string(pool.get(ids[i])));
+				Assert::AreEqual(ids[i], pool.add("word" + std::to_string(i)));
+			}
+			Assert::AreEqual(1000ull, pool.stringsCount());
+		}
+
+		TEST_METHOD(StringsWithNullAreRejected)
+		{
+			StringPool pool;
+			Assert::ExpectException<std::invalid_argument>([&] { pool.add(std::string_view("a\0b", 3)); });
+			Assert::AreEqual(0ull, pool.stringsCount());
+		}
+
+		TEST_METHOD(BrokenDataIsRejected)
+		{
+			StringPool pool;
+			pool.add("матрица");
+			pool.add("ранг");
+			std::stringstream data;
+			pool.saveToStream(data);
+			StringPool loaded;
+			loaded.loadFromStream(data);
+			Assert::AreEqual(pool.find("ранг"), loaded.find("ранг"));
+			Assert::AreEqual(StringPool::NO_ID, loaded.find("ран"));
+
+			auto save = [](std::string const& buffer, std::vector<StringPool::Id> const& slots, uint64_t stringsCount)
+			{
+				std::stringstream out;
+				BinaryUtils::writeString(out, buffer);
+				BinaryUtils::writeVector(out, slots);
+				BinaryUtils::write(out, stringsCount);
+				return out.str();
+			};
+			std::string buffer("a\0b\0", 4);
+			// every slot is taken, so a missing string would be searched forever
+			std::vector<std::string> brokenData = { save(buffer, { 0, 2 }, 2), save(buffer, { 0, 1, StringPool::NO_ID, StringPool::NO_ID }, 2),
+				save(buffer, { 0, 4, StringPool::NO_ID, StringPool::NO_ID }, 2), save(buffer, { 0, 2, StringPool::NO_ID, StringPool::NO_ID }, 1) };
+			for (auto const& broken : brokenData)
+			{
+				std::istringstream in(broken);
+				Assert::ExpectException<std::runtime_error>([&] { loaded.loadFromStream(in); });
+			}
+			Assert::AreEqual(2ull, loaded.stringsCount());
+		}
+	};
+}
@@ -0,0 +1,40 @@
+﻿#include "pch.h"
+#include "CppUnitTest.h"
+#include "Lemmatizer/StubLemmatizer.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace ThematicAnalysisTests
+{
+	TEST_CLASS(StubLemmatizerTests)
+	{
+		TEST_METHOD(IdentityTest)
+		{
+			StubLemmatizer lemmatizer;
+			std::vector<std::string> normWords = { "сижу", "работы", "x2", "интегралов" };
+			auto res = lemmatizer.lemmatizeText("Сижу работы 42 x2 интегралов");
+			Assert::IsTrue(normWords == res);
+		}
+
+		TEST_METHOD(SuffixStrippingTest)
+		{
+			StubLemmatizer lemmatizer(StubLemmatizer::Mode::SuffixStripping);
+			std::vector<std::string> normWords = { "сиж", "работ", "гречнев", "интеграл", "интеграл", "ряд" };
+			auto res = lemmatizer.lemmatizeText("сижу работы гречневые интегралов интегралами ряд");
+			Assert::IsTrue(normWords == res);
+		}
+
+		TEST_METHOD(LinesTest)
+		{
+			StubLemmatizer lemmatizer;
+			auto res = lemmatizer.lemmatizeLines("первый второй\n\nтретий\n", 4);
+			std::vector<size_t> offsets = { 0, 2, 2, 3, 3 };
+			std::vector<std::string> tokens = { "первый", "второй", "третий" };
+			Assert::IsTrue(offsets == res.offsets);
+			Assert::IsTrue(tokens == res.tokens);
+
+			auto func = [&lemmatizer] { lemmatizer.lemmatizeLines("первый\nвторой", 1); };
+			Assert::ExpectException<std::runtime_error>(func);
+		}
+	};
+}
@@ -0,0 +1,85 @@
+﻿#include "pch.h"
+#include "CppUnitTest.h"
+#include "TermTable.h"
+
+#include <sstream>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace ThematicAnalysisTests
+{
+	TEST_CLASS(TermTableTests)
+	{
+	public:
+		TEST_METHOD(TermsShareWords)
+		{
+			TermTable table;
+			Term matrix({ "матрица" }, "матрица", 1);
+			matrix.numberOfArticlesThatUseIt = 3;
+			Term rank({ "ранг", "матрица" }, "ранг матрицы", 2);
+			rank.numberOfArticlesThatUseIt = 5;
+
+			auto matrixIndex = table.add(matrix);
+			auto rankIndex = table.add(rank);
+			Assert::AreEqual(matrixIndex, table.add(matrix));
+			Assert::AreEqual(2ull, table.size());
+			Assert::AreEqual(rankIndex, table.find(2));
+			Assert::AreEqual(TermTable::NO_INDEX, table.find(3));
+
+			Assert::AreEqual(std::string("ранг матрицы"), std::string(table.getView(rankIndex)));
+			Assert::AreEqual(2ull, table.getWordsCount(rankIndex));
+			Assert::AreEqual(std::string("матрица"), std::string(table.getWord(rankIndex, 1)));
+			// the same pool string
+			Assert::IsTrue(table.getWord(rankIndex, 1).data() == table.getView(matrixIndex).data());
+			Assert::AreEqual(5u, table.getDocumentsCount(rankIndex));
+			table.setDocumentsCount(rankIndex, 6);
+
+			auto term = table.getTerm(rankIndex);
+			Assert::AreEqual(2ull, term.getHashCode());
+			Assert::AreEqual(rank.view, term.view);
+			Assert::IsTrue(rank.normalizedWords == term.normalizedWords);
+			Assert::AreEqual(6ull, term.numberOfArticlesThatUseIt);
+		}
+
+		TEST_METHOD(TermsOfGraph)
+		{
+			SemanticGraph graph;
+			for (size_t i = 0; i < 100; i++)
+			{
+				Term term({ "слово" + std::to_string(i % 10), "слово" + std::to_string(i) }, "view" + std::to_string(i), i * 7919);
+				term.numberOfArticlesThatUseIt = i;
+				graph.addTerm(term);
+			}
+			TermTable table(graph);
+			Assert::AreEqual(graph.nodes.size(), table.size());
+			for (auto&& [hash, node] : graph.nodes)
+			{
+				auto index = table.find(hash);
+				Assert::AreNotEqual(TermTable::NO_INDEX, index);
+				auto term = table.getTerm(index);
+				Assert::AreEqual(node.term.view, term.view);
+				Assert::IsTrue(node.term.normalizedWords == term.normalizedWords);
+				Assert::AreEqual(node.term.numberOfArticlesThatUseIt, term.numberOfArticlesThatUseIt);
+			}
+		}
+
+		TEST_METHOD(SaveAndLoad)
+		{
+			TermTable table;
+			table.add(Term({ "ранг", "матрица" }, "ранг матрицы", 2));
+			table.add(Term({ "матрица" }, "матрица", 1));
+			std::stringstream data;
+			table.saveToStream(data);
+
+			TermTable loaded;
+			loaded.loadFromStream(data);
+			Assert::AreEqual(2ull, loaded.size());
+			Assert::AreEqual(std::string("ранг матрицы"), std::string(loaded.getView(loaded.find(2))));
+			Assert::AreEqual(std::string("матрица"), std::string(loaded.getWord(loaded.find(2), 1)));
+			// the table is loaded with its index and pool, so new terms are deduplicated
+			Assert::AreEqual(loaded.find(1), loaded.add(Term({ "матрица" }, "матрица", 1)));
+			loaded.add(Term({ "матрица", "ранг" }, "матрицы ранга", 3));
+			Assert::AreEqual(3ull, loaded.size());
+		}
+	};
+}
@@ -62,6 +62,30 @@ namespace ThematicAnalysisTests
 			Assert::AreEqual(1ull, terms[Hasher::sortAndCalcHash(term2)]);
 			Assert::AreEqual(2ull, terms[Hasher::sortAndCalcHash(term)]);
 		}
+
+		TEST_METHOD(OccurrencesFoundOnceAndSelected)
+		{
+			SemanticGraph smallGraph;
+			std::vector<std::vector<std::string>> termsWords = { { "a" }, { "b" }, { "a", "b" }, { "b", "c", "d" } };
+			for (auto const& words : termsWords)
+				smallGraph.addTerm(Term(words, words[0], Hasher::sortAndCalcHash(words)));
+			std::vector<std::string> text = { "a", "b", "c", "d", "a", "b", "b" };
+
+			auto occurrences = TermsUtils::findTermsOccurrences(smallGraph, text);
+			// longer n-grams first
+			Assert::IsTrue(std::is_sorted(occurrences.begin(), occurrences.end(), [](auto const& first, auto const& second) {return first.wordsCount > second.wordsCount; }));
+			Assert::AreEqual(8ull, occurrences.size());
+
+			auto termsCounts = TermsUtils::selectTermsCounts(occurrences, text.size());
+			Assert::IsTrue(std::is_sorted(termsCounts.begin(), termsCounts.end()));
+			auto extracted = TermsUtils::extractTermsCounts(smallGraph, text);
+			Assert::IsTrue(std::vector<std::pair<size_t, size_t>>(extracted.begin(), extracted.end()) == termsCounts);
+			// "b c d" takes the first "b", so the first "a b" isn't counted
+			Assert::AreEqual(1ull, extracted[Hasher::sortAndCalcHash({ "b", "c", "d" })]);
+			Assert::AreEqual(1ull, extracted[Hasher::sortAndCalcHash({ "a", "b" })]);
+			Assert::AreEqual(1ull, extracted[Hasher::sortAndCalcHash({ "a" })]);
+			Assert::AreEqual(1ull, extracted[Hasher::sortAndCalcHash({ "b" })]);
+		}
 	};
 	SemanticGraph TermsUtilsTests::graph = SemanticGraph();
 }
\ No newline at end of file
@@ -0,0 +1,79 @@
+﻿#include "pch.h"
+#include "CppUnitTest.h"
+#include "Utils/ThreadPool.h"
+
+#include <numeric>
+#include <stdexcept>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace ThematicAnalysisTests
+{
+	TEST_CLASS(ThreadPoolTests)
+	{
+	public:
+		TEST_METHOD(ParallelFor)
+		{
+			ThreadPool pool(4);
+			std::vector<int> visits(1000);
+			pool.parallelFor(0, visits.size(), [&visits](size_t begin, size_t end)
+				{
+					for (auto i = begin; i < end; i++)
+						visits[i]++;
+				}, 7);
+			Assert::IsTrue(std::all_of(visits.begin(), visits.end(), [](int count) {return count == 1; }));
+		}
+
+		TEST_METHOD(ParallelReduce)
+		{
+			ThreadPool pool(3);
+			std::vector<size_t> values(10000);
+			std::iota(values.begin(), values.end(), 0);
+			auto sum = pool.parallelReduce(0, values.size(), 0ull, [&values](size_t begin, size_t end)
+				{
+					return std::accumulate(values.begin() + begin, values.begin() + end, 0ull);
+				}, std::plus<>());
+			Assert::AreEqual(std::accumulate(values.begin(), values.end(), 0ull), sum);
+		}
+
+		TEST_METHOD(NestedParallelFor)
+		{
+			ThreadPool pool(2);
+			std::vector<size_t> sums(8);
+			pool.parallelFor(0, sums.size(), [&pool, &sums](size_t begin, size_t end)
+				{
+					for (auto i = begin; i < end; i++)
+						sums[i] = pool.parallelReduce(0, 100, 0ull, [](size_t b, size_t e) {return e - b; }, std::plus<>(), 10);
+				}, 1);
+			Assert::IsTrue(std::all_of(sums.begin(), sums.end(), [](size_t sum) {return sum == 100; }));
+		}
+
+		TEST_METHOD(Dependencies)
+		{
+			ThreadPool pool(4);
+			std::vector<int> order;
+			std::mutex mutex;
+			auto log = [&order, &mutex](int step) { std::lock_guard lock(mutex); order.push_back(step); };
+			auto first = pool.run([&log] {log(1); });
+			auto second = pool.run([&log] {log(2); });
+			auto last = pool.run([&log] {log(3); }, { first, second });
+			pool.wait(last);
+			Assert::AreEqual(3ull, order.size());
+			Assert::AreEqual(3, order.back());
+		}
+
+		TEST_METHOD(Exceptions)
+		{
+			ThreadPool pool(2);
+			bool isDependentRun = false;
+			auto failed = pool.run([] {throw std::runtime_error("task failed"); });
+			auto dependent = pool.run([&isDependentRun] {isDependentRun = true; }, { failed });
+			Assert::ExpectException<std::runtime_error>([&pool, &dependent] {pool.wait(dependent); });
+			Assert::IsFalse(isDependentRun);
+			Assert::ExpectException<std::logic_error>([&pool]
+				{
+					pool.parallelFor(0, 100, [](size_t begin, size_t) {if (begin == 50) throw std::logic_error("range failed"); }, 10);
+				});
+		}
+	};
+}
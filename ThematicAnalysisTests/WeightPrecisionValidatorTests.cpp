@@ -0,0 +1,39 @@
+﻿#include "pch.h"
+#include "CppUnitTest.h"
+#include "Hasher.h"
+#include "WeightPrecisionValidator.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace ThematicAnalysisTests
+{
+	TEST_CLASS(WeightPrecisionValidatorTests)
+	{
+	public:
+		TEST_METHOD(reportsOfWeightTypes)
+		{
+			SemanticGraph graph;
+			std::vector<size_t> hashes;
+			for (std::string view : { "АБАК", "ГРУППА", "СТЕПЕНЬ", "КОЛЬЦО" })
+			{
+				std::vector<std::string> words = { view };
+				hashes.push_back(Hasher::sortAndCalcHash(words));
+				graph.addTerm(Term(words, view, hashes.back()));
+			}
+			graph.createLink(hashes[0], hashes[1], 1.);
+			graph.createLink(hashes[0], hashes[2], 1e-3);
+			graph.createLink(hashes[3], hashes[2], 1e-6);
+
+			auto reports = WeightPrecisionValidator(graph, { { "АБАК", "КОЛЬЦО" }, { "ГРУППА" } }, 3).validate();
+			Assert::AreEqual(3ull, reports.size());
+			Assert::AreEqual(std::string("double"), reports[0].weightType);
+			Assert::AreEqual(1., reports[0].tagsOverlap);
+			Assert::AreEqual(0ull, reports[0].maxRankShift);
+			Assert::AreEqual(0., reports[0].maxWeightError);
+			Assert::AreEqual(std::string("float"), reports[1].weightType);
+			Assert::IsTrue(reports[1].maxWeightError < 1e-6);
+			Assert::AreEqual(std::string("quantized16"), reports[2].weightType);
+			Assert::IsTrue(reports[2].memoryUsage < reports[1].memoryUsage && reports[1].memoryUsage < reports[0].memoryUsage);
+		}
+	};
+}
@@ -46,5 +46,73 @@ namespace ThematicAnalysisTests
 			Assert::AreEqual(std::string(" "), titles[1]);
 			Assert::AreEqual(std::string("      "), contents[1]);
 		}
+		TEST_METHOD(StreamingRead)
+		{
+			auto reader = XmlArticlesReader();
+			auto text = readTestFile("TwoPaper.txt");
+			auto articles = reader.read(text);
+			auto& titles = std::get<0>(articles);
+			auto& contents = std::get<1>(articles);
+			size_t count = 0;
+			reader.read(std::string_view(text), [&](std::string_view title, std::string_view content)
+				{
+					Assert::AreEqual(titles[count], std::string(title));
+					Assert::AreEqual(contents[count], std::string(content));
+					count++;
+				});
+			Assert::AreEqual(titles.size(), count);
+		}
+		TEST_METHOD(NestedPaper)
+		{
+			auto reader = XmlArticlesReader();
+			auto [titles, contents] = reader.read(std::string(
+				"<paper><name> outer </name><content>a\t b</content>"
+				"<paper><name>inner</name><content>c</content><paperDef>d</paperDef></paper></paper>"));
+			Assert::AreEqual((size_t)2, titles.size());
+			Assert::AreEqual(std::string("inner"), titles[0]);
+			Assert::AreEqual(std::string("c d"), contents[0]);
+			Assert::AreEqual(std::string("outer"), titles[1]);
+			Assert::AreEqual(std::string("a b"), contents[1]);
+		}
+		TEST_METHOD(ReadFile)
+		{
+			size_t count = 0;
+			XmlArticlesReader().readFile("resources/XmlSourceParser/TwoPaper.txt", [&count](std::string_view, std::string_view) {count++; });
+			Assert::AreEqual((size_t)2, count);
+		}
+		TEST_METHOD(ParallelRead)
+		{
+			auto reader = XmlArticlesReader();
+			auto text = FileUtils::readAllFile("resources/MiddleMath.txt");
+			auto articles = reader.read(text);
+			for (size_t threadsCount : { 1, 2, 8 })
+			{
+				std::vector<std::string> titles, contents;
+				reader.readParallel(text, [&](std::string_view title, std::string_view content)
+					{
+						titles.emplace_back(title);
+						contents.emplace_back(content);
+					}, threadsCount);
+				Assert::IsTrue(std::get<0>(articles) == titles);
+				Assert::IsTrue(std::get<1>(articles) == contents);
+			}
+		}
+		TEST_METHOD(ParallelReadSkipsTagsInText)
+		{
+			auto reader = XmlArticlesReader();
+			std::string text;
+			for (size_t i = 0; i < 32; i++)
+				text += "<paper><name>title " + std::to_string(i) + "</name><content>a </paper> b <paper> c</content></paper>\n";
+			auto articles = reader.read(text);
+			Assert::AreEqual((size_t)32, std::get<0>(articles).size());
+			std::vector<std::string> titles, contents;
+			reader.readParallel(text, [&](std::string_view title, std::string_view content)
+				{
+					titles.emplace_back(title);
+					contents.emplace_back(content);
+				}, 8);
+			Assert::IsTrue(std::get<0>(articles) == titles);
+			Assert::IsTrue(std::get<1>(articles) == contents);
+		}
 	};
 }